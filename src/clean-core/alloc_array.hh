@@ -13,14 +13,15 @@ namespace cc
 {
 // heap-allocated (runtime) fixed-size array
 // backed by a cc::allocator
-template <class T>
+// AllocatorT can be a concrete allocator type to bind allocation calls at compile time (see alloc_vector)
+template <class T, class AllocatorT>
 struct alloc_array
 {
-    alloc_array() : _allocator(cc::system_allocator) { static_assert(sizeof(T) > 0, "cannot make alloc_array of incomplete object"); }
+    alloc_array() : _allocator(detail::default_container_allocator<AllocatorT>()) { static_assert(sizeof(T) > 0, "cannot make alloc_array of incomplete object"); }
 
-    explicit alloc_array(cc::allocator* allocator) : _allocator(allocator) { CC_CONTRACT(allocator != nullptr); }
+    explicit alloc_array(AllocatorT* allocator) : _allocator(allocator) { CC_CONTRACT(allocator != nullptr); }
 
-    explicit alloc_array(size_t size, cc::allocator* allocator = cc::system_allocator) : alloc_array(allocator)
+    explicit alloc_array(size_t size, AllocatorT* allocator = detail::default_container_allocator<AllocatorT>()) : alloc_array(allocator)
     {
         _size = size;
         _data = _alloc(size);
@@ -32,9 +33,17 @@ struct alloc_array
         }
     }
 
-    [[nodiscard]] static alloc_array defaulted(size_t size, cc::allocator* allocator = cc::system_allocator) { return alloc_array(size, allocator); }
+    [[nodiscard]] static alloc_array defaulted(size_t size, AllocatorT* allocator = detail::default_container_allocator<AllocatorT>()) { return alloc_array(size, allocator); }
 
-    [[nodiscard]] static alloc_array uninitialized(size_t size, cc::allocator* allocator = cc::system_allocator)
+    /// same as defaulted (alloc_array never zeroes trivial types), for symmetry with the other containers
+    [[nodiscard]] static alloc_array for_overwrite(size_t size, AllocatorT* allocator = detail::default_container_allocator<AllocatorT>())
+    {
+        auto a = alloc_array::uninitialized(size, allocator);
+        detail::container_default_initialize(size, a._data);
+        return a;
+    }
+
+    [[nodiscard]] static alloc_array uninitialized(size_t size, AllocatorT* allocator = detail::default_container_allocator<AllocatorT>())
     {
         alloc_array a(allocator);
         a._size = size;
@@ -42,7 +51,7 @@ struct alloc_array
         return a;
     }
 
-    [[nodiscard]] static alloc_array filled(size_t size, T const& value, cc::allocator* allocator = cc::system_allocator)
+    [[nodiscard]] static alloc_array filled(size_t size, T const& value, AllocatorT* allocator = detail::default_container_allocator<AllocatorT>())
     {
         alloc_array a(allocator);
         a._size = size;
@@ -52,14 +61,14 @@ struct alloc_array
         return a;
     }
 
-    alloc_array(span<T const> data, cc::allocator* allocator = cc::system_allocator) : alloc_array(allocator)
+    alloc_array(span<T const> data, AllocatorT* allocator = detail::default_container_allocator<AllocatorT>()) : alloc_array(allocator)
     {
         _size = data.size();
         _data = _alloc(_size);
         detail::container_copy_construct_range<T>(data.data(), _size, _data);
     }
 
-    alloc_array(std::initializer_list<T> data, cc::allocator* allocator = cc::system_allocator)
+    alloc_array(std::initializer_list<T> data, AllocatorT* allocator = detail::default_container_allocator<AllocatorT>())
       : alloc_array(cc::span<T const>{data.begin(), data.size()}, allocator)
     {
     }
@@ -71,7 +80,7 @@ struct alloc_array
         _allocator = a._allocator;
         a._data = nullptr;
         a._size = 0;
-        a._allocator = cc::system_allocator;
+        a._allocator = detail::default_container_allocator<AllocatorT>();
     }
     alloc_array& operator=(alloc_array&& a) noexcept
     {
@@ -81,7 +90,7 @@ struct alloc_array
         _allocator = a._allocator;
         a._data = nullptr;
         a._size = 0;
-        a._allocator = cc::system_allocator;
+        a._allocator = detail::default_container_allocator<AllocatorT>();
         return *this;
     }
 
@@ -94,7 +103,7 @@ struct alloc_array
         _destroy();
     }
 
-    void reset(cc::allocator* new_allocator, size_t new_size = 0)
+    void reset(AllocatorT* new_allocator, size_t new_size = 0)
     {
         _destroy();
 
@@ -118,7 +127,7 @@ struct alloc_array
         }
     }
 
-    void reset(cc::allocator* new_allocator, size_t new_size, T const& new_value)
+    void reset(AllocatorT* new_allocator, size_t new_size, T const& new_value)
     {
         _destroy();
 
@@ -190,21 +199,29 @@ struct alloc_array
     bool operator==(alloc_array const& rhs) const noexcept { return operator==(span<T const>(rhs)); }
     bool operator!=(alloc_array const& rhs) const noexcept { return operator!=(span<T const>(rhs)); }
 
-    cc::allocator* allocator() const { return this->_allocator; }
+    AllocatorT* allocator() const { return this->_allocator; }
 
 private:
-    T* _alloc(size_t size) { return reinterpret_cast<T*>(_allocator->alloc(size * sizeof(T), alignof(T))); }
-    void _free(T* p) { _allocator->free(p); }
+    T* _alloc(size_t size)
+    {
+        CC_ASSERT(_allocator && "no allocator set?");
+        return reinterpret_cast<T*>(_allocator->alloc(size * sizeof(T), alignof(T)));
+    }
+    void _free(T* p, size_t size)
+    {
+        if (p != nullptr)
+            _allocator->free_sized(p, size * sizeof(T), alignof(T));
+    }
 
     void _destroy()
     {
         detail::container_destroy_reverse<T>(_data, _size);
-        _free(_data);
+        _free(_data, _size);
     }
 
 private:
     T* _data = nullptr;
     size_t _size = 0;
-    cc::allocator* _allocator = nullptr;
+    AllocatorT* _allocator = nullptr;
 };
 }
@@ -7,16 +7,22 @@
 namespace cc
 {
 // cc::vector, but backed by a given allocator
-template <class T>
-struct alloc_vector : public detail::vector_base<T, size_t, true>
+// AllocatorT can be a concrete allocator type to bind all allocation calls at compile time
+// e.g. cc::alloc_vector<int, cc::linear_allocator> inlines the bump allocation
+// (there is no default allocator in that case, one must be passed on construction)
+template <class T, class AllocatorT>
+struct alloc_vector : public detail::vector_base<T, size_t, true, AllocatorT>
 {
     // ctors
 public:
-    alloc_vector() noexcept : detail::vector_base<T, size_t, true>(cc::system_allocator) {}
+    alloc_vector() noexcept : detail::vector_base<T, size_t, true, AllocatorT>(detail::default_container_allocator<AllocatorT>()) {}
 
-    explicit alloc_vector(cc::allocator* allocator) noexcept : detail::vector_base<T, size_t, true>(allocator) { CC_CONTRACT(allocator != nullptr); }
+    explicit alloc_vector(AllocatorT* allocator) noexcept : detail::vector_base<T, size_t, true, AllocatorT>(allocator)
+    {
+        CC_CONTRACT(allocator != nullptr);
+    }
 
-    explicit alloc_vector(size_t size, cc::allocator* allocator = cc::system_allocator) : alloc_vector(allocator)
+    explicit alloc_vector(size_t size, AllocatorT* allocator = detail::default_container_allocator<AllocatorT>()) : alloc_vector(allocator)
     {
         this->_data = this->_alloc(size);
         this->_size = size;
@@ -25,12 +31,20 @@ public:
         detail::container_default_construct_or_zeroed(size, this->_data);
     }
 
-    [[nodiscard]] static alloc_vector defaulted(size_t size, cc::allocator* allocator = cc::system_allocator)
+    [[nodiscard]] static alloc_vector defaulted(size_t size, AllocatorT* allocator = detail::default_container_allocator<AllocatorT>())
     {
         return alloc_vector(size, allocator);
     }
 
-    [[nodiscard]] static alloc_vector uninitialized(size_t size, cc::allocator* allocator = cc::system_allocator)
+    /// returns a vector with "size" elements, trivial types are left uninitialized
+    [[nodiscard]] static alloc_vector for_overwrite(size_t size, AllocatorT* allocator = detail::default_container_allocator<AllocatorT>())
+    {
+        auto v = alloc_vector::uninitialized(size, allocator);
+        detail::container_default_initialize(size, v._data);
+        return v;
+    }
+
+    [[nodiscard]] static alloc_vector uninitialized(size_t size, AllocatorT* allocator = detail::default_container_allocator<AllocatorT>())
     {
         alloc_vector v(allocator);
         v._size = size;
@@ -39,26 +53,26 @@ public:
         return v;
     }
 
-    [[nodiscard]] static alloc_vector filled(size_t size, T const& value, cc::allocator* allocator = cc::system_allocator)
+    [[nodiscard]] static alloc_vector filled(size_t size, T const& value, AllocatorT* allocator = detail::default_container_allocator<AllocatorT>())
     {
         alloc_vector v(allocator);
         v.resize(size, value);
         return v;
     }
 
-    alloc_vector(T const* begin, size_t num_elements, cc::allocator* allocator = cc::system_allocator) : alloc_vector(allocator)
+    alloc_vector(T const* begin, size_t num_elements, AllocatorT* allocator = detail::default_container_allocator<AllocatorT>()) : alloc_vector(allocator)
     {
         this->reserve(num_elements);
         detail::container_copy_construct_range<T>(begin, num_elements, this->_data);
         this->_size = num_elements;
     }
-    alloc_vector(std::initializer_list<T> data, cc::allocator* allocator = cc::system_allocator) : alloc_vector(data.begin(), data.size(), allocator)
+    alloc_vector(std::initializer_list<T> data, AllocatorT* allocator = detail::default_container_allocator<AllocatorT>()) : alloc_vector(data.begin(), data.size(), allocator)
     {
     }
-    alloc_vector(cc::span<T const> data, cc::allocator* allocator = cc::system_allocator) : alloc_vector(data.begin(), data.size(), allocator) {}
+    alloc_vector(cc::span<T const> data, AllocatorT* allocator = detail::default_container_allocator<AllocatorT>()) : alloc_vector(data.begin(), data.size(), allocator) {}
 
     template <class Range, cc::enable_if<cc::is_any_range<Range>> = true>
-    explicit alloc_vector(Range const& range, cc::allocator* allocator = cc::system_allocator) : alloc_vector(allocator)
+    explicit alloc_vector(Range const& range, AllocatorT* allocator = detail::default_container_allocator<AllocatorT>()) : alloc_vector(allocator)
     {
         for (auto const& e : range)
             this->emplace_back(e);
@@ -68,7 +82,7 @@ public:
     {
         static_assert(sizeof(T) > 0, "alloc_vector destructor requires complete type");
         detail::container_destroy_reverse<T>(this->_data, this->_size);
-        this->_free(this->_data);
+        this->_free(this->_data, this->_capacity);
     }
 
     alloc_vector(alloc_vector&& rhs) noexcept : alloc_vector(rhs._allocator)
@@ -79,12 +93,12 @@ public:
         rhs._data = nullptr;
         rhs._size = 0;
         rhs._capacity = 0;
-        rhs._allocator = cc::system_allocator;
+        rhs._allocator = detail::default_container_allocator<AllocatorT>();
     }
     alloc_vector& operator=(alloc_vector&& rhs) noexcept
     {
         detail::container_destroy_reverse<T>(this->_data, this->_size);
-        this->_free(this->_data);
+        this->_free(this->_data, this->_capacity);
         this->_data = rhs._data;
         this->_size = rhs._size;
         this->_capacity = rhs._capacity;
@@ -92,7 +106,7 @@ public:
         rhs._data = nullptr;
         rhs._size = 0;
         rhs._capacity = 0;
-        rhs._allocator = cc::system_allocator;
+        rhs._allocator = detail::default_container_allocator<AllocatorT>();
         return *this;
     }
 
@@ -100,13 +114,13 @@ public:
     alloc_vector& operator=(alloc_vector const& rhs) = delete;
 
     /// destroy contents, reset to a new allocator and reserve
-    void reset_reserve(cc::allocator* new_allocator, size_t reserve_size)
+    void reset_reserve(AllocatorT* new_allocator, size_t reserve_size)
     {
         // destroy
         if (this->_data)
         {
             detail::container_destroy_reverse<T>(this->_data, this->_size);
-            this->_free(this->_data);
+            this->_free(this->_data, this->_capacity);
             this->_data = nullptr;
             this->_size = 0;
             this->_capacity = 0;
@@ -119,14 +133,14 @@ public:
         this->reserve(reserve_size);
     }
 
-    cc::allocator* allocator() const { return this->_allocator; }
+    AllocatorT* allocator() const { return this->_allocator; }
 };
 
 // hash
-template <class T>
-struct hash<alloc_vector<T>>
+template <class T, class AllocatorT>
+struct hash<alloc_vector<T, AllocatorT>>
 {
-    [[nodiscard]] constexpr uint64_t operator()(alloc_vector<T> const& a) const noexcept
+    [[nodiscard]] constexpr uint64_t operator()(alloc_vector<T, AllocatorT> const& a) const noexcept
     {
         uint64_t h = 0;
         for (auto const& v : a)
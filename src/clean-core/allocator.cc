@@ -45,6 +45,25 @@ std::byte* cc::allocator::realloc(void* ptr, size_t new_size, size_t align)
     return res;
 }
 
+void cc::allocator::free_sized(void* ptr, size_t size, size_t align)
+{
+    (void)size;
+    (void)align;
+    this->free(ptr);
+}
+
+void cc::allocator::alloc_batch(size_t size, size_t align, cc::span<std::byte*> out_ptrs)
+{
+    for (auto& ptr : out_ptrs)
+        ptr = this->alloc(size, align);
+}
+
+void cc::allocator::free_batch(cc::span<void* const> ptrs)
+{
+    for (void* const ptr : ptrs)
+        this->free(ptr);
+}
+
 std::byte* cc::allocator::try_alloc(size_t size, size_t alignment) { return this->alloc(size, alignment); }
 
 std::byte* cc::allocator::try_realloc(void* ptr, size_t new_size, size_t alignment) { return this->realloc(ptr, new_size, alignment); }
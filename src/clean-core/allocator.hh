@@ -37,6 +37,26 @@ public:
     // the original buffer will remain valid in that case
     virtual std::byte* try_realloc(void* ptr, size_t new_size, size_t align = alignof(std::max_align_t));
 
+    // resizes a buffer without moving it, returns false if that is not possible (the buffer is unchanged then)
+    // containers use this to grow buffers of types that cannot be relocated with memcpy
+    virtual bool try_resize_in_place([[maybe_unused]] void* ptr, [[maybe_unused]] size_t new_size) { return false; }
+
+    // free a previously allocated buffer of known size and alignment (as passed to alloc or realloc)
+    // allocators can use this to skip looking up the allocation size, defaults to free()
+    virtual void free_sized(void* ptr, size_t size, size_t align = alignof(std::max_align_t));
+
+    // allocate out_ptrs.size() buffers of the same size and alignment in a single call
+    // defaults to individual alloc() calls
+    virtual void alloc_batch(size_t size, size_t align, cc::span<std::byte*> out_ptrs);
+
+    // free multiple previously allocated buffers in a single call
+    // defaults to individual free() calls
+    virtual void free_batch(cc::span<void* const> ptrs);
+
+    // true if free() is a no-op and memory is only released on reset (e.g. linear allocators)
+    // containers use this to skip individual frees on clear and destruction
+    virtual bool is_free_noop() const { return false; }
+
     // reads the size of the given allocation
     // only some allocators can do this, returns true if available
     virtual bool get_allocation_size([[maybe_unused]] void const* ptr, [[maybe_unused]] size_t& out_size) { return false; }
@@ -64,6 +84,11 @@ public:
     template <class T>
     [[nodiscard]] T* new_array(size_t num_elems);
 
+    /// allocate and default-initialize an array, trivial types stay uninitialized (for data that is overwritten anyway)
+    /// delete with delete_array
+    template <class T>
+    [[nodiscard]] T* new_array_for_overwrite(size_t num_elems);
+
     /// destruct and deallocate an array previously created with new_array
     template <class T>
     void delete_array(T* ptr);
@@ -72,6 +97,11 @@ public:
     template <class T>
     [[nodiscard]] T* new_array_sized(size_t num_elems);
 
+    /// allocate and default-initialize an array without keeping track of the amount of elements
+    /// trivial types stay uninitialized, delete with delete_array_sized
+    template <class T>
+    [[nodiscard]] T* new_array_sized_for_overwrite(size_t num_elems);
+
     /// destruct and deallocate an array previously created with new_array_sized
     template <class T>
     void delete_array_sized(T* ptr, size_t num_elems);
@@ -100,6 +130,19 @@ extern allocator* const system_allocator;
 
 namespace detail
 {
+/// the allocator a container uses if none is specified
+/// containers can be bound to a concrete (final) allocator type instead of cc::allocator,
+/// making all calls non-virtual and inlinable (e.g. cc::alloc_vector<T, cc::linear_allocator>)
+/// only the runtime cc::allocator has a default, statically bound containers must be given an instance
+template <class AllocatorT>
+AllocatorT* default_container_allocator()
+{
+    if constexpr (std::is_same_v<AllocatorT, cc::allocator>)
+        return cc::system_allocator;
+    else
+        return nullptr;
+}
+
 constexpr size_t get_array_padding(size_t elem_size)
 {
     return sizeof(size_t) <= elem_size ? elem_size : elem_size * (1 + sizeof(size_t) / elem_size);
@@ -154,6 +197,27 @@ T* allocator::new_array(size_t num_elems)
     return res_array_ptr;
 }
 
+template <class T>
+T* allocator::new_array_for_overwrite(size_t num_elems)
+{
+    static_assert(sizeof(T) > 0, "cannot construct incomplete type");
+    constexpr size_t padding = detail::get_array_padding(sizeof(T));
+    size_t size = sizeof(T) * num_elems + padding;
+
+    auto* const original_buf = this->alloc(size, alignof(T));
+    *reinterpret_cast<size_t*>(original_buf) = num_elems; // write amount of elements
+
+    T* const res_array_ptr = reinterpret_cast<T*>(original_buf + padding);
+
+    if constexpr (!std::is_trivially_default_constructible_v<T>)
+    {
+        for (auto i = 0u; i < num_elems; ++i)
+            new (placement_new, res_array_ptr + i) T;
+    }
+
+    return res_array_ptr;
+}
+
 template <class T>
 void allocator::delete_array(T* ptr)
 {
@@ -174,7 +238,7 @@ void allocator::delete_array(T* ptr)
             (ptr + i)->~T();
     }
 
-    this->free(original_buf);
+    this->free_sized(original_buf, sizeof(T) * num_elems + padding, alignof(T));
 }
 
 
@@ -198,6 +262,21 @@ T* allocator::new_array_sized(size_t num_elems)
 }
 
 
+template <class T>
+T* allocator::new_array_sized_for_overwrite(size_t num_elems)
+{
+    static_assert(sizeof(T) > 0, "cannot construct incomplete type");
+    T* const res_array_ptr = reinterpret_cast<T*>(this->alloc(sizeof(T) * num_elems, alignof(T)));
+
+    if constexpr (!std::is_trivially_default_constructible_v<T>)
+    {
+        for (auto i = 0u; i < num_elems; ++i)
+            new (placement_new, res_array_ptr + i) T;
+    }
+
+    return res_array_ptr;
+}
+
 template <class T>
 void allocator::delete_array_sized(T* ptr, size_t num_elems)
 {
@@ -213,7 +292,7 @@ void allocator::delete_array_sized(T* ptr, size_t num_elems)
             (ptr + i)->~T();
     }
 
-    this->free(ptr);
+    this->free_sized(ptr, sizeof(T) * num_elems, alignof(T));
 }
 
 template <class T>
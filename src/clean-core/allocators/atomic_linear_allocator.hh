@@ -38,6 +38,47 @@ struct atomic_linear_allocator final : allocator
         (void)ptr;
     }
 
+    void free_sized(void* ptr, size_t size, size_t align = alignof(std::max_align_t)) override
+    {
+        // no-op
+        (void)ptr;
+        (void)size;
+        (void)align;
+    }
+
+    void free_batch(cc::span<void* const> ptrs) override
+    {
+        // no-op
+        (void)ptrs;
+    }
+
+    bool is_free_noop() const override { return true; }
+
+    // a single atomic add for all allocations
+    void alloc_batch(size_t size, size_t align, cc::span<std::byte*> out_ptrs) override
+    {
+        CC_ASSERT(_buffer_begin != nullptr && "atomic_linear_allocator unintialized");
+
+        align = cc::max<size_t>(align, 1);
+
+        auto const element_size = size + (align - 1) + sizeof(size_t); // same worst case per element as alloc()
+        auto const buffer_start = _offset.fetch_add(element_size * out_ptrs.size(), std::memory_order_acquire);
+
+        auto* cursor = _buffer_begin + buffer_start;
+        for (auto& ptr : out_ptrs)
+        {
+            auto* const padded_res = cc::align_up(cursor + sizeof(size_t), align);
+
+            // store alloc size
+            *((size_t*)(padded_res - sizeof(size_t))) = size;
+
+            ptr = padded_res;
+            cursor = padded_res + size;
+        }
+
+        CC_ASSERT(cursor <= _buffer_end && "atomic_linear_allocator overcommitted");
+    }
+
     bool get_allocation_size(void const* ptr, size_t& out_size) override
     {
         if (!ptr)
@@ -2,6 +2,105 @@
 
 cc::atomic_pool_allocator::atomic_pool_allocator(span<std::byte> buffer, size_t block_size) { initialize(buffer, block_size); }
 
+void cc::atomic_pool_allocator::alloc_batch(size_t size, size_t align, span<std::byte*> out_ptrs)
+{
+    CC_ASSERT(size <= _block_size && "Can only allocate buffers up to the block size");
+
+    if (out_ptrs.empty())
+        return;
+
+    size_t const num_acquired = _pop_free_chain(out_ptrs.data(), out_ptrs.size());
+
+    // the pool ran out, report a short batch
+    for (auto i = num_acquired; i < out_ptrs.size(); ++i)
+        out_ptrs[i] = nullptr;
+
+    for (auto const* ptr : out_ptrs)
+    {
+        CC_ASSERT((!ptr || cc::is_aligned(ptr, align)) && "pool buffer and blocks must be aligned to a multiple of all requests");
+        (void)ptr;
+    }
+}
+
+void cc::atomic_pool_allocator::free_batch(span<void* const> ptrs)
+{
+    // link the freed nodes into a chain, skipping nullptrs
+    std::byte* chain_first = nullptr;
+    std::byte* chain_last = nullptr;
+    for (void* const ptr : ptrs)
+    {
+        if (!ptr)
+            continue;
+
+        std::byte* const freed_node = static_cast<std::byte*>(ptr);
+        CC_ASSERT(freed_node >= _buffer_begin && freed_node - _buffer_begin <= ptrdiff_t(_buffer_size) && "pointer in pool_allocator::free_batch is not part of the buffer");
+        CC_ASSERT((freed_node - _buffer_begin) % _block_size == 0 && "freed pointer is not on a node boundary");
+
+        if (chain_last)
+            new (cc::placement_new, chain_last) std::byte*(freed_node);
+        else
+            chain_first = freed_node;
+
+        chain_last = freed_node;
+    }
+
+    if (!chain_first)
+        return;
+
+    _push_free_chain(chain_first, chain_last);
+}
+
+size_t cc::atomic_pool_allocator::_pop_free_chain(std::byte** out_nodes, size_t max_count)
+{
+    uint64_t head = _first_free_node.load(std::memory_order_acquire);
+    size_t num_taken = 0;
+    while (true)
+    {
+        // walk the candidate chain, next pointers read here are user data if another thread acquired the node meanwhile
+        // they are only followed if they point to a node, in any other case the head changed and the CAS would fail
+        num_taken = 0;
+        std::byte* cursor = _get_head_node(head);
+        bool is_chain_valid = true;
+        while (cursor != nullptr && num_taken < max_count)
+        {
+            out_nodes[num_taken++] = cursor;
+            // read the in-place next pointer of this node
+            cursor = *reinterpret_cast<std::byte* volatile*>(cursor);
+
+            if (cursor != nullptr && !_is_node(cursor))
+            {
+                is_chain_valid = false;
+                break;
+            }
+        }
+
+        if (!is_chain_valid)
+        {
+            head = _first_free_node.load(std::memory_order_acquire);
+            continue;
+        }
+
+        if (num_taken == 0)
+            return 0;
+
+        // compare-exchange the head with the node after the chain - spurious failure if raced
+        if (_first_free_node.compare_exchange_weak(head, _make_next_head(head, cursor), std::memory_order_seq_cst, std::memory_order_acquire))
+            return num_taken;
+    }
+}
+
+void cc::atomic_pool_allocator::_push_free_chain(std::byte* first_node, std::byte* last_node)
+{
+    uint64_t head = _first_free_node.load(std::memory_order_relaxed);
+    do
+    {
+        // write the in-place next pointer of the chain tail provisionally
+        new (cc::placement_new, last_node) std::byte*(_get_head_node(head));
+
+        // CAS write the whole chain if the expected wasn't raced
+    } while (!_first_free_node.compare_exchange_weak(head, _make_next_head(head, first_node), std::memory_order_seq_cst, std::memory_order_relaxed));
+}
+
 void cc::atomic_pool_allocator::initialize(span<std::byte> buffer, size_t block_size)
 {
     CC_ASSERT(_buffer_begin == nullptr && "double initialize");
@@ -11,6 +110,7 @@ void cc::atomic_pool_allocator::initialize(span<std::byte> buffer, size_t block_
 
     CC_ASSERT(_block_size >= sizeof(std::byte*) && "blocks must be large enough to accomodate a pointer");
     CC_ASSERT(_block_size <= _buffer_size && "not enough memory to allocate a single block");
+    CC_ASSERT(_buffer_size / _block_size < (size_t(1) << 32) - 1 && "too many blocks for the free list index");
 
     size_t const num_blocks = _buffer_size / _block_size;
 
@@ -27,5 +127,5 @@ void cc::atomic_pool_allocator::initialize(span<std::byte> buffer, size_t block_
         new (cc::placement_new, tail_ptr) std::byte*(nullptr);
     }
 
-    _first_free_node = &_buffer_begin[0];
+    _first_free_node = _make_next_head(0, &_buffer_begin[0]);
 }
@@ -17,20 +17,9 @@ struct atomic_pool_allocator final : allocator
 		CC_ASSERT(!is_full() && "pool_allocator full");
 		CC_ASSERT(size <= _block_size && "Can only allocate buffers up to the block size");
 
-        // CAS-loop to acquire a free node and write the matching next pointer
-        bool cas_success = false;
         std::byte* acquired_node = nullptr;
-        do
-        {
-            // acquire-candidate: the current value of _first_free_node
-            acquired_node = _first_free_node.load(std::memory_order_acquire);
-            // read the in-place next pointer of this node
-            std::byte* const next_pointer_of_acquired = *reinterpret_cast<std::byte**>(acquired_node);
-
-            // compare-exchange these two - spurious failure if raced
-            cas_success = std::atomic_compare_exchange_weak_explicit(&_first_free_node, &acquired_node, next_pointer_of_acquired,
-                                                                     std::memory_order_seq_cst, std::memory_order_relaxed);
-        } while (!cas_success);
+        if (_pop_free_chain(&acquired_node, 1) == 0)
+            return nullptr;
 
         CC_ASSERT(cc::is_aligned(acquired_node, align) && "pool buffer and blocks must be aligned to a multiple of all requests");
         return acquired_node;
@@ -45,21 +34,23 @@ struct atomic_pool_allocator final : allocator
         CC_ASSERT(freed_node >= _buffer_begin && freed_node - _buffer_begin <= ptrdiff_t(_buffer_size) && "pointer in pool_allocator::free is not part of the buffer");
         CC_ASSERT((freed_node - _buffer_begin) % _block_size == 0 && "freed pointer is not on a node boundary");
 
-        // write the in-place next pointer of this node
-        bool cas_success = false;
-        do
-        {
-            std::byte* expected_first_free = _first_free_node.load(std::memory_order_acquire);
-
-            // write the in-place next pointer of this node provisionally
-            new (cc::placement_new, freed_node) std::byte*(expected_first_free);
+        _push_free_chain(freed_node, freed_node);
+    }
 
-            // CAS write the newly released node if the expected wasn't raced
-            cas_success = std::atomic_compare_exchange_weak_explicit(&_first_free_node, &expected_first_free, freed_node, std::memory_order_seq_cst,
-                                                                     std::memory_order_relaxed);
-        } while (!cas_success);
+    void free_sized(void* ptr, size_t size, size_t align = alignof(std::max_align_t)) override
+    {
+        (void)align;
+        CC_ASSERT((!ptr || size <= _block_size) && "freed size is larger than the block size, was this allocated by this pool?");
+        free(ptr);
     }
 
+    /// acquires all blocks with a single successful CAS
+    /// if the pool runs out, the remaining entries of out_ptrs are set to nullptr
+    void alloc_batch(size_t size, size_t align, cc::span<std::byte*> out_ptrs) override;
+
+    /// releases all blocks with a single successful CAS
+    void free_batch(cc::span<void* const> ptrs) override;
+
     bool get_allocation_size(void const* ptr, size_t& out_size) override
     {
         if (!ptr)
@@ -87,7 +78,7 @@ struct atomic_pool_allocator final : allocator
         return offset_bytes / _block_size;
     }
 
-    bool is_full() const { return _first_free_node == nullptr; }
+    bool is_full() const { return uint32_t(_first_free_node.load(std::memory_order_relaxed)) == 0; }
     size_t max_size_bytes() const { return _buffer_size; }
     size_t block_size_bytes() const { return _block_size; }
     size_t max_num_blocks() const { return _buffer_size / _block_size; }
@@ -104,8 +95,33 @@ struct atomic_pool_allocator final : allocator
     }
 
 private:
+    // pops up to max_count nodes from the free list with a single successful CAS, returns the amount acquired
+    size_t _pop_free_chain(std::byte** out_nodes, size_t max_count);
+
+    // pushes a chain of nodes, already linked from first to last via their in-place next pointers, with a single CAS
+    void _push_free_chain(std::byte* first_node, std::byte* last_node);
+
+    // the head of the free list is (version << 32) | (node index + 1), with 0 as the index part if the pool is full
+    // the version is incremented on every successful CAS so a head that was popped and pushed again in between does not match (ABA)
+    std::byte* _get_head_node(uint64_t head) const
+    {
+        uint32_t const index_plus_one = uint32_t(head);
+        return index_plus_one == 0 ? nullptr : _buffer_begin + size_t(index_plus_one - 1) * _block_size;
+    }
+    uint64_t _make_next_head(uint64_t prev_head, std::byte const* node) const
+    {
+        uint64_t const index_plus_one = node == nullptr ? 0 : uint64_t(node - _buffer_begin) / _block_size + 1;
+        return (((prev_head >> 32) + 1) << 32) | index_plus_one;
+    }
+
+    // true if ptr is the start of a node, used to validate next pointers read while racing with other threads
+    bool _is_node(std::byte const* ptr) const
+    {
+        return ptr >= _buffer_begin && ptr < _buffer_begin + max_num_blocks() * _block_size && size_t(ptr - _buffer_begin) % _block_size == 0;
+    }
+
     std::byte* _buffer_begin = nullptr;
-    std::atomic<std::byte*> _first_free_node = nullptr;
+    std::atomic<uint64_t> _first_free_node = {0};
     size_t _buffer_size = 0;
     size_t _block_size = 0;
 };
@@ -0,0 +1,220 @@
+#include "atomic_virtual_linear_allocator.hh"
+
+#include <cstring>
+
+#include <clean-core/bits.hh>
+#include <clean-core/macros.hh>
+#include <clean-core/utility.hh>
+
+#include <clean-core/native/memory.hh>
+
+namespace
+{
+// the chunk a thread currently bump-allocates in, for a single allocator + reset generation
+struct avla_thread_chunk
+{
+    uint64_t cache_key = 0;
+    std::byte* head = nullptr;
+    std::byte* end = nullptr;
+    std::byte* last_allocation = nullptr;
+};
+
+// a thread usually only interleaves very few of these allocators, the oldest entry is evicted on overflow
+enum
+{
+    avla_num_cached_chunks = 4
+};
+
+thread_local avla_thread_chunk tl_avla_chunks[avla_num_cached_chunks] = {};
+thread_local unsigned tl_avla_next_evicted = 0;
+
+// ids are never reused so caches of destroyed allocators can't alias new ones at the same address
+std::atomic<uint32_t> s_avla_next_id = {1};
+
+avla_thread_chunk* avla_find_thread_chunk(uint64_t cache_key)
+{
+    for (auto& chunk : tl_avla_chunks)
+    {
+        if (chunk.cache_key == cache_key)
+            return &chunk;
+    }
+
+    return nullptr;
+}
+
+// [size_t size header] [data]
+std::byte* avla_bump(avla_thread_chunk& chunk, size_t size, size_t align)
+{
+    std::byte* const padded_res = cc::align_up(chunk.head + sizeof(size_t), align);
+
+    if (padded_res + size > chunk.end)
+        return nullptr;
+
+    std::memcpy(padded_res - sizeof(size_t), &size, sizeof(size_t));
+
+    chunk.head = padded_res + size;
+    chunk.last_allocation = padded_res;
+    return padded_res;
+}
+}
+
+void cc::atomic_virtual_linear_allocator::initialize(size_t max_size_bytes, size_t chunk_size_bytes)
+{
+    CC_ASSERT(_virtual_begin == nullptr && "double initialize");
+    CC_ASSERT(max_size_bytes > 0 && chunk_size_bytes > 0 && "invalid sizes");
+    // the cast is necessary on apple M1
+    CC_ASSERT(is_pow2(uint64_t(chunk_size_bytes)) && "Chunk size must be a power of 2");
+    CC_ASSERT(chunk_size_bytes <= max_size_bytes && "Chunk size larger than the virtual range");
+
+    _virtual_begin = reserve_virtual_memory(max_size_bytes);
+    _virtual_end = _virtual_begin + max_size_bytes;
+    _physical_end = _virtual_begin;
+    _chunk_size_bytes = chunk_size_bytes;
+    _cache_key = uint64_t(s_avla_next_id.fetch_add(1, std::memory_order_relaxed)) << 32;
+    _claimed_bytes.store(0, std::memory_order_relaxed);
+
+    CC_ASSERT(_virtual_begin != nullptr && "virtual reserve failed");
+}
+
+void cc::atomic_virtual_linear_allocator::destroy()
+{
+    if (_virtual_begin)
+    {
+        free_virtual_memory(_virtual_begin, _virtual_end - _virtual_begin);
+        _virtual_begin = nullptr;
+        _virtual_end = nullptr;
+        _physical_end = nullptr;
+        _cache_key = 0;
+        _claimed_bytes.store(0, std::memory_order_relaxed);
+    }
+}
+
+std::byte* cc::atomic_virtual_linear_allocator::alloc(size_t size, size_t align)
+{
+    CC_ASSERT(_virtual_begin != nullptr && "atomic_virtual_linear_allocator uninitialized");
+
+    align = cc::max<size_t>(align, 1);
+
+    avla_thread_chunk* chunk = avla_find_thread_chunk(_cache_key);
+
+    // fast path: bump inside the current chunk of this thread, no synchronization
+    if (CC_LIKELY(chunk != nullptr))
+    {
+        if (std::byte* const res = avla_bump(*chunk, size, align))
+            return res;
+    }
+
+    size_t const worst_case_size = size + (align - 1) + sizeof(size_t);
+
+    if (worst_case_size > _chunk_size_bytes)
+    {
+        // too large for a chunk, claim a dedicated range and keep the current chunk
+        avla_thread_chunk dedicated;
+        dedicated.head = _claim_range(cc::align_up(worst_case_size, _chunk_size_bytes));
+        dedicated.end = dedicated.head + cc::align_up(worst_case_size, _chunk_size_bytes);
+        return avla_bump(dedicated, size, align);
+    }
+
+    // claim a new chunk for this thread
+    if (chunk == nullptr)
+    {
+        chunk = &tl_avla_chunks[tl_avla_next_evicted];
+        tl_avla_next_evicted = (tl_avla_next_evicted + 1) % avla_num_cached_chunks;
+    }
+
+    chunk->cache_key = _cache_key;
+    chunk->head = _claim_range(_chunk_size_bytes);
+    chunk->end = chunk->head + _chunk_size_bytes;
+    chunk->last_allocation = nullptr;
+
+    std::byte* const res = avla_bump(*chunk, size, align);
+    CC_ASSERT(res != nullptr && "fresh chunk too small");
+    return res;
+}
+
+std::byte* cc::atomic_virtual_linear_allocator::realloc(void* ptr, size_t new_size, size_t align)
+{
+    avla_thread_chunk* const chunk = ptr ? avla_find_thread_chunk(_cache_key) : nullptr;
+
+    if (chunk == nullptr || chunk->last_allocation != ptr || new_size == 0)
+    {
+        // cannot realloc in place, fall back (this is not invalid usage)
+        return cc::allocator::realloc(ptr, new_size, align);
+    }
+
+    // true realloc, only touches the chunk of this thread
+    std::byte* const byte_ptr = static_cast<std::byte*>(ptr);
+
+    if (byte_ptr + new_size > chunk->end)
+        return cc::allocator::realloc(ptr, new_size, align);
+
+    std::memcpy(byte_ptr - sizeof(size_t), &new_size, sizeof(size_t));
+    chunk->head = byte_ptr + new_size;
+    return byte_ptr;
+}
+
+bool cc::atomic_virtual_linear_allocator::get_allocation_size(void const* ptr, size_t& out_size)
+{
+    if (!ptr)
+        return false;
+
+    std::memcpy(&out_size, static_cast<std::byte const*>(ptr) - sizeof(size_t), sizeof(size_t));
+    return true;
+}
+
+size_t cc::atomic_virtual_linear_allocator::reset()
+{
+    size_t const num_bytes_claimed = _claimed_bytes.exchange(0, std::memory_order_acq_rel);
+
+    // everything claimed so far has been committed by the claiming threads
+    std::byte* const claimed_end = _virtual_begin + cc::min<size_t>(num_bytes_claimed, get_virtual_size_bytes());
+    _physical_end = cc::max(_physical_end, claimed_end);
+
+    // invalidates all thread_local chunks of this allocator
+    _cache_key = (_cache_key & 0xFFFFFFFF00000000uLL) | ((_cache_key + 1) & 0xFFFFFFFFuLL);
+
+    return num_bytes_claimed;
+}
+
+size_t cc::atomic_virtual_linear_allocator::decommit_idle_memory()
+{
+    std::byte* const claimed_end = _virtual_begin + cc::min<size_t>(_claimed_bytes.load(std::memory_order_acquire), get_virtual_size_bytes());
+    _physical_end = cc::max(_physical_end, claimed_end);
+
+    // claimed ranges always end on a chunk boundary, free all memory between that and _physical_end
+    ptrdiff_t const size_to_free = _physical_end - claimed_end;
+
+    if (size_to_free > 0)
+    {
+        decommit_physical_memory(claimed_end, size_t(size_to_free));
+        _physical_end = claimed_end;
+    }
+
+    return size_to_free;
+}
+
+size_t cc::atomic_virtual_linear_allocator::get_physical_size_bytes() const
+{
+    std::byte* const claimed_end = _virtual_begin + get_allocated_size_bytes();
+    return cc::max(_physical_end, claimed_end) - _virtual_begin;
+}
+
+std::byte* cc::atomic_virtual_linear_allocator::_claim_range(size_t size)
+{
+    CC_ASSERT(size % _chunk_size_bytes == 0 && "claims must be multiples of the chunk size");
+
+    size_t const offset = _claimed_bytes.fetch_add(size, std::memory_order_relaxed);
+    CC_ASSERT(offset + size <= get_virtual_size_bytes() && "atomic_virtual_linear_allocator: virtual memory overcommitted");
+
+    std::byte* const res = _virtual_begin + offset;
+
+    // commit the part of the range not already committed before the last reset
+    // ranges are disjoint, so no other thread touches these pages
+    if (res + size > _physical_end)
+    {
+        std::byte* const commit_begin = cc::max(res, _physical_end);
+        commit_physical_memory(commit_begin, size_t(res + size - commit_begin));
+    }
+
+    return res;
+}
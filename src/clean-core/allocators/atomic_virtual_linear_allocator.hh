@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include <clean-core/allocator.hh>
+
+namespace cc
+{
+/// thread safe, lock-free linear allocator operating in virtual memory
+/// reserves pages on init, threads claim chunks of the range with a single atomic add
+/// and then bump-allocate inside their chunk without any synchronization
+/// physical memory is committed lazily, one chunk at a time
+/// only frees pages if explicitly called
+///
+/// each thread caches its current chunk for the last few allocators it used (thread_local)
+/// allocations larger than a chunk receive a dedicated range
+///
+/// RESTRICTION: reset(), decommit_idle_memory() and destroy() must not race with alloc()
+struct atomic_virtual_linear_allocator final : allocator
+{
+    atomic_virtual_linear_allocator() = default;
+    explicit atomic_virtual_linear_allocator(size_t max_size_bytes, size_t chunk_size_bytes = 65536)
+    {
+        initialize(max_size_bytes, chunk_size_bytes);
+    }
+    ~atomic_virtual_linear_allocator() override { destroy(); }
+
+    // max_size_bytes: amount of contiguous virtual memory being reserved
+    // chunk_size_bytes: size of the per-thread chunks, physical memory is committed in these increments
+    // note there is a lower limit on virtual allocation granularity (Win32: 64K = 16 pages)
+    void initialize(size_t max_size_bytes, size_t chunk_size_bytes = 65536);
+
+    void destroy();
+
+    std::byte* alloc(size_t size, size_t align = alignof(std::max_align_t)) override;
+
+    void free(void* ptr) override { (void)ptr; }
+
+    void free_sized(void* ptr, size_t size, size_t align = alignof(std::max_align_t)) override
+    {
+        (void)ptr;
+        (void)size;
+        (void)align;
+    }
+
+    void free_batch(cc::span<void* const> ptrs) override { (void)ptrs; }
+
+    bool is_free_noop() const override { return true; }
+
+    /// NOTE: grows in place if ptr is the most recent allocation of the calling thread and it still fits its chunk
+    std::byte* realloc(void* ptr, size_t new_size, size_t align = alignof(std::max_align_t)) override;
+
+    bool get_allocation_size(void const* ptr, size_t& out_size) override;
+
+    char const* get_name() const override { return "Atomic Virtual Linear Allocator"; }
+
+    // free all current allocations of all threads
+    // does not decommit any memory!
+    // returns the amount of bytes claimed before the reset (including unused chunk remainders)
+    size_t reset();
+
+    // decommit the physical memory of all pages not currently claimed
+    // returns amount of bytes decommitted
+    size_t decommit_idle_memory();
+
+    // amount of bytes in the virtual address range
+    size_t get_virtual_size_bytes() const { return _virtual_end - _virtual_begin; }
+
+    // amount of bytes in the physically committed memory (approximate while allocations are running)
+    size_t get_physical_size_bytes() const;
+
+    // amount of bytes claimed by threads (including unused chunk remainders)
+    size_t get_allocated_size_bytes() const { return cc::min<size_t>(_claimed_bytes.load(std::memory_order_relaxed), get_virtual_size_bytes()); }
+
+    size_t get_chunk_size_bytes() const { return _chunk_size_bytes; }
+
+    atomic_virtual_linear_allocator(atomic_virtual_linear_allocator const&) = delete;
+    atomic_virtual_linear_allocator& operator=(atomic_virtual_linear_allocator const&) = delete;
+    atomic_virtual_linear_allocator(atomic_virtual_linear_allocator&&) = delete;
+    atomic_virtual_linear_allocator& operator=(atomic_virtual_linear_allocator&&) = delete;
+
+private:
+    // claims a range of the given size with a single atomic add, commits its pages
+    std::byte* _claim_range(size_t size);
+
+private:
+    std::byte* _virtual_begin = nullptr;
+    std::byte* _virtual_end = nullptr;
+    size_t _chunk_size_bytes = 0;
+
+    // physical memory committed up to this point before the last reset
+    // pages of newly claimed ranges past this are committed by the claiming thread
+    std::byte* _physical_end = nullptr;
+
+    // identifies this allocator and its current reset generation in the thread_local chunk caches
+    // upper 32 bit: unique id (new per initialize), lower 32 bit: generation (bumped per reset)
+    uint64_t _cache_key = 0;
+
+    alignas(64) std::atomic<size_t> _claimed_bytes = {0};
+};
+}
@@ -32,6 +32,43 @@ struct linear_allocator final : allocator
         (void)ptr;
     }
 
+    void free_sized(void* ptr, size_t size, size_t align = alignof(std::max_align_t)) override
+    {
+        // no-op
+        (void)ptr;
+        (void)size;
+        (void)align;
+    }
+
+    void free_batch(cc::span<void* const> ptrs) override
+    {
+        // no-op
+        (void)ptrs;
+    }
+
+    bool is_free_noop() const override { return true; }
+
+    // single bump for all allocations
+    void alloc_batch(size_t size, size_t align, cc::span<std::byte*> out_ptrs) override
+    {
+        CC_ASSERT(_buffer_begin != nullptr && "linear_allocator uninitialized");
+
+        if (out_ptrs.empty())
+            return;
+
+        align = cc::max<size_t>(align, 1);
+        size_t const stride = cc::align_up(size, align);
+
+        auto* const padded_res = cc::align_up(_head, align);
+        CC_ASSERT(padded_res + stride * (out_ptrs.size() - 1) + size <= _buffer_end && "linear_allocator overcommitted");
+
+        for (size_t i = 0; i < out_ptrs.size(); ++i)
+            out_ptrs[i] = padded_res + stride * i;
+
+        _latest_allocation = out_ptrs.back();
+        _head = _latest_allocation + size;
+    }
+
     bool get_allocation_size(void const* ptr, size_t& out_size) override
     {
         if (!ptr || ptr != _latest_allocation)
@@ -62,6 +99,20 @@ struct linear_allocator final : allocator
         return cc::allocator::realloc(ptr, new_size, align);
     }
 
+    // succeeds for the most recent allocation if the buffer has enough space
+    bool try_resize_in_place(void* ptr, size_t new_size) override
+    {
+        if (!ptr || ptr != _latest_allocation)
+            return false;
+
+        std::byte* const ptr_byte = static_cast<std::byte*>(ptr);
+        if (ptr_byte + new_size > _buffer_end)
+            return false;
+
+        _head = ptr_byte + new_size;
+        return true;
+    }
+
     char const* get_name() const override { return "Linear Allocator"; }
 
     void reset()
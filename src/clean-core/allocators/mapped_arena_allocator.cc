@@ -0,0 +1,285 @@
+#include "mapped_arena_allocator.hh"
+
+#include <clean-core/assert.hh>
+#include <clean-core/macros.hh>
+#include <clean-core/utility.hh>
+
+#include <clean-core/native/memory.hh>
+
+#if defined(CC_OS_LINUX) || defined(CC_OS_APPLE)
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace
+{
+// the file grows in multiples of this, must be a multiple of the page size
+constexpr size_t mapped_arena_granularity = 65536;
+
+constexpr uint64_t mapped_arena_magic = 0x414e455241434343; // "CCCARENA"
+constexpr uint32_t mapped_arena_version = 1;
+
+// allocations start after the file header
+constexpr uint64_t mapped_arena_data_begin = 64;
+}
+
+// first bytes of the file, all positions are offsets from the start of the mapping
+struct cc::mapped_arena_allocator::file_header
+{
+    uint64_t magic;
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t allocated_end;
+    uint64_t last_allocation; // 0 if none
+    uint64_t root;            // 0 if none
+};
+
+bool cc::mapped_arena_allocator::initialize(char const* path, size_t max_size_bytes, size_t initial_size_bytes)
+{
+    static_assert(sizeof(file_header) <= mapped_arena_data_begin, "header does not fit");
+    CC_ASSERT(_virtual_begin == nullptr && "double init");
+    CC_ASSERT(path != nullptr && max_size_bytes > 0 && "invalid arguments");
+
+    max_size_bytes = cc::align_up(max_size_bytes, mapped_arena_granularity);
+    initial_size_bytes = cc::clamp(cc::align_up(initial_size_bytes, mapped_arena_granularity), mapped_arena_granularity, max_size_bytes);
+
+#if defined(CC_OS_LINUX) || defined(CC_OS_APPLE)
+
+    int const file = ::open(path, O_RDWR | O_CREAT, 0644);
+    if (file < 0)
+        return false;
+
+    struct stat file_stat;
+    if (::fstat(file, &file_stat) != 0)
+    {
+        ::close(file);
+        return false;
+    }
+
+    size_t file_size = size_t(file_stat.st_size);
+    bool const is_existing = file_size > 0;
+
+    if (is_existing)
+    {
+        // validate before mapping anything
+        file_header header;
+        bool const is_valid = file_size % mapped_arena_granularity == 0 && file_size <= max_size_bytes //
+                              && ::pread(file, &header, sizeof(header), 0) == ssize_t(sizeof(header))     //
+                              && header.magic == mapped_arena_magic && header.version == mapped_arena_version
+                              && header.header_size == sizeof(file_header) && header.allocated_end <= file_size;
+        if (!is_valid)
+        {
+            ::close(file);
+            return false;
+        }
+    }
+    else
+    {
+        if (::ftruncate(file, off_t(initial_size_bytes)) != 0)
+        {
+            ::close(file);
+            return false;
+        }
+        file_size = initial_size_bytes;
+    }
+
+    // map the file over the start of the reserved range
+    std::byte* const virtual_begin = reserve_virtual_memory(max_size_bytes);
+    void* const mapped = ::mmap(virtual_begin, file_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, file, 0);
+    if (mapped == MAP_FAILED)
+    {
+        free_virtual_memory(virtual_begin, max_size_bytes);
+        ::close(file);
+        return false;
+    }
+
+    _virtual_begin = virtual_begin;
+    _virtual_end = virtual_begin + max_size_bytes;
+    _file_size = file_size;
+    _file = file;
+    _is_reattached = is_existing;
+
+    if (!is_existing)
+    {
+        auto* const header = _header();
+        header->magic = mapped_arena_magic;
+        header->version = mapped_arena_version;
+        header->header_size = sizeof(file_header);
+        header->allocated_end = mapped_arena_data_begin;
+        header->last_allocation = 0;
+        header->root = 0;
+    }
+
+    return true;
+
+#else
+    (void)path;
+    CC_ASSERT(false && "mapped_arena_allocator is not supported on this platform");
+    return false;
+#endif
+}
+
+void cc::mapped_arena_allocator::destroy()
+{
+    if (!_virtual_begin)
+        return;
+
+#if defined(CC_OS_LINUX) || defined(CC_OS_APPLE)
+    // unmaps the file as well, dirty pages are written back by the OS
+    free_virtual_memory(_virtual_begin, _virtual_end - _virtual_begin);
+    ::close(_file);
+#endif
+
+    _virtual_begin = nullptr;
+    _virtual_end = nullptr;
+    _file_size = 0;
+    _file = -1;
+    _is_reattached = false;
+}
+
+std::byte* cc::mapped_arena_allocator::alloc(size_t size, size_t align)
+{
+    CC_ASSERT(_virtual_begin != nullptr && "mapped_arena_allocator uninitialized");
+    auto* const header = _header();
+
+    std::byte* const padded_res = cc::align_up(_virtual_begin + header->allocated_end + sizeof(uint64_t), align);
+    size_t const new_end = size_t(padded_res - _virtual_begin) + size;
+
+    if (new_end > _file_size)
+        _grow_file(new_end);
+
+    // store alloc size
+    *((uint64_t*)(padded_res - sizeof(uint64_t))) = size;
+
+    header->allocated_end = new_end;
+    header->last_allocation = uint64_t(padded_res - _virtual_begin);
+    return padded_res;
+}
+
+std::byte* cc::mapped_arena_allocator::realloc(void* ptr, size_t new_size, size_t align)
+{
+    CC_ASSERT(_virtual_begin != nullptr && "mapped_arena_allocator uninitialized");
+    auto* const header = _header();
+
+    if (!ptr || to_offset(ptr) != header->last_allocation)
+    {
+        // cannot realloc in place, fall back
+        return cc::allocator::realloc(ptr, new_size, align);
+    }
+
+    std::byte* const byte_ptr = static_cast<std::byte*>(ptr);
+    size_t const new_end = size_t(byte_ptr - _virtual_begin) + new_size;
+
+    if (new_end > _file_size)
+        _grow_file(new_end);
+
+    // store new alloc size
+    *((uint64_t*)(byte_ptr - sizeof(uint64_t))) = new_size;
+
+    header->allocated_end = new_end;
+    return byte_ptr;
+}
+
+bool cc::mapped_arena_allocator::try_resize_in_place(void* ptr, size_t new_size)
+{
+    CC_ASSERT(_virtual_begin != nullptr && "mapped_arena_allocator uninitialized");
+
+    if (!ptr || to_offset(ptr) != _header()->last_allocation)
+        return false;
+
+    if (static_cast<std::byte*>(ptr) + new_size > _virtual_end)
+        return false;
+
+    // same as the in-place path of realloc
+    realloc(ptr, new_size);
+    return true;
+}
+
+bool cc::mapped_arena_allocator::get_allocation_size(void const* ptr, size_t& out_size)
+{
+    if (!ptr)
+        return false;
+
+    out_size = size_t(*((uint64_t const*)((std::byte const*)ptr - sizeof(uint64_t))));
+    return true;
+}
+
+size_t cc::mapped_arena_allocator::reset()
+{
+    CC_ASSERT(_virtual_begin != nullptr && "mapped_arena_allocator uninitialized");
+    auto* const header = _header();
+
+    size_t const num_bytes_allocated = size_t(header->allocated_end - mapped_arena_data_begin);
+    header->allocated_end = mapped_arena_data_begin;
+    header->last_allocation = 0;
+    header->root = 0;
+    return num_bytes_allocated;
+}
+
+void cc::mapped_arena_allocator::checkpoint(bool blocking)
+{
+    CC_ASSERT(_virtual_begin != nullptr && "mapped_arena_allocator uninitialized");
+
+#if defined(CC_OS_LINUX) || defined(CC_OS_APPLE)
+    // pages past allocated_end are never written, the header is in the first page
+    int const res = ::msync(_virtual_begin, size_t(_header()->allocated_end), blocking ? MS_SYNC : MS_ASYNC);
+    CC_ASSERT(res == 0 && "msync failed");
+#else
+    (void)blocking;
+#endif
+}
+
+std::byte* cc::mapped_arena_allocator::get_root() const
+{
+    CC_ASSERT(_virtual_begin != nullptr && "mapped_arena_allocator uninitialized");
+    return from_offset(_header()->root);
+}
+
+void cc::mapped_arena_allocator::set_root(void const* ptr)
+{
+    CC_ASSERT(_virtual_begin != nullptr && "mapped_arena_allocator uninitialized");
+    _header()->root = to_offset(ptr);
+}
+
+uint64_t cc::mapped_arena_allocator::to_offset(void const* ptr) const
+{
+    if (ptr == nullptr)
+        return 0;
+
+    std::byte const* const byte_ptr = static_cast<std::byte const*>(ptr);
+    CC_ASSERT(byte_ptr >= _virtual_begin + mapped_arena_data_begin && byte_ptr <= _virtual_begin + _file_size && "pointer not inside the arena");
+    return uint64_t(byte_ptr - _virtual_begin);
+}
+
+std::byte* cc::mapped_arena_allocator::from_offset(uint64_t offset) const
+{
+    if (offset == 0)
+        return nullptr;
+
+    CC_ASSERT(offset >= mapped_arena_data_begin && offset <= _file_size && "offset not inside the arena");
+    return _virtual_begin + offset;
+}
+
+size_t cc::mapped_arena_allocator::get_allocated_size_bytes() const { return _virtual_begin ? size_t(_header()->allocated_end) : 0; }
+
+void cc::mapped_arena_allocator::_grow_file(size_t required_file_size)
+{
+    size_t const virtual_size = get_virtual_size_bytes();
+    CC_ASSERT(required_file_size <= virtual_size && "mapped_arena_allocator: virtual memory exhausted");
+
+    // grow geometrically to keep the amount of mappings low
+    size_t const new_file_size = cc::min(cc::max(cc::align_up(required_file_size, mapped_arena_granularity), _file_size * 2), virtual_size);
+
+#if defined(CC_OS_LINUX) || defined(CC_OS_APPLE)
+    int const res = ::ftruncate(_file, off_t(new_file_size));
+    CC_ASSERT(res == 0 && "failed to grow file");
+
+    void* const mapped = ::mmap(_virtual_begin + _file_size, new_file_size - _file_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, _file, off_t(_file_size));
+    CC_ASSERT(mapped != MAP_FAILED && "failed to map grown file");
+#endif
+
+    _file_size = new_file_size;
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstdint>
+
+#include <clean-core/allocator.hh>
+
+namespace cc
+{
+/// persistent linear allocator operating in a memory-mapped file
+/// reserves a virtual address range on init and maps the file (MAP_SHARED) to its start
+/// the file grows on demand, its pages are the physical memory of the arena
+///
+/// all metadata in the file is stored as offsets relative to the start of the mapping
+/// reopening the file reattaches to the previous heap without rebuilding anything
+/// data structures inside the arena must also use offsets (see to_offset / from_offset),
+/// the mapping can be at a different address in every process
+///
+/// Usage:
+///
+///   cc::mapped_arena_allocator arena;
+///   arena.initialize("lookup.bin", 1ull << 36);
+///   if (!arena.is_reattached())
+///       arena.set_root(build_lookup(arena));
+///   auto* lookup = reinterpret_cast<lookup_table*>(arena.get_root());
+///
+/// writes are visible to other mappings of the file immediately and survive process restarts,
+/// checkpoint() additionally flushes them to disk (required for surviving system crashes)
+///
+/// NOTE: allocation is linear, free() is a no-op, reset() releases all allocations
+///       (TLSF keeps raw pointers in its control structure and cannot be relocated)
+/// NOTE: currently only supported on Linux and Apple
+/// RESTRICTION: not thread safe, a file must only be opened by one allocator at a time
+struct mapped_arena_allocator final : allocator
+{
+    mapped_arena_allocator() = default;
+    ~mapped_arena_allocator() override { destroy(); }
+
+    // path: file to create or reopen
+    // max_size_bytes: amount of contiguous virtual memory being reserved, upper limit of the file size
+    // initial_size_bytes: size of a newly created file
+    // returns false if the file cannot be opened or is not a valid arena
+    bool initialize(char const* path, size_t max_size_bytes, size_t initial_size_bytes = 1 << 20);
+
+    // unmaps and closes the file, all allocations stay in the file
+    void destroy();
+
+    std::byte* alloc(size_t size, size_t align = alignof(std::max_align_t)) override;
+
+    void free(void* ptr) override { (void)ptr; }
+
+    void free_sized(void* ptr, size_t size, size_t align = alignof(std::max_align_t)) override
+    {
+        (void)ptr;
+        (void)size;
+        (void)align;
+    }
+
+    void free_batch(cc::span<void* const> ptrs) override { (void)ptrs; }
+
+    bool is_free_noop() const override { return true; }
+
+    /// NOTE: grows in place if ptr is the most recent allocation
+    std::byte* realloc(void* ptr, size_t new_size, size_t align = alignof(std::max_align_t)) override;
+
+    // succeeds for the most recent allocation if the virtual range has enough space
+    bool try_resize_in_place(void* ptr, size_t new_size) override;
+
+    bool get_allocation_size(void const* ptr, size_t& out_size) override;
+
+    char const* get_name() const override { return "Mapped Arena Allocator"; }
+
+    // free all current allocations and clears the root
+    // does not shrink the file
+    size_t reset();
+
+    // flushes all modified pages of the arena to the file
+    // blocking: waits until the write is complete, otherwise only schedules it
+    void checkpoint(bool blocking = true);
+
+    // true if initialize() attached to an existing heap instead of creating a new one
+    bool is_reattached() const { return _is_reattached; }
+
+    // the root object of the arena, the entry point to reattach to persistent data structures
+    // nullptr if none has been set
+    std::byte* get_root() const;
+    void set_root(void const* ptr);
+
+    // converts between pointers into the arena and their offsets, which are stable across mappings
+    // nullptr corresponds to offset 0
+    uint64_t to_offset(void const* ptr) const;
+    std::byte* from_offset(uint64_t offset) const;
+
+    // amount of bytes in the virtual address range
+    size_t get_virtual_size_bytes() const { return _virtual_end - _virtual_begin; }
+
+    // size of the file (the mapped part of the range)
+    size_t get_file_size_bytes() const { return _file_size; }
+
+    // amount of bytes in the file used by allocations (including the arena header)
+    size_t get_allocated_size_bytes() const;
+
+    mapped_arena_allocator(mapped_arena_allocator const&) = delete;
+    mapped_arena_allocator& operator=(mapped_arena_allocator const&) = delete;
+    mapped_arena_allocator(mapped_arena_allocator&&) = delete;
+    mapped_arena_allocator& operator=(mapped_arena_allocator&&) = delete;
+
+private:
+    struct file_header;
+
+    file_header* _header() const { return reinterpret_cast<file_header*>(_virtual_begin); }
+
+    // grows the file to at least the required size and maps the new part
+    void _grow_file(size_t required_file_size);
+
+private:
+    std::byte* _virtual_begin = nullptr;
+    std::byte* _virtual_end = nullptr;
+    size_t _file_size = 0;
+    int _file = -1;
+    bool _is_reattached = false;
+};
+}
@@ -0,0 +1,104 @@
+#include "object_arena.hh"
+
+#include <clean-core/bits.hh>
+#include <clean-core/utility.hh>
+
+#include <clean-core/native/memory.hh>
+
+void cc::object_arena::initialize(size_t max_size_bytes, size_t chunk_size_bytes)
+{
+    CC_ASSERT(_virtual_begin == nullptr && "double init");
+    CC_ASSERT(max_size_bytes > 0 && chunk_size_bytes > 0 && "invalid sizes");
+    CC_ASSERT(is_pow2(uint64_t(chunk_size_bytes)) && "Chunk size must be a power of 2");
+
+    _virtual_begin = reserve_virtual_memory(max_size_bytes);
+    _virtual_end = _virtual_begin + max_size_bytes;
+    _physical_current = _virtual_begin;
+    _physical_end = _virtual_begin;
+    _chunk_size_bytes = chunk_size_bytes;
+
+    CC_ASSERT(_virtual_begin != nullptr && "virtual reserve failed");
+}
+
+void cc::object_arena::destroy()
+{
+    if (!_virtual_begin)
+        return;
+
+    reset();
+    free_virtual_memory(_virtual_begin, _virtual_end - _virtual_begin);
+
+    _virtual_begin = nullptr;
+    _virtual_end = nullptr;
+    _physical_current = nullptr;
+    _physical_end = nullptr;
+}
+
+size_t cc::object_arena::reset()
+{
+    // newest first
+    dtor_entry* entry = _last_entry;
+    while (entry)
+    {
+        dtor_entry* const prev = entry->prev;
+        entry->destroy(entry);
+        entry = prev;
+    }
+
+    _last_entry = nullptr;
+    _num_destructors = 0;
+    _last_allocation = nullptr;
+
+    size_t const num_bytes_allocated = _physical_current - _virtual_begin;
+    _physical_current = _virtual_begin;
+    return num_bytes_allocated;
+}
+
+std::byte* cc::object_arena::realloc(void* ptr, size_t new_size, size_t align)
+{
+    if (!ptr || ptr != _last_allocation)
+    {
+        // cannot realloc in place, fall back
+        return cc::allocator::realloc(ptr, new_size, align);
+    }
+
+    std::byte* const byte_ptr = static_cast<std::byte*>(ptr);
+    std::byte* const new_current = byte_ptr + new_size;
+
+    if (new_current > _physical_end)
+        _grow(new_current);
+
+    // store new alloc size
+    *reinterpret_cast<size_t*>(byte_ptr - sizeof(size_t)) = new_size;
+
+    _physical_current = new_current;
+    return byte_ptr;
+}
+
+bool cc::object_arena::try_resize_in_place(void* ptr, size_t new_size)
+{
+    if (!ptr || ptr != _last_allocation)
+        return false;
+
+    if (static_cast<std::byte*>(ptr) + new_size > _virtual_end)
+        return false;
+
+    // same as the in-place path of realloc
+    realloc(ptr, new_size);
+    return true;
+}
+
+bool cc::object_arena::get_allocation_size(void const* ptr, size_t& out_size)
+{
+    if (!ptr)
+        return false;
+
+    out_size = *reinterpret_cast<size_t const*>(static_cast<std::byte const*>(ptr) - sizeof(size_t));
+    return true;
+}
+
+void cc::object_arena::_grow(std::byte* new_current)
+{
+    CC_ASSERT(_virtual_begin != nullptr && "object_arena uninitialized");
+    _physical_end = grow_physical_memory(_physical_current, _physical_end, _virtual_end, _chunk_size_bytes, size_t(new_current - _physical_current));
+}
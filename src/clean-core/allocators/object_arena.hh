@@ -0,0 +1,243 @@
+#pragma once
+
+#include <type_traits>
+
+#include <clean-core/allocator.hh>
+#include <clean-core/assert.hh>
+#include <clean-core/forward.hh>
+#include <clean-core/macros.hh>
+#include <clean-core/new.hh>
+
+namespace cc
+{
+/// linear arena for objects, runs their destructors on reset()
+/// reserves pages on init, commits pages on demand (like virtual_linear_allocator)
+///
+/// new_t / new_array allocate objects with a bump pointer
+/// only non-trivially destructible types additionally record a 16 byte entry (24 for arrays) in front of the object,
+/// reset() and destroy() run the recorded destructors in reverse order before rewinding
+///
+/// Usage:
+///
+///   cc::object_arena arena(1ull << 30);
+///   auto* req = arena.new_t<request>(...);       // request can contain strings, vectors, unique_functions, ...
+///   auto* ids = arena.new_array<int>(num_ids);   // no destructor entry
+///   ...
+///   arena.reset();                               // ~request(), then all memory is reused
+///
+/// as a cc::allocator, the raw memory (alloc / realloc) is not tracked and free() is a no-op
+/// this way containers inside arena objects can allocate from the arena as well
+///
+/// NOTE: objects of new_t / new_array must not be deleted manually (delete_t etc.)
+/// RESTRICTION: not thread safe, destructors must not allocate from the arena
+struct object_arena final : allocator
+{
+    object_arena() = default;
+    explicit object_arena(size_t max_size_bytes, size_t chunk_size_bytes = 65536) { initialize(max_size_bytes, chunk_size_bytes); }
+    ~object_arena() override { destroy(); }
+
+    // max_size_bytes: amount of contiguous virtual memory being reserved
+    // chunk_size_bytes: increment of physical memory being committed whenever more is required
+    void initialize(size_t max_size_bytes, size_t chunk_size_bytes = 65536);
+
+    // runs all destructors and frees the memory
+    void destroy();
+
+    /// allocate and construct an object, its destructor runs on reset()
+    template <class T, class... Args>
+    [[nodiscard]] T* new_t(Args&&... args);
+
+    /// allocate and default-construct an array, the destructors run on reset()
+    template <class T>
+    [[nodiscard]] T* new_array(size_t num_elems);
+
+    template <class T>
+    void delete_t(T* ptr) = delete;
+    template <class T>
+    void delete_array(T* ptr) = delete;
+
+    // runs the destructors of all objects in reverse order of construction, then frees all allocations
+    // does not decommit any memory!
+    // returns the amount of bytes allocated before the reset
+    size_t reset();
+
+    std::byte* alloc(size_t size, size_t align = alignof(std::max_align_t)) override
+    {
+        // store alloc size in front for realloc
+        std::byte* const res = _bump_with_header(size, align);
+        _last_allocation = res;
+        return res;
+    }
+
+    void free(void* ptr) override { (void)ptr; }
+
+    void free_sized(void* ptr, size_t size, size_t align = alignof(std::max_align_t)) override
+    {
+        (void)ptr;
+        (void)size;
+        (void)align;
+    }
+
+    void free_batch(cc::span<void* const> ptrs) override { (void)ptrs; }
+
+    bool is_free_noop() const override { return true; }
+
+    /// NOTE: grows in place if ptr is the most recent allocation
+    std::byte* realloc(void* ptr, size_t new_size, size_t align = alignof(std::max_align_t)) override;
+
+    // succeeds for the most recent allocation if the virtual range has enough space
+    bool try_resize_in_place(void* ptr, size_t new_size) override;
+
+    // only available for memory of alloc / realloc
+    bool get_allocation_size(void const* ptr, size_t& out_size) override;
+
+    char const* get_name() const override { return "Object Arena"; }
+
+    // amount of objects whose destructors run on the next reset()
+    size_t get_num_destructors() const { return _num_destructors; }
+
+    // amount of bytes in the virtual address range
+    size_t get_virtual_size_bytes() const { return _virtual_end - _virtual_begin; }
+
+    // amount of bytes in the physically committed memory
+    size_t get_physical_size_bytes() const { return _physical_end - _virtual_begin; }
+
+    // amount of bytes in the physically committed and allocated memory
+    size_t get_allocated_size_bytes() const { return _physical_current - _virtual_begin; }
+
+    object_arena(object_arena const&) = delete;
+    object_arena& operator=(object_arena const&) = delete;
+    object_arena(object_arena&&) = delete;
+    object_arena& operator=(object_arena&&) = delete;
+
+private:
+    // placed directly in front of (the padding of) each non-trivially destructible object
+    struct dtor_entry
+    {
+        void (*destroy)(dtor_entry* entry);
+        dtor_entry* prev;
+    };
+
+    struct array_dtor_entry : dtor_entry
+    {
+        size_t num_elems;
+    };
+
+    // the object follows its entry, padded to its alignment
+    template <class T, class EntryT>
+    static T* _object_after(EntryT* entry)
+    {
+        return reinterpret_cast<T*>(cc::align_up(reinterpret_cast<std::byte*>(entry) + sizeof(EntryT), alignof(T)));
+    }
+
+    template <class T>
+    static void _destroy_object(dtor_entry* entry)
+    {
+        _object_after<T>(entry)->~T();
+    }
+
+    template <class T>
+    static void _destroy_array(dtor_entry* entry)
+    {
+        auto* const array_entry = static_cast<array_dtor_entry*>(entry);
+        T* const objects = _object_after<T>(array_entry);
+        for (size_t i = array_entry->num_elems; i > 0; --i)
+            objects[i - 1].~T();
+    }
+
+    CC_FORCE_INLINE std::byte* _bump(size_t size, size_t align)
+    {
+        std::byte* const res = cc::align_up(_physical_current, align);
+        std::byte* const new_current = res + size;
+
+        if (CC_UNLIKELY(new_current > _physical_end))
+            _grow(new_current);
+
+        _physical_current = new_current;
+        _last_allocation = nullptr; // can no longer grow in place
+        return res;
+    }
+
+    // [size_t size] [data], the header occupies a whole alignment unit
+    std::byte* _bump_with_header(size_t size, size_t align)
+    {
+        size_t const header_size = align < sizeof(size_t) ? sizeof(size_t) : align;
+        std::byte* const padded_res = _bump(header_size + size, align) + header_size;
+        *reinterpret_cast<size_t*>(padded_res - sizeof(size_t)) = size;
+        return padded_res;
+    }
+
+    void _push_entry(dtor_entry* entry, void (*destroy)(dtor_entry*))
+    {
+        entry->destroy = destroy;
+        entry->prev = _last_entry;
+        _last_entry = entry;
+        ++_num_destructors;
+    }
+
+    // commits physical memory up to at least new_current
+    void _grow(std::byte* new_current);
+
+private:
+    std::byte* _physical_current = nullptr;
+    std::byte* _physical_end = nullptr;
+    dtor_entry* _last_entry = nullptr;
+    std::byte* _last_allocation = nullptr;
+    size_t _num_destructors = 0;
+
+    std::byte* _virtual_begin = nullptr;
+    std::byte* _virtual_end = nullptr;
+    size_t _chunk_size_bytes = 0;
+};
+
+//
+// implementation
+
+template <class T, class... Args>
+T* object_arena::new_t(Args&&... args)
+{
+    static_assert(sizeof(T) > 0, "cannot construct incomplete type");
+
+    if constexpr (std::is_trivially_destructible_v<T>)
+    {
+        return new (placement_new, _bump(sizeof(T), alignof(T))) T(cc::forward<Args>(args)...);
+    }
+    else
+    {
+        auto* const entry = reinterpret_cast<dtor_entry*>(_bump(sizeof(dtor_entry), alignof(dtor_entry)));
+        T* const res = new (placement_new, _bump(sizeof(T), alignof(T))) T(cc::forward<Args>(args)...);
+        CC_ASSERT(res == _object_after<T>(entry));
+
+        // only registered once constructed
+        _push_entry(entry, &_destroy_object<T>);
+        return res;
+    }
+}
+
+template <class T>
+T* object_arena::new_array(size_t num_elems)
+{
+    static_assert(sizeof(T) > 0, "cannot construct incomplete type");
+
+    if constexpr (std::is_trivially_destructible_v<T>)
+    {
+        T* const res = reinterpret_cast<T*>(_bump(sizeof(T) * num_elems, alignof(T)));
+        for (size_t i = 0; i < num_elems; ++i)
+            new (placement_new, res + i) T();
+        return res;
+    }
+    else
+    {
+        auto* const entry = reinterpret_cast<array_dtor_entry*>(_bump(sizeof(array_dtor_entry), alignof(array_dtor_entry)));
+        T* const res = reinterpret_cast<T*>(_bump(sizeof(T) * num_elems, alignof(T)));
+        CC_ASSERT(res == _object_after<T>(entry));
+
+        for (size_t i = 0; i < num_elems; ++i)
+            new (placement_new, res + i) T();
+
+        entry->num_elems = num_elems;
+        _push_entry(entry, &_destroy_array<T>);
+        return res;
+    }
+}
+}
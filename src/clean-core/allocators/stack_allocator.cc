@@ -1,45 +1,10 @@
 #include "stack_allocator.hh"
 
-#include <string.h>
-
 #include <clean-core/assert.hh>
 #include <clean-core/utility.hh>
 
 #include <clean-core/native/memory.hh>
 
-std::byte* cc::stack_allocator::alloc(size_t size, size_t align)
-{
-    CC_ASSERT(_buffer_begin != nullptr && "stack_allocator uninitialized");
-
-    auto* const padded_res = align_up_with_header(_head, align, sizeof(stack_alloc_header));
-
-    CC_ASSERT(padded_res + size <= _buffer_end && "stack_allocator overcommitted");
-
-    ++_last_alloc_id;
-    stack_alloc_header header = {};
-    header.padding = uint32_t(padded_res - _head);
-    header.alloc_id = _last_alloc_id;
-
-    ::memcpy(padded_res - sizeof(header), &header, sizeof(header));
-
-    _head = padded_res + size;
-    return padded_res;
-}
-
-void cc::stack_allocator::free(void* ptr)
-{
-    if (ptr == nullptr)
-        return;
-
-    std::byte* const byte_ptr = static_cast<std::byte*>(ptr);
-    stack_alloc_header const* const alloc_header = (stack_alloc_header*)(byte_ptr - sizeof(stack_alloc_header));
-
-    CC_ASSERT(alloc_header->alloc_id == _last_alloc_id && "freed ptr was not the most recent allocation");
-    --_last_alloc_id;
-
-    _head = byte_ptr - alloc_header->padding;
-}
-
 std::byte* cc::stack_allocator::realloc(void* ptr, size_t new_size, size_t align)
 {
     if (new_size == 0)
@@ -1,6 +1,11 @@
 #pragma once
 
+#include <cstring>
+
 #include <clean-core/allocator.hh>
+#include <clean-core/assert.hh>
+
+#include <clean-core/native/memory.hh>
 
 namespace cc
 {
@@ -10,10 +15,47 @@ namespace cc
 /// RESTRICTION: Must only free or realloc the most recent allocation
 struct stack_allocator final : allocator
 {
-    std::byte* alloc(size_t size, size_t align = alignof(std::max_align_t)) override;
+    std::byte* alloc(size_t size, size_t align = alignof(std::max_align_t)) override
+    {
+        CC_ASSERT(_buffer_begin != nullptr && "stack_allocator uninitialized");
+
+        auto* const padded_res = align_up_with_header(_head, align, sizeof(stack_alloc_header));
+
+        CC_ASSERT(padded_res + size <= _buffer_end && "stack_allocator overcommitted");
+
+        ++_last_alloc_id;
+        stack_alloc_header header = {};
+        header.padding = uint32_t(padded_res - _head);
+        header.alloc_id = _last_alloc_id;
+
+        std::memcpy(padded_res - sizeof(header), &header, sizeof(header));
+
+        _head = padded_res + size;
+        return padded_res;
+    }
 
     /// NOTE: ptr must be the most recent allocation received
-    void free(void* ptr) override;
+    void free(void* ptr) override
+    {
+        if (ptr == nullptr)
+            return;
+
+        std::byte* const byte_ptr = static_cast<std::byte*>(ptr);
+        stack_alloc_header const* const alloc_header = (stack_alloc_header*)(byte_ptr - sizeof(stack_alloc_header));
+
+        CC_ASSERT(alloc_header->alloc_id == _last_alloc_id && "freed ptr was not the most recent allocation");
+        --_last_alloc_id;
+
+        _head = byte_ptr - alloc_header->padding;
+    }
+
+    /// NOTE: ptr must be the most recent allocation received
+    void free_sized(void* ptr, size_t size, size_t align = alignof(std::max_align_t)) override
+    {
+        (void)size;
+        (void)align;
+        this->free(ptr);
+    }
 
     /// NOTE: ptr must be the most recent allocation received
     std::byte* realloc(void* ptr, size_t new_size, size_t align = alignof(std::max_align_t)) override;
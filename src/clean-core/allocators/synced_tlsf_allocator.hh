@@ -9,6 +9,7 @@
 namespace cc
 {
 /// Synchronized (mutexed) version of tlsf_allocator
+/// use cc::mutex instead of the default spin_lock if there can be more threads than cores
 template <class LockT = cc::spin_lock>
 struct synced_tlsf_allocator final : allocator
 {
@@ -29,12 +30,44 @@ struct synced_tlsf_allocator final : allocator
         _backing.free(ptr);
     }
 
+    void free_sized(void* ptr, size_t size, size_t align = alignof(std::max_align_t)) override
+    {
+        auto lg = cc::lock_guard(_lock);
+        _backing.free_sized(ptr, size, align);
+    }
+
+    // locks only once for all allocations
+    void alloc_batch(size_t size, size_t align, cc::span<std::byte*> out_ptrs) override
+    {
+        auto lg = cc::lock_guard(_lock);
+        _backing.alloc_batch(size, align, out_ptrs);
+    }
+
+    // locks only once for all frees
+    void free_batch(cc::span<void* const> ptrs) override
+    {
+        auto lg = cc::lock_guard(_lock);
+        _backing.free_batch(ptrs);
+    }
+
     std::byte* realloc(void* ptr, size_t new_size, size_t align = alignof(std::max_align_t)) override
     {
         auto lg = cc::lock_guard(_lock);
         return _backing.realloc(ptr, new_size, align);
     }
 
+    std::byte* try_realloc(void* ptr, size_t new_size, size_t align = alignof(std::max_align_t)) override
+    {
+        auto lg = cc::lock_guard(_lock);
+        return _backing.try_realloc(ptr, new_size, align);
+    }
+
+    bool try_resize_in_place(void* ptr, size_t new_size) override
+    {
+        auto lg = cc::lock_guard(_lock);
+        return _backing.try_resize_in_place(ptr, new_size);
+    }
+
     bool get_allocation_size(void const* ptr, size_t& out_size) override
     {
         auto lg = cc::lock_guard(_lock);
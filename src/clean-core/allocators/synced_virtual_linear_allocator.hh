@@ -7,6 +7,7 @@
 namespace cc
 {
 /// Synchronized (mutexed) version of virtual_linear_allocator
+/// use cc::mutex instead of the default spin_lock if there can be more threads than cores
 template <class MutexT = cc::spin_lock>
 struct synced_virtual_linear_allocator final : allocator
 {
@@ -32,6 +33,19 @@ struct synced_virtual_linear_allocator final : allocator
 
     void free(void*) override {} // nothing
 
+    void free_sized(void*, size_t, size_t) override {} // nothing
+
+    void free_batch(cc::span<void* const>) override {} // nothing
+
+    bool is_free_noop() const override { return true; }
+
+    // locks only once for all allocations
+    void alloc_batch(size_t size, size_t align, cc::span<std::byte*> out_ptrs) override
+    {
+        auto lg = cc::lock_guard(_mutex);
+        _backing.alloc_batch(size, align, out_ptrs);
+    }
+
     std::byte* realloc(void* ptr, size_t new_size, size_t align = alignof(std::max_align_t)) override
     {
         auto lg = cc::lock_guard(_mutex);
@@ -54,6 +68,20 @@ struct synced_virtual_linear_allocator final : allocator
         return _backing.decommit_idle_memory();
     }
 
+    // trims committed memory following the trim policy of the backing allocator
+    // returns amount of bytes trimmed
+    size_t trim()
+    {
+        auto lg = cc::lock_guard(_mutex);
+        return _backing.trim();
+    }
+
+    void set_trim_policy(virtual_trim_policy const& policy)
+    {
+        auto lg = cc::lock_guard(_mutex);
+        _backing.set_trim_policy(policy);
+    }
+
     cc::virtual_linear_allocator const& get_backing() const { return _backing; }
 
 private:
@@ -3,6 +3,7 @@
 #include <cstdint> // uint8_t
 
 #include <clean-core/allocator.hh>
+#include <clean-core/assert.hh>
 
 #include <clean-core/macros.hh>
 
@@ -22,6 +23,8 @@
 #if CC_USE_ALIGNED_ALLOC
 #include <cstdlib>
 #include <malloc.h>
+
+#include <sys/mman.h>
 #endif
 
 #if defined(CC_OS_WINDOWS)
@@ -35,7 +38,8 @@ std::byte* cc::system_malloc(size_t size, size_t alignment)
 #if CC_USE_ALIGNED_MALLOC
     void* result = ::_aligned_malloc(size, alignment);
 #elif CC_USE_ALIGNED_ALLOC
-    void* result = std::aligned_alloc(alignment, size);
+    // plain malloc where it suffices, its blocks can be grown via realloc (see system_realloc)
+    void* result = alignment <= alignof(std::max_align_t) ? std::malloc(size) : std::aligned_alloc(alignment, cc::align_up(size, alignment));
 #else // fallback implementation
     void* ptr = std::malloc(size + alignment + sizeof(void*) + sizeof(size_t));
     void* result = nullptr;
@@ -74,7 +78,22 @@ std::byte* cc::system_realloc(void* ptr, size_t new_size, size_t align)
     return static_cast<std::byte*>(result);
 
 #else // !CC_USE_ALIGNED_MALLOC
-      // default realloc implementation
+
+#if CC_USE_ALIGNED_ALLOC
+    if (align <= alignof(std::max_align_t))
+    {
+        // large blocks of the C runtime are mmap-backed and realloc moves their pages via mremap instead of copying
+        if (new_size == 0)
+        {
+            std::free(ptr);
+            return nullptr;
+        }
+
+        return static_cast<std::byte*>(std::realloc(ptr, new_size));
+    }
+#endif
+
+    // default realloc implementation
     std::byte* res = nullptr;
     if (new_size > 0)
     {
@@ -122,6 +141,60 @@ void cc::system_free(void* ptr)
 #endif
 }
 
+std::byte* cc::system_alloc_pages(size_t size)
+{
+    if (size == 0)
+        return nullptr;
+
+#if CC_USE_ALIGNED_ALLOC
+    void* const result = ::mmap(nullptr, cc::align_up(size, system_page_size), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return result == MAP_FAILED ? nullptr : static_cast<std::byte*>(result);
+#else
+    return cc::system_malloc(size, system_page_size);
+#endif
+}
+
+std::byte* cc::system_realloc_pages(void* ptr, size_t old_size, size_t new_size)
+{
+    if (ptr == nullptr)
+        return cc::system_alloc_pages(new_size);
+
+    if (new_size == 0)
+    {
+        cc::system_free_pages(ptr, old_size);
+        return nullptr;
+    }
+
+#if CC_USE_ALIGNED_ALLOC
+    size_t const old_mapped_size = cc::align_up(old_size, system_page_size);
+    size_t const new_mapped_size = cc::align_up(new_size, system_page_size);
+    if (old_mapped_size == new_mapped_size)
+        return static_cast<std::byte*>(ptr);
+
+    // only remaps the page table entries, no bytes are copied
+    // the old block stays valid on failure
+    void* const result = ::mremap(ptr, old_mapped_size, new_mapped_size, MREMAP_MAYMOVE);
+    return result == MAP_FAILED ? nullptr : static_cast<std::byte*>(result);
+#else
+    (void)old_size;
+    return cc::system_realloc(ptr, new_size, system_page_size);
+#endif
+}
+
+void cc::system_free_pages(void* ptr, size_t size)
+{
+    if (ptr == nullptr)
+        return;
+
+#if CC_USE_ALIGNED_ALLOC
+    auto const res = ::munmap(ptr, cc::align_up(size, system_page_size));
+    CC_ASSERT(res == 0 && "munmap failed");
+#else
+    (void)size;
+    cc::system_free(ptr);
+#endif
+}
+
 /*
  * we must make sure that cc::system_allocator is valid during complete init and shutdown
  * this is not given if a "static cc::system_allocator" instance is used
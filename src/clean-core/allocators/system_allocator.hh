@@ -16,6 +16,21 @@ size_t system_msize(void const* ptr);
 
 void system_free(void* ptr);
 
+//
+// page-granular blocks directly from the OS, meant for very large buffers
+// the caller keeps track of the size, these blocks must not be passed to the functions above
+// on Linux they are anonymous mappings and growing them uses mremap (moves pages, copies no bytes)
+// on other platforms they fall back to page-aligned system_malloc / system_realloc
+
+inline constexpr size_t system_page_size = 4096;
+
+std::byte* system_alloc_pages(size_t size);
+
+// returns nullptr on failure, ptr stays valid in that case
+std::byte* system_realloc_pages(void* ptr, size_t old_size, size_t new_size);
+
+void system_free_pages(void* ptr, size_t size);
+
 // system provided allocator (malloc / free)
 struct system_allocator_t final : cc::allocator
 {
@@ -1,6 +1,9 @@
 #include "tlsf_allocator.hh"
 
+#include <cstring>
+
 #include <clean-core/assert.hh>
+#include <clean-core/utility.hh>
 
 #include <clean-core/detail/lib/tlsf.hh>
 
@@ -39,12 +42,68 @@ std::byte* cc::tlsf_allocator::alloc(size_t size, size_t align)
 
 void cc::tlsf_allocator::free(void* ptr) { tlsf_free(_tlsf, ptr); }
 
+void cc::tlsf_allocator::free_sized(void* ptr, size_t size, size_t align)
+{
+    (void)align;
+    CC_ASSERT((ptr == nullptr || tlsf_block_size(ptr) >= size) && "freed size is larger than the allocation");
+    (void)size;
+    tlsf_free(_tlsf, ptr);
+}
+
+void cc::tlsf_allocator::alloc_batch(size_t size, size_t align, cc::span<std::byte*> out_ptrs)
+{
+    CC_ASSERT(size > 0 && "Attempted empty TLSF allocation");
+    for (auto& ptr : out_ptrs)
+    {
+        ptr = static_cast<std::byte*>(tlsf_memalign(_tlsf, align, size));
+        CC_ASSERT(ptr != nullptr && "TLSF full");
+    }
+}
+
+void cc::tlsf_allocator::free_batch(cc::span<void* const> ptrs)
+{
+    for (void* const ptr : ptrs)
+        tlsf_free(_tlsf, ptr);
+}
+
 std::byte* cc::tlsf_allocator::realloc(void* ptr, size_t new_size, size_t align)
 {
     (void)align;
     return static_cast<std::byte*>(tlsf_realloc(_tlsf, ptr, new_size));
 }
 
+std::byte* cc::tlsf_allocator::try_realloc(void* ptr, size_t new_size, size_t align)
+{
+    if (new_size == 0)
+    {
+        tlsf_free(_tlsf, ptr);
+        return nullptr;
+    }
+
+    if (ptr != nullptr && tlsf_resize_in_place(_tlsf, ptr, new_size))
+        return static_cast<std::byte*>(ptr);
+
+    auto const res = static_cast<std::byte*>(tlsf_memalign(_tlsf, align, new_size));
+    if (res == nullptr)
+        return nullptr; // the original buffer stays valid
+
+    if (ptr != nullptr)
+    {
+        std::memcpy(res, ptr, cc::min(tlsf_block_size(ptr), new_size));
+        tlsf_free(_tlsf, ptr);
+    }
+
+    return res;
+}
+
+bool cc::tlsf_allocator::try_resize_in_place(void* ptr, size_t new_size)
+{
+    if (ptr == nullptr)
+        return false;
+
+    return tlsf_resize_in_place(_tlsf, ptr, new_size) != 0;
+}
+
 bool cc::tlsf_allocator::get_allocation_size(void const* ptr, size_t& out_size)
 {
     if (!ptr)
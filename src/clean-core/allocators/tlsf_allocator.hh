@@ -23,8 +23,21 @@ struct tlsf_allocator final : allocator
 
     void free(void* ptr) override;
 
+    // TLSF reads the block header in any case, this only validates the size
+    void free_sized(void* ptr, size_t size, size_t align = alignof(std::max_align_t)) override;
+
+    void alloc_batch(size_t size, size_t align, cc::span<std::byte*> out_ptrs) override;
+
+    void free_batch(cc::span<void* const> ptrs) override;
+
     std::byte* realloc(void* ptr, size_t new_size, size_t align = alignof(std::max_align_t)) override;
 
+    // grows in place if the next block is free, otherwise moves, returns nullptr if the TLSF is full
+    std::byte* try_realloc(void* ptr, size_t new_size, size_t align = alignof(std::max_align_t)) override;
+
+    // succeeds when shrinking or if the next block is free and large enough
+    bool try_resize_in_place(void* ptr, size_t new_size) override;
+
     bool get_allocation_size(void const* ptr, size_t& out_size) override;
 
     bool validate_heap() override;
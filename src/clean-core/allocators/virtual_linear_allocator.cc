@@ -12,6 +12,8 @@ void cc::virtual_linear_allocator::initialize(size_t max_size_bytes, size_t chun
     _virtual_end = _virtual_begin + max_size_bytes;
     _physical_current = _virtual_begin;
     _physical_end = _virtual_begin;
+    _usage_peak = _virtual_begin;
+    _trim_state = {};
     _chunk_size_bytes = chunk_size_bytes;
 
     CC_ASSERT(max_size_bytes > 0 && chunk_size_bytes > 0 && "invalid sizes");
@@ -48,6 +50,33 @@ std::byte* cc::virtual_linear_allocator::alloc(size_t size, size_t align)
     return padded_res;
 }
 
+void cc::virtual_linear_allocator::alloc_batch(size_t size, size_t align, cc::span<std::byte*> out_ptrs)
+{
+    CC_ASSERT(_virtual_begin != nullptr && "virtual_linear_allocator uninitialized");
+
+    if (out_ptrs.empty())
+        return;
+
+    align = cc::max<size_t>(align, 1);
+
+    // worst case per element is the same as in alloc()
+    size_t const required_size = (size + (align - 1) + sizeof(size_t)) * out_ptrs.size();
+    _physical_end = grow_physical_memory(_physical_current, _physical_end, _virtual_end, _chunk_size_bytes, required_size);
+
+    for (auto& ptr : out_ptrs)
+    {
+        std::byte* const padded_res = cc::align_up(_physical_current + sizeof(size_t), align);
+
+        // store alloc size
+        *((size_t*)(padded_res - sizeof(size_t))) = size;
+
+        ptr = padded_res;
+        _physical_current = padded_res + size;
+    }
+
+    _last_allocation = out_ptrs.back();
+}
+
 bool cc::virtual_linear_allocator::get_allocation_size(void const* ptr, size_t& out_size)
 {
     if (!ptr)
@@ -82,10 +111,25 @@ std::byte* cc::virtual_linear_allocator::realloc(void* ptr, size_t new_size, siz
     // store new alloc size
     *((size_t*)(byte_ptr - sizeof(size_t))) = new_size;
 
+    _usage_peak = cc::max(_usage_peak, _physical_current);
     _physical_current = byte_ptr + new_size;
     return byte_ptr;
 }
 
+bool cc::virtual_linear_allocator::try_resize_in_place(void* ptr, size_t new_size)
+{
+    if (!ptr || ptr != _last_allocation)
+        return false;
+
+    std::byte* const byte_ptr = static_cast<std::byte*>(ptr);
+    if (byte_ptr + new_size > _virtual_end)
+        return false;
+
+    // same as the in-place path of realloc
+    realloc(ptr, new_size);
+    return true;
+}
+
 size_t cc::virtual_linear_allocator::decommit_idle_memory()
 {
     // align up to the start of the first empty page
@@ -101,3 +145,18 @@ size_t cc::virtual_linear_allocator::decommit_idle_memory()
 
     return size_to_free;
 }
+
+size_t cc::virtual_linear_allocator::trim()
+{
+    CC_ASSERT(_virtual_begin != nullptr && "virtual_linear_allocator uninitialized");
+
+    std::byte* const period_peak = cc::max(_usage_peak, _physical_current);
+    _usage_peak = _physical_current;
+
+    size_t const num_keep_bytes = _trim_state.advance(_trim_policy, size_t(period_peak - _virtual_begin));
+    std::byte* const new_physical_end = trim_physical_memory(_virtual_begin, _physical_current, _physical_end, _chunk_size_bytes, num_keep_bytes, _trim_policy.lazy);
+
+    size_t const num_trimmed_bytes = size_t(_physical_end - new_physical_end);
+    _physical_end = new_physical_end;
+    return num_trimmed_bytes;
+}
@@ -1,12 +1,14 @@
 #pragma once
 
 #include <clean-core/allocator.hh>
+#include <clean-core/native/memory.hh>
 
 namespace cc
 {
 /// linear allocator operating in virtual memory
 /// reserves pages on init, commits pages on demand
-/// only frees pages if explicitly called
+/// only frees pages if explicitly called, either all idle pages at once (decommit_idle_memory)
+/// or following a hysteresis policy based on the recent usage peaks (trim)
 struct virtual_linear_allocator final : allocator
 {
     virtual_linear_allocator() = default;
@@ -24,17 +26,35 @@ struct virtual_linear_allocator final : allocator
 
     void free(void* ptr) override { (void)ptr; }
 
+    void free_sized(void* ptr, size_t size, size_t align = alignof(std::max_align_t)) override
+    {
+        (void)ptr;
+        (void)size;
+        (void)align;
+    }
+
+    void free_batch(cc::span<void* const> ptrs) override { (void)ptrs; }
+
+    bool is_free_noop() const override { return true; }
+
+    // commits physical memory once for all allocations
+    void alloc_batch(size_t size, size_t align, cc::span<std::byte*> out_ptrs) override;
+
     bool get_allocation_size(void const* ptr, size_t& out_size) override;
 
     char const* get_name() const override { return "Virtual Linear Allocator"; }
 
     std::byte* realloc(void* ptr, size_t new_size, size_t align = alignof(std::max_align_t)) override;
 
+    // succeeds for the most recent allocation if the virtual range has enough space
+    bool try_resize_in_place(void* ptr, size_t new_size) override;
+
     // free all current allocations
     // does not decommit any memory!
     size_t reset()
     {
         size_t const num_bytes_allocated = _physical_current - _virtual_begin;
+        _usage_peak = cc::max(_usage_peak, _physical_current);
         _physical_current = _virtual_begin;
         _last_allocation = nullptr;
         return num_bytes_allocated;
@@ -44,6 +64,14 @@ struct virtual_linear_allocator final : allocator
     // returns amount of bytes decommitted
     size_t decommit_idle_memory();
 
+    // returns committed memory exceeding the recent usage peaks (plus headroom) to the OS, see virtual_trim_policy
+    // meant to be called periodically, e.g. once per frame after reset()
+    // returns amount of bytes trimmed
+    size_t trim();
+
+    void set_trim_policy(virtual_trim_policy const& policy) { _trim_policy = policy; }
+    virtual_trim_policy const& get_trim_policy() const { return _trim_policy; }
+
     // amount of bytes in the virtual address range
     size_t get_virtual_size_bytes() const { return _virtual_end - _virtual_begin; }
 
@@ -53,6 +81,9 @@ struct virtual_linear_allocator final : allocator
     // amount of bytes in the physically committed and allocated memory
     size_t get_allocated_size_bytes() const { return _physical_current - _virtual_begin; }
 
+    // the allocated amount of bytes that trim() keeps committed (without headroom)
+    size_t get_trim_peak_size_bytes() const { return _trim_state.get_peak(); }
+
 private:
     std::byte* _virtual_begin = nullptr;
     std::byte* _virtual_end = nullptr;
@@ -60,5 +91,10 @@ private:
     std::byte* _physical_end = nullptr;
     std::byte* _last_allocation = nullptr;
     size_t _chunk_size_bytes = 0;
+
+    // highest _physical_current since the last trim(), updated whenever the head moves down
+    std::byte* _usage_peak = nullptr;
+    virtual_trim_policy _trim_policy;
+    virtual_trim_state _trim_state;
 };
 }
\ No newline at end of file
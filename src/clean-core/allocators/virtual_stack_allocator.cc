@@ -13,6 +13,8 @@ void cc::virtual_stack_allocator::initialize(size_t max_size_bytes, size_t chunk
     _virtual_end = _virtual_begin + max_size_bytes;
     _physical_current = _virtual_begin;
     _physical_end = _virtual_begin;
+    _usage_peak = _virtual_begin;
+    _trim_state = {};
     _last_alloc_id = 0;
     _chunk_size_bytes = chunk_size_bytes;
 
@@ -61,6 +63,7 @@ void cc::virtual_stack_allocator::free(void* ptr)
 
     CC_ASSERT(alloc_header->alloc_id == _last_alloc_id && "freed ptr was not the most recent allocation");
     --_last_alloc_id;
+    _usage_peak = cc::max(_usage_peak, _physical_current);
     _physical_current = byte_ptr - alloc_header->padding;
 }
 
@@ -93,6 +96,7 @@ std::byte* cc::virtual_stack_allocator::realloc(void* ptr, size_t new_size, size
         _physical_end = grow_physical_memory(_physical_current, _physical_end, _virtual_end, _chunk_size_bytes, num_new_bytes);
     }
 
+    _usage_peak = cc::max(_usage_peak, _physical_current);
     _physical_current = byte_ptr + new_size;
     return byte_ptr;
 }
@@ -100,11 +104,24 @@ std::byte* cc::virtual_stack_allocator::realloc(void* ptr, size_t new_size, size
 size_t cc::virtual_stack_allocator::reset()
 {
     size_t const num_bytes_allocated = _physical_current - _virtual_begin;
+    _usage_peak = cc::max(_usage_peak, _physical_current);
     _physical_current = _virtual_begin;
     _last_alloc_id = 0;
     return num_bytes_allocated;
 }
 
+size_t cc::virtual_stack_allocator::free_to_marker(marker_t marker)
+{
+    CC_ASSERT(marker.head >= _virtual_begin && marker.head <= _physical_current && "marker is invalid or was already freed");
+    CC_ASSERT(marker.alloc_id <= _last_alloc_id && "marker is invalid or was already freed");
+
+    size_t const num_bytes_freed = _physical_current - marker.head;
+    _usage_peak = cc::max(_usage_peak, _physical_current);
+    _physical_current = marker.head;
+    _last_alloc_id = marker.alloc_id;
+    return num_bytes_freed;
+}
+
 size_t cc::virtual_stack_allocator::decommit_idle_memory()
 {
     // align up to the start of the first empty page
@@ -131,3 +148,18 @@ bool cc::virtual_stack_allocator::is_latest_allocation(void* ptr) const
     stack_alloc_header const* const alloc_header = (stack_alloc_header*)(byte_ptr - sizeof(stack_alloc_header));
     return alloc_header->alloc_id == _last_alloc_id;
 }
+
+size_t cc::virtual_stack_allocator::trim()
+{
+    CC_ASSERT(_virtual_begin != nullptr && "virtual_stack_allocator uninitialized");
+
+    std::byte* const period_peak = cc::max(_usage_peak, _physical_current);
+    _usage_peak = _physical_current;
+
+    size_t const num_keep_bytes = _trim_state.advance(_trim_policy, size_t(period_peak - _virtual_begin));
+    std::byte* const new_physical_end = trim_physical_memory(_virtual_begin, _physical_current, _physical_end, _chunk_size_bytes, num_keep_bytes, _trim_policy.lazy);
+
+    size_t const num_trimmed_bytes = size_t(_physical_end - new_physical_end);
+    _physical_end = new_physical_end;
+    return num_trimmed_bytes;
+}
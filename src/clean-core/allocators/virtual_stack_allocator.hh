@@ -3,16 +3,25 @@
 #include <cstdint> // int32_t
 
 #include <clean-core/allocator.hh>
+#include <clean-core/native/memory.hh>
 
 namespace cc
 {
 /// stack allocator operating in virtual memory
 /// reserves pages on init, commits pages on demand
-/// only frees pages if explicitly called
+/// only frees pages if explicitly called, either all idle pages at once (decommit_idle_memory)
+/// or following a hysteresis policy based on the recent usage peaks (trim)
 ///
 /// RESTRICTION: Must only free or realloc the most recent allocation
 struct virtual_stack_allocator final : allocator
 {
+    // a position of the stack, see get_marker() and free_to_marker()
+    struct marker_t
+    {
+        std::byte* head = nullptr;
+        int32_t alloc_id = 0;
+    };
+
     virtual_stack_allocator() = default;
     explicit virtual_stack_allocator(size_t max_size_bytes, size_t chunk_size_bytes = 65536) { initialize(max_size_bytes, chunk_size_bytes); }
     ~virtual_stack_allocator() override { destroy(); }
@@ -38,10 +47,26 @@ struct virtual_stack_allocator final : allocator
     // does not decommit any memory!
     size_t reset();
 
+    // returns the current position of the stack
+    marker_t get_marker() const { return {_physical_current, _last_alloc_id}; }
+
+    // free all allocations made since the marker was taken, regardless of their order
+    // does not decommit any memory!
+    // returns amount of bytes freed
+    size_t free_to_marker(marker_t marker);
+
     // decommit the physical memory of all pages not currently required
     // returns amount of bytes decommitted
     size_t decommit_idle_memory();
 
+    // returns committed memory exceeding the recent usage peaks (plus headroom) to the OS, see virtual_trim_policy
+    // meant to be called periodically, e.g. once per frame after reset()
+    // returns amount of bytes trimmed
+    size_t trim();
+
+    void set_trim_policy(virtual_trim_policy const& policy) { _trim_policy = policy; }
+    virtual_trim_policy const& get_trim_policy() const { return _trim_policy; }
+
     // amount of bytes in the virtual address range
     size_t get_virtual_size_bytes() const { return _virtual_end - _virtual_begin; }
 
@@ -51,6 +76,9 @@ struct virtual_stack_allocator final : allocator
     // amount of bytes in the physically committed and allocated memory
     size_t get_allocated_size_bytes() const { return _physical_current - _virtual_begin; }
 
+    // the allocated amount of bytes that trim() keeps committed (without headroom)
+    size_t get_trim_peak_size_bytes() const { return _trim_state.get_peak(); }
+
     // returns whether the given ptr is the latest allocation, meaning it can be freed or reallocated
     bool is_latest_allocation(void* ptr) const;
 
@@ -60,6 +88,11 @@ private:
     std::byte* _physical_current = nullptr;
     std::byte* _physical_end = nullptr;
     size_t _chunk_size_bytes = 0;
+
+    // highest _physical_current since the last trim(), updated whenever the head moves down
+    std::byte* _usage_peak = nullptr;
+    virtual_trim_policy _trim_policy;
+    virtual_trim_state _trim_state;
     int32_t _last_alloc_id = 0;
 };
 }
@@ -114,6 +114,14 @@ struct array<T, dynamic_size>
 
     [[nodiscard]] static array defaulted(size_t size) { return array(size); }
 
+    /// returns an array with "size" elements, trivial types are left uninitialized
+    [[nodiscard]] static array for_overwrite(size_t size)
+    {
+        auto a = array::uninitialized(size);
+        detail::container_default_initialize(size, a._data);
+        return a;
+    }
+
     [[nodiscard]] static array uninitialized(size_t size)
     {
         array a;
@@ -8,8 +8,11 @@
 #include <clean-core/alloc_vector.hh>
 #include <clean-core/allocator.hh>
 #include <clean-core/bit_cast.hh>
+#include <clean-core/bits.hh>
 #include <clean-core/intrinsics.hh>
+#include <clean-core/native/memory.hh>
 #include <clean-core/new.hh>
+#include <clean-core/span.hh>
 
 namespace cc
 {
@@ -23,12 +26,18 @@ void radix_sort(uint32_t* __restrict a, uint32_t* __restrict temp, size_t n);
 /// Pointers remain stable
 /// acquire() and release() fully thread-safe
 /// (access to underlying memory unsynchronized)
+///
+/// initialize() allocates all nodes upfront from an allocator
+/// initialize_growable() reserves the nodes in virtual memory and commits pages as the high-water mark grows
+///
+/// optionally maintains an occupancy bitmap (one bit per node, updated atomically on acquire and release)
+/// which makes iterating allocated nodes a bit scan in O(max_size / 64), including parallel iteration
 template <class T, bool GenCheckEnabled>
 struct atomic_linked_pool
 {
     using handle_t = uint32_t;
 
-    void initialize(size_t size, cc::allocator* allocator = cc::system_allocator)
+    void initialize(size_t size, cc::allocator* allocator = cc::system_allocator, bool track_occupancy = false)
     {
         if (size == 0)
             return;
@@ -47,6 +56,7 @@ struct atomic_linked_pool
         CC_ASSERT(_pool == nullptr && "re-initialized atomic_linked_pool");
 
         _alloc = allocator;
+        _is_growable = false;
 
         _pool_size = size;
 
@@ -75,21 +85,65 @@ struct atomic_linked_pool
             std::memset(_generation, 0, sizeof(internal_handle_t) * _pool_size);
         }
 
+        // initialize occupancy bitmap
+        if (track_occupancy)
+        {
+            _occupancy = reinterpret_cast<std::atomic<uint64_t>*>(_alloc->alloc(sizeof(uint64_t) * _get_num_occupancy_words(), 64));
+            std::memset(static_cast<void*>(_occupancy), 0, sizeof(uint64_t) * _get_num_occupancy_words());
+        }
+
         // initialize first free node index
         VersionedIndex head;
         head.set_index(0);
         _first_free_node.store(head);
 
-        // initiale destructor function pointer
-        if constexpr (!std::is_trivially_destructible_v<T>)
-        {
-            // set up the function pointer now, as T is complete in this function (unlike in the dtor and this->_destroy())
-            _fptr_call_all_dtors = +[](atomic_linked_pool& pool) { pool.iterate_allocated_nodes([](T& node) { node.~T(); }); };
-        }
-        else
-        {
-            _fptr_call_all_dtors = nullptr;
-        }
+        // all nodes are in the free list
+        _high_water.store(uint32_t(_pool_size));
+        _num_committed.store(uint32_t(_pool_size));
+
+        _init_dtor_function();
+    }
+
+    /// initialize a pool that grows on demand up to max_size nodes (0: the limit of the index type)
+    /// the memory of all nodes is reserved in virtual memory, physical memory is committed in chunks of commit_chunk_bytes
+    /// once the nodes of the free list are exhausted
+    /// pointers and handles stay stable, acquire() and release() stay lock-free
+    void initialize_growable(size_t max_size = 0, size_t commit_chunk_bytes = 65536, bool track_occupancy = false)
+    {
+        size_t const max_size_for_index = sc_enable_gen_check ? sc_max_size_with_gen_check : sc_max_size_without_gen_check;
+        if (max_size == 0)
+            max_size = max_size_for_index;
+
+        CC_ASSERT(max_size <= max_size_for_index && "atomic_linked_pool size too large for index type");
+        CC_CONTRACT(max_size > 1 && "pool too small");
+        CC_CONTRACT(commit_chunk_bytes > 0);
+        CC_ASSERT(_pool == nullptr && "re-initialized atomic_linked_pool");
+        CC_ASSERT(alignof(T) <= 4096 && "overaligned types are not supported in growable pools");
+
+        _alloc = nullptr;
+        _is_growable = true;
+
+        _pool_size = max_size;
+
+        // reserve all memory, nothing is committed yet
+        _pool = reinterpret_cast<T*>(cc::reserve_virtual_memory(_get_reserved_size(sizeof(T))));
+        _free_list = reinterpret_cast<int32_t*>(cc::reserve_virtual_memory(_get_reserved_size(sizeof(int32_t))));
+        if constexpr (sc_enable_gen_check)
+            _generation = reinterpret_cast<internal_handle_t*>(cc::reserve_virtual_memory(_get_reserved_size(sizeof(internal_handle_t))));
+        if (track_occupancy)
+            _occupancy = reinterpret_cast<std::atomic<uint64_t>*>(cc::reserve_virtual_memory(_get_occupancy_reserved_size()));
+
+        _num_nodes_per_commit = uint32_t(cc::max<size_t>(1, commit_chunk_bytes / sizeof(T)));
+
+        // the free list is empty, new nodes are taken from the high-water mark
+        VersionedIndex head;
+        head.set_index(-1);
+        _first_free_node.store(head);
+
+        _high_water.store(0);
+        _num_committed.store(0);
+
+        _init_dtor_function();
     }
 
     void destroy() { _destroy(); }
@@ -107,7 +161,15 @@ struct atomic_linked_pool
         {
             // we loaded the first free node to receive a _candidate_ for the node we will actually aquire
             acquired_node_index = acquired_node_gen_index.get_index();
-            CC_ASSERT(acquired_node_index != -1 && "atomic_linked_pool is full");
+
+            if (acquired_node_index == -1)
+            {
+                // the free list is empty, take a node that was never used
+                uint32_t num_unused = 0;
+                acquired_node_index = int32_t(_acquire_unused_nodes(1, num_unused));
+                CC_ASSERT(num_unused == 1 && "atomic_linked_pool is full");
+                break;
+            }
 
             // load the next-index of the candidate node
             int32_t* const p_free_list = &_free_list[acquired_node_index];
@@ -134,6 +196,8 @@ struct atomic_linked_pool
         if constexpr (!std::is_trivially_constructible_v<T>)
             new (cc::placement_new, acquired_node) T();
 
+        _mark_occupied(acquired_node_index);
+
         // construct a handle
         return _construct_handle(acquired_node_index);
     }
@@ -145,6 +209,161 @@ struct atomic_linked_pool
         _release_node(real_index);
     }
 
+    /// acquire out_handles.size() new slots
+    /// takes a whole chain from the free list with a single CAS (and the rest from unused nodes if required)
+    void acquire_n(cc::span<handle_t> out_handles)
+    {
+        static_assert(sizeof(handle_t) == sizeof(uint32_t), "handles are used as index storage");
+        if (out_handles.empty())
+            return;
+
+        uint32_t const num_requested = uint32_t(out_handles.size());
+        uint32_t* const indices = out_handles.data();
+
+        uint32_t num_acquired = _pop_free_chain(indices, num_requested);
+        if (num_acquired < num_requested)
+        {
+            uint32_t num_unused = 0;
+            uint32_t const first_unused = _acquire_unused_nodes(num_requested - num_acquired, num_unused);
+            CC_ASSERT(num_acquired + num_unused == num_requested && "atomic_linked_pool is full");
+
+            for (uint32_t i = 0; i < num_unused; ++i)
+                indices[num_acquired++] = first_unused + i;
+        }
+
+        for (auto& h : out_handles)
+        {
+            uint32_t const index = h;
+
+            // call the constructor
+            if constexpr (!std::is_trivially_constructible_v<T>)
+                new (cc::placement_new, &_pool[index]) T();
+
+            _mark_occupied(index);
+            h = _construct_handle(index);
+        }
+    }
+
+    /// release multiple slots in the pool, destroying them
+    /// returns the whole chain to the free list with a single CAS
+    void release_n(cc::span<handle_t const> handles)
+    {
+        if (handles.empty())
+            return;
+
+        uint32_t first_index = 0;
+        uint32_t prev_index = 0;
+        for (size_t i = 0; i < handles.size(); ++i)
+        {
+            uint32_t const real_index = _read_handle_index_on_release(handles[i]);
+            _mark_free(real_index);
+
+            // call the destructor
+            if constexpr (!std::is_trivially_destructible_v<T>)
+                _pool[real_index].~T();
+
+            // link the chain, the nodes are still owned by us
+            if (i == 0)
+                first_index = real_index;
+            else
+                cc::intrin_atomic_swap(&_free_list[prev_index], int32_t(real_index));
+
+            prev_index = real_index;
+        }
+
+        _push_free_chain(first_index, prev_index);
+    }
+
+    /// a per-thread cache of free slots in front of a pool
+    /// acquire() and release() are served from a local array without touching the shared free list,
+    /// which is refilled and drained in batches with a single CAS each
+    ///
+    /// Usage:
+    ///
+    ///   // in each worker thread
+    ///   decltype(pool)::thread_cache cache(pool);
+    ///   auto h = cache.acquire();
+    ///   cache.release(h);
+    ///
+    /// NOTE: not thread safe, use one cache per thread
+    ///       cached slots count as allocated for iterate_allocated_nodes, release_all and destroy,
+    ///       flush or destroy all caches before calling those
+    struct thread_cache
+    {
+        explicit thread_cache(atomic_linked_pool& pool) : _pool(&pool) {}
+        ~thread_cache() { flush(); }
+
+        /// acquire a new slot in the pool
+        [[nodiscard]] handle_t acquire()
+        {
+            if (_num_cached == 0)
+            {
+                _num_cached = _pool->_pop_free_chain(_cached_indices, sc_batch_size);
+
+                if (_num_cached == 0)
+                {
+                    uint32_t const first_unused = _pool->_acquire_unused_nodes(sc_batch_size, _num_cached);
+                    CC_ASSERT(_num_cached > 0 && "atomic_linked_pool is full");
+
+                    // take the lowest index first
+                    for (uint32_t i = 0; i < _num_cached; ++i)
+                        _cached_indices[i] = first_unused + _num_cached - 1 - i;
+                }
+            }
+
+            uint32_t const index = _cached_indices[--_num_cached];
+
+            // call the constructor
+            if constexpr (!std::is_trivially_constructible_v<T>)
+                new (cc::placement_new, &_pool->_pool[index]) T();
+
+            _pool->_mark_occupied(index);
+            return _pool->_construct_handle(index);
+        }
+
+        /// release a slot, destroying it
+        void release(handle_t handle)
+        {
+            uint32_t const real_index = _pool->_read_handle_index_on_release(handle);
+            _pool->_mark_free(real_index);
+
+            // call the destructor
+            if constexpr (!std::is_trivially_destructible_v<T>)
+                _pool->_pool[real_index].~T();
+
+            if (_num_cached == sc_capacity)
+            {
+                // return the oldest half to the pool
+                _pool->_push_free_indices(_cached_indices, sc_batch_size);
+                std::memmove(_cached_indices, _cached_indices + sc_batch_size, sizeof(uint32_t) * (sc_capacity - sc_batch_size));
+                _num_cached -= sc_batch_size;
+            }
+
+            _cached_indices[_num_cached++] = real_index;
+        }
+
+        /// returns all cached slots to the pool
+        void flush()
+        {
+            _pool->_push_free_indices(_cached_indices, _num_cached);
+            _num_cached = 0;
+        }
+
+        thread_cache(thread_cache const&) = delete;
+        thread_cache& operator=(thread_cache const&) = delete;
+
+    private:
+        enum : uint32_t
+        {
+            sc_capacity = 64,
+            sc_batch_size = sc_capacity / 2
+        };
+
+        atomic_linked_pool* _pool = nullptr;
+        uint32_t _num_cached = 0;
+        uint32_t _cached_indices[sc_capacity];
+    };
+
     /// access a slot
     CC_FORCE_INLINE T& get(handle_t handle) { return _pool[_read_handle_index(handle)]; }
 
@@ -181,13 +400,22 @@ struct atomic_linked_pool
     /// obtain the index of a node
     uint32_t get_handle_index(handle_t handle) const { return _read_handle_index(handle); }
 
-    bool is_full() const { return _first_free_node.load().get_index() == -1; }
+    bool is_full() const { return _first_free_node.load().get_index() == -1 && _high_water.load(std::memory_order_relaxed) >= _pool_size; }
     size_t max_size() const { return _pool_size; }
 
+    /// amount of nodes backed by physical memory (equal to max_size() unless growable)
+    size_t committed_size() const { return _num_committed.load(std::memory_order_relaxed); }
+
+    /// true if initialized with initialize_growable()
+    bool is_growable() const { return _is_growable; }
+
+    /// true if the pool maintains an occupancy bitmap (see initialize)
+    bool is_tracking_occupancy() const { return _occupancy != nullptr; }
+
     /// pass a lambda that is called with a T& of each allocated node
     /// acquire CAN be called from within the lambda
     /// release CAN be called from within the lambda ONLY for nodes already iterated (including the current one)
-    /// this operation is slow and should not occur in normal operation
+    /// this operation is slow and should not occur in normal operation, unless the pool tracks occupancy
     template <class F>
     uint32_t iterate_allocated_nodes(F&& func, cc::allocator* scratch_alloc = cc::system_allocator)
     {
@@ -196,11 +424,20 @@ struct atomic_linked_pool
         if (_pool == nullptr)
             return 0;
 
+        if (_occupancy != nullptr)
+        {
+            // bit scan, no scratch memory required
+            return _iterate_occupancy_words(0, _get_num_used_occupancy_words(), func);
+        }
+
         auto const free_indices = _get_free_node_indices(scratch_alloc);
 
+        // nodes past the high-water mark were never acquired
+        uint32_t const num_used_nodes = cc::min<uint32_t>(_high_water.load(std::memory_order_acquire), uint32_t(_pool_size));
+
         uint32_t num_iterated_nodes = 0;
         uint32_t free_list_index = 0;
-        for (uint32_t i = 0u; i < _pool_size; ++i)
+        for (uint32_t i = 0u; i < num_used_nodes; ++i)
         {
             if (free_list_index >= free_indices.size() || i < free_indices[free_list_index])
             {
@@ -233,6 +470,41 @@ struct atomic_linked_pool
         return num_iterated_nodes;
     }
 
+    /// calls func with a T& of each allocated node in one of num_partitions disjoint ranges of the pool
+    /// different partitions can be iterated concurrently from different threads
+    /// requires an occupancy bitmap (see initialize)
+    /// acquire and release can be called concurrently, nodes acquired or released during the iteration might be missed
+    /// func can return bool to stop the iteration of this partition
+    template <class F>
+    uint32_t iterate_allocated_nodes_partition(size_t partition_index, size_t num_partitions, F&& func)
+    {
+        static_assert(sizeof(T) > 0, "requires complete type");
+        CC_CONTRACT(partition_index < num_partitions);
+        CC_ASSERT(_occupancy != nullptr && "partitioned iteration requires an occupancy bitmap");
+
+        if (_pool == nullptr)
+            return 0;
+
+        // partitions are ranges of whole bitmap words (64 nodes)
+        size_t const num_words = _get_num_used_occupancy_words();
+        size_t const word_begin = num_words * partition_index / num_partitions;
+        size_t const word_end = num_words * (partition_index + 1) / num_partitions;
+
+        return _iterate_occupancy_words(word_begin, word_end, func);
+    }
+
+    /// amount of currently allocated nodes, counted with popcount
+    /// requires an occupancy bitmap (see initialize)
+    size_t count_allocated_nodes() const
+    {
+        CC_ASSERT(_occupancy != nullptr && "counting requires an occupancy bitmap");
+
+        size_t num_allocated = 0;
+        for (size_t w = 0; w < _get_num_used_occupancy_words(); ++w)
+            num_allocated += size_t(cc::popcount(_occupancy[w].load(std::memory_order_relaxed)));
+        return num_allocated;
+    }
+
     /// This operation is slow and should not occur in normal operation
     uint32_t release_all(cc::allocator* scratch_alloc = cc::system_allocator)
     {
@@ -261,16 +533,25 @@ struct atomic_linked_pool
 
 public:
     atomic_linked_pool() = default;
-    explicit atomic_linked_pool(size_t size, cc::allocator* allocator = cc::system_allocator) { initialize(size, allocator); }
+    explicit atomic_linked_pool(size_t size, cc::allocator* allocator = cc::system_allocator, bool track_occupancy = false)
+    {
+        initialize(size, allocator, track_occupancy);
+    }
     ~atomic_linked_pool() { _destroy(); }
 
     atomic_linked_pool(atomic_linked_pool&& rhs) noexcept
       : _pool(rhs._pool),
+        _first_free_node(rhs._first_free_node.load()),
+        _high_water(rhs._high_water.load()),
+        _num_committed(rhs._num_committed.load()),
+        _free_list(rhs._free_list),
         _pool_size(rhs._pool_size),
-        _first_free_node(cc::move(rhs._first_free_node)),
         _alloc(rhs._alloc),
+        _num_nodes_per_commit(rhs._num_nodes_per_commit),
+        _is_growable(rhs._is_growable),
         _fptr_call_all_dtors(rhs._fptr_call_all_dtors),
-        _generation(rhs._generation)
+        _generation(rhs._generation),
+        _occupancy(rhs._occupancy)
     {
         rhs._pool = nullptr;
     }
@@ -281,10 +562,16 @@ public:
 
         _pool = rhs._pool;
         _pool_size = rhs._pool_size;
-        _first_free_node = cc::move(rhs._first_free_node);
+        _first_free_node = rhs._first_free_node.load();
+        _high_water = rhs._high_water.load();
+        _num_committed = rhs._num_committed.load();
+        _free_list = rhs._free_list;
         _alloc = rhs._alloc;
+        _num_nodes_per_commit = rhs._num_nodes_per_commit;
+        _is_growable = rhs._is_growable;
         _fptr_call_all_dtors = rhs._fptr_call_all_dtors;
         _generation = rhs._generation;
+        _occupancy = rhs._occupancy;
 
         rhs._pool = nullptr;
         return *this;
@@ -330,6 +617,184 @@ private:
     atomic_linked_pool& operator=(atomic_linked_pool const&) = delete;
 
 private:
+    void _init_dtor_function()
+    {
+        // initiale destructor function pointer
+        if constexpr (!std::is_trivially_destructible_v<T>)
+        {
+            // set up the function pointer now, as T is complete in this function (unlike in the dtor and this->_destroy())
+            _fptr_call_all_dtors = +[](atomic_linked_pool& pool) { pool.iterate_allocated_nodes([](T& node) { node.~T(); }); };
+        }
+        else
+        {
+            _fptr_call_all_dtors = nullptr;
+        }
+    }
+
+    /// size of a reserved range in growable mode for arrays of _pool_size elements
+    size_t _get_reserved_size(size_t elem_size) const { return cc::align_up(elem_size * _pool_size, 65536); }
+
+    size_t _get_num_occupancy_words() const { return (_pool_size + 63) / 64; }
+    size_t _get_occupancy_reserved_size() const { return cc::align_up(sizeof(uint64_t) * _get_num_occupancy_words(), 65536); }
+
+    /// amount of bitmap words covering all nodes below the high-water mark
+    size_t _get_num_used_occupancy_words() const
+    {
+        size_t const num_used_nodes = cc::min<size_t>(_high_water.load(std::memory_order_acquire), _pool_size);
+        return (num_used_nodes + 63) / 64;
+    }
+
+    CC_FORCE_INLINE void _mark_occupied(uint32_t index)
+    {
+        // release: iterating threads that see the bit also see the constructed node
+        if (_occupancy != nullptr)
+            _occupancy[index / 64].fetch_or(uint64_t(1) << (index % 64), std::memory_order_release);
+    }
+
+    CC_FORCE_INLINE void _mark_free(uint32_t index)
+    {
+        if (_occupancy != nullptr)
+            _occupancy[index / 64].fetch_and(~(uint64_t(1) << (index % 64)), std::memory_order_relaxed);
+    }
+
+    /// calls func for all nodes with set bits in [word_begin, word_end) of the occupancy bitmap
+    template <class F>
+    uint32_t _iterate_occupancy_words(size_t word_begin, size_t word_end, F& func)
+    {
+        uint32_t num_iterated_nodes = 0;
+        for (size_t w = word_begin; w < word_end; ++w)
+        {
+            // iterate a snapshot, bits can be cleared by releasing from within func
+            uint64_t bits = _occupancy[w].load(std::memory_order_acquire);
+            while (bits != 0)
+            {
+                uint32_t const index = uint32_t(w * 64 + size_t(cc::count_trailing_zeros(bits)));
+                bits &= bits - 1;
+
+                ++num_iterated_nodes;
+                T& node = _pool[index];
+
+                if constexpr (std::is_invocable_r_v<bool, F, T&>)
+                {
+                    // the lambda returns bool, stop iteration if it returns false
+                    if (!func(node))
+                        return num_iterated_nodes;
+                }
+                else
+                {
+                    // the lambda returns void
+                    func(node);
+                }
+            }
+        }
+
+        return num_iterated_nodes;
+    }
+
+    /// takes up to max_count never-used nodes from the high-water mark, committing their memory if required
+    /// returns the first index of the taken range, out_count is 0 if the pool is full
+    uint32_t _acquire_unused_nodes(uint32_t max_count, uint32_t& out_count)
+    {
+        uint32_t first_index = _high_water.load(std::memory_order_relaxed);
+        do
+        {
+            out_count = cc::min<uint32_t>(max_count, uint32_t(_pool_size) - cc::min<uint32_t>(first_index, uint32_t(_pool_size)));
+            if (out_count == 0)
+                return first_index;
+
+        } while (!_high_water.compare_exchange_weak(first_index, first_index + out_count, std::memory_order_relaxed));
+
+        uint32_t const end_index = first_index + out_count;
+
+        uint32_t num_committed = _num_committed.load(std::memory_order_acquire);
+        if (CC_UNLIKELY(end_index > num_committed))
+        {
+            // commit everything from the current watermark up to the end of the chunk containing the last index
+            // ranges can be committed by multiple threads at once (committing is idempotent),
+            // the watermark is only raised once everything below it is committed
+            size_t const num_chunks = (size_t(end_index) + _num_nodes_per_commit - 1) / _num_nodes_per_commit;
+            uint32_t const new_num_committed = uint32_t(cc::min<size_t>(num_chunks * _num_nodes_per_commit, _pool_size));
+            uint32_t const num_new_nodes = new_num_committed - num_committed;
+
+            cc::commit_physical_memory(reinterpret_cast<std::byte*>(_pool + num_committed), sizeof(T) * num_new_nodes);
+            cc::commit_physical_memory(reinterpret_cast<std::byte*>(_free_list + num_committed), sizeof(int32_t) * num_new_nodes);
+            if constexpr (sc_enable_gen_check)
+                cc::commit_physical_memory(reinterpret_cast<std::byte*>(_generation + num_committed), sizeof(internal_handle_t) * num_new_nodes);
+            if (_occupancy != nullptr)
+            {
+                size_t const word_begin = num_committed / 64;
+                size_t const word_end = (size_t(new_num_committed) + 63) / 64;
+                cc::commit_physical_memory(reinterpret_cast<std::byte*>(_occupancy + word_begin), sizeof(uint64_t) * (word_end - word_begin));
+            }
+
+            // fresh pages are zeroed, generations start at 0
+            while (num_committed < new_num_committed
+                   && !_num_committed.compare_exchange_weak(num_committed, new_num_committed, std::memory_order_release, std::memory_order_acquire))
+            {
+            }
+        }
+
+        return first_index;
+    }
+
+    /// takes up to max_count nodes from the head of the free list with a single CAS
+    /// returns the amount of nodes taken
+    uint32_t _pop_free_chain(uint32_t* out_indices, uint32_t max_count)
+    {
+        VersionedIndex head_gen_index = _first_free_node.load(std::memory_order_acquire);
+        VersionedIndex new_head_gen_index;
+        uint32_t num_taken = 0;
+        do
+        {
+            // walk the candidate chain, the values read can be stale if another thread races us
+            // but they are always valid indices (or -1) and the CAS fails in that case
+            num_taken = 0;
+            int32_t cursor = head_gen_index.get_index();
+            while (cursor != -1 && num_taken < max_count)
+            {
+                out_indices[num_taken++] = uint32_t(cursor);
+                cursor = cc::intrin_atomic_add(&_free_list[cursor], 0); // force an atomic load by adding 0
+            }
+
+            if (num_taken == 0)
+                return 0;
+
+            new_head_gen_index = head_gen_index;
+            new_head_gen_index.set_index(cursor);
+
+        } while (!_first_free_node.compare_exchange_weak(head_gen_index, new_head_gen_index, std::memory_order_acquire, std::memory_order_acquire));
+
+        return num_taken;
+    }
+
+    /// pushes a chain of nodes, already linked from first to last in the free list, with a single CAS
+    void _push_free_chain(uint32_t first_index, uint32_t last_index)
+    {
+        VersionedIndex head_gen_index = _first_free_node.load(std::memory_order_relaxed);
+        VersionedIndex new_head_gen_index;
+        do
+        {
+            // same as in _release_node, the tail of our chain is still owned by us
+            cc::intrin_atomic_swap(&_free_list[last_index], head_gen_index.get_index());
+
+            new_head_gen_index = head_gen_index;
+            new_head_gen_index.set_index(int32_t(first_index));
+
+        } while (!_first_free_node.compare_exchange_weak(head_gen_index, new_head_gen_index, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    /// links the nodes of the given indices in the free list and pushes them with a single CAS
+    void _push_free_indices(uint32_t const* indices, uint32_t count)
+    {
+        if (count == 0)
+            return;
+
+        for (uint32_t i = 0; i + 1 < count; ++i)
+            cc::intrin_atomic_swap(&_free_list[indices[i]], int32_t(indices[i + 1]));
+
+        _push_free_chain(indices[0], indices[count - 1]);
+    }
+
     /// returns indices of unallocated slots, sorted ascending
     cc::alloc_vector<uint32_t> _get_free_node_indices(cc::allocator* scratch_alloc) const
     {
@@ -406,6 +871,8 @@ private:
 
     void _release_node(uint32_t node_idx)
     {
+        _mark_free(node_idx);
+
         // call the destructor
         if constexpr (!std::is_trivially_destructible_v<T>)
             _pool[node_idx].~T();
@@ -443,15 +910,29 @@ private:
             if (_fptr_call_all_dtors)
                 _fptr_call_all_dtors(*this);
 
-            _alloc->free(_pool);
-            _alloc->free(_free_list);
-            _pool = nullptr;
-            _pool_size = 0;
-            if constexpr (sc_enable_gen_check)
+            if (_is_growable)
             {
-                _alloc->free(_generation);
-                _generation = nullptr;
+                cc::free_virtual_memory(reinterpret_cast<std::byte*>(_pool), _get_reserved_size(sizeof(T)));
+                cc::free_virtual_memory(reinterpret_cast<std::byte*>(_free_list), _get_reserved_size(sizeof(int32_t)));
+                if constexpr (sc_enable_gen_check)
+                    cc::free_virtual_memory(reinterpret_cast<std::byte*>(_generation), _get_reserved_size(sizeof(internal_handle_t)));
+                if (_occupancy != nullptr)
+                    cc::free_virtual_memory(reinterpret_cast<std::byte*>(_occupancy), _get_occupancy_reserved_size());
             }
+            else
+            {
+                _alloc->free(_pool);
+                _alloc->free(_free_list);
+                if constexpr (sc_enable_gen_check)
+                    _alloc->free(_generation);
+                if (_occupancy != nullptr)
+                    _alloc->free(_occupancy);
+            }
+
+            _pool = nullptr;
+            _pool_size = 0;
+            _generation = nullptr;
+            _occupancy = nullptr;
         }
     }
 
@@ -483,10 +964,19 @@ private:
 
     alignas(64) std::atomic<VersionedIndex> _first_free_node = {};
 
+    // amount of nodes that were ever acquired, nodes past this are not in the free list
+    alignas(64) std::atomic<uint32_t> _high_water = {0};
+
+    // amount of nodes backed by committed memory (growable mode)
+    std::atomic<uint32_t> _num_committed = {0};
+
     alignas(64) int32_t* _free_list = nullptr;
 
     size_t _pool_size = 0;
-    cc::allocator* _alloc = nullptr;
+    cc::allocator* _alloc = nullptr; // nullptr if growable
+
+    uint32_t _num_nodes_per_commit = 0;
+    bool _is_growable = false;
 
     // function pointer that calls all dtors, used in _destroy() to work with fwd-declared types
     // only non-null if T has a dtor
@@ -495,5 +985,8 @@ private:
     // this field is useless for instances without generational checks,
     // but the impact is likely not worth the trouble of conditional inheritance
     internal_handle_t* _generation = nullptr;
+
+    // one bit per node, set while allocated, nullptr if not tracked
+    std::atomic<uint64_t>* _occupancy = nullptr;
 };
 } // namespace cc
@@ -58,6 +58,19 @@ CC_FORCE_INLINE void container_default_construct_or_zeroed(SizeT num, T* __restr
     }
 }
 
+/// default-initialization, i.e. memory of trivially default constructible types is not touched at all
+/// used by the for_overwrite factories: in contrast to defaulted, trivial types are not zeroed (for data that is overwritten anyway)
+template <class T, class SizeT = std::size_t>
+CC_FORCE_INLINE void container_default_initialize(SizeT num, T* __restrict dest)
+{
+    static_assert(sizeof(T) > 0, "cannot construct incomplete types");
+    if constexpr (!std::is_trivially_default_constructible_v<T>)
+    {
+        for (SizeT i = 0; i < num; ++i)
+            new (placement_new, &dest[i]) T;
+    }
+}
+
 template <class T, class SizeT = std::size_t>
 CC_FORCE_INLINE void container_copy_construct_fill(T const& value, SizeT num, T* __restrict dest)
 {
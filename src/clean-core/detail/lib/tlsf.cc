@@ -1129,6 +1129,45 @@ void tlsf_free(tlsf_t tlsf, void* ptr)
     }
 }
 
+/*
+** Grows or shrinks an allocated block without moving it.
+** Returns 1 on success, 0 if the block would have to move (the block is
+** unchanged then).
+*/
+int tlsf_resize_in_place(tlsf_t tlsf, void* ptr, size_t size)
+{
+    control_t* control = tlsf_cast(control_t*, tlsf);
+    block_header_t* block = block_from_ptr(ptr);
+    block_header_t* next = block_next(block);
+
+    const size_t cursize = block_size(block);
+    const size_t combined = cursize + block_size(next) + block_header_overhead;
+    const size_t adjust = adjust_request_size(size, ALIGN_SIZE);
+
+    tlsf_assert(!block_is_free(block) && "block already marked as free");
+
+    /* Zero-size or too large requests cannot be satisfied. */
+    if (adjust == 0)
+    {
+        return 0;
+    }
+
+    /* Same conditions as in tlsf_realloc, without the fallback to copying. */
+    if (adjust > cursize && (!block_is_free(next) || adjust > combined))
+    {
+        return 0;
+    }
+
+    if (adjust > cursize)
+    {
+        block_merge_next(control, block);
+        block_mark_as_used(block);
+    }
+
+    block_trim_used(control, block, adjust);
+    return 1;
+}
+
 /*
 ** The TLSF block information provides us with enough information to
 ** provide a reasonably intelligent implementation of realloc, growing or
@@ -67,6 +67,10 @@ extern "C"
     void* tlsf_realloc(tlsf_t tlsf, void* ptr, size_t size);
     void tlsf_free(tlsf_t tlsf, void* ptr);
 
+    /* Resizes a block without moving it (merging with a free next block if required).
+    ** Returns nonzero on success, the block is unchanged otherwise. */
+    int tlsf_resize_in_place(tlsf_t tlsf, void* ptr, size_t size);
+
     /* Returns internal block size, not original request size */
     size_t tlsf_block_size(void* ptr);
 
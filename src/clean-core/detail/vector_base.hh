@@ -22,30 +22,88 @@
 #include <clean-core/span.hh>
 #include <clean-core/utility.hh>
 
+// cc::vector buffers of at least this many bytes are mapped directly from the OS
+#ifndef CC_VECTOR_PAGES_THRESHOLD
+#define CC_VECTOR_PAGES_THRESHOLD (size_t(1) << 22)
+#endif
+
 namespace cc::detail
 {
-template <class T>
+// AllocatorT is cc::allocator (virtual calls) or a concrete allocator type (non-virtual, inlinable calls)
+template <class T, class AllocatorT>
 struct vector_internals_with_allocator
 {
-    T* _alloc(size_t size) { return reinterpret_cast<T*>(_allocator->alloc(size * sizeof(T), alignof(T))); }
-    void _free(T* p) { _allocator->free(p); }
-    T* _realloc(T* p, size_t size)
+    T* _alloc(size_t size)
+    {
+        CC_ASSERT(_allocator && "no allocator set?");
+        return reinterpret_cast<T*>(_allocator->alloc(size * sizeof(T), alignof(T)));
+    }
+    void _free(T* p, size_t capacity)
+    {
+        if (p != nullptr)
+            _allocator->free_sized(p, capacity * sizeof(T), alignof(T));
+    }
+    T* _realloc(T* p, size_t old_capacity, size_t size)
     {
         static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>, "realloc not permitted for this type");
+        (void)old_capacity;
+        CC_ASSERT(_allocator && "no allocator set?");
         return reinterpret_cast<T*>(_allocator->realloc(p, size * sizeof(T), alignof(T)));
     }
-    cc::allocator* _allocator = nullptr;
-    constexpr explicit vector_internals_with_allocator(cc::allocator* alloc) : _allocator(alloc) {}
+    bool _try_resize_in_place(T* p, size_t size)
+    {
+        // allowed for all types, elements are not moved
+        return p != nullptr && _allocator->try_resize_in_place(p, size * sizeof(T));
+    }
+    AllocatorT* _allocator = nullptr;
+    constexpr explicit vector_internals_with_allocator(AllocatorT* alloc) : _allocator(alloc) {}
 };
 template <class T>
 struct vector_internals
 {
-    T* _alloc(size_t size) { return reinterpret_cast<T*>(cc::system_malloc(size * sizeof(T), alignof(T))); }
-    void _free(T* p) { cc::system_free(p); }
-    T* _realloc(T* p, size_t size)
+    // buffers of at least CC_VECTOR_PAGES_THRESHOLD bytes are page blocks (see cc::system_alloc_pages)
+    // the capacity decides which kind a buffer is, realloc of page blocks does not copy on Linux
+    static bool _is_page_block(size_t capacity) { return alignof(T) <= cc::system_page_size && capacity * sizeof(T) >= CC_VECTOR_PAGES_THRESHOLD; }
+
+    T* _alloc(size_t size)
+    {
+        if (_is_page_block(size))
+            return reinterpret_cast<T*>(cc::system_alloc_pages(size * sizeof(T)));
+
+        return reinterpret_cast<T*>(cc::system_malloc(size * sizeof(T), alignof(T)));
+    }
+    void _free(T* p, size_t capacity)
+    {
+        if (_is_page_block(capacity))
+            cc::system_free_pages(p, capacity * sizeof(T));
+        else
+            cc::system_free(p);
+    }
+    T* _realloc(T* p, size_t old_capacity, size_t size)
     {
         static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>, "realloc not permitted for this type");
-        return reinterpret_cast<T*>(cc::system_realloc(p, size * sizeof(T), alignof(T)));
+
+        bool const was_page_block = _is_page_block(old_capacity);
+        bool const is_page_block = _is_page_block(size);
+
+        if (was_page_block && is_page_block)
+            return reinterpret_cast<T*>(cc::system_realloc_pages(p, old_capacity * sizeof(T), size * sizeof(T)));
+
+        if (!was_page_block && !is_page_block)
+            return reinterpret_cast<T*>(cc::system_realloc(p, size * sizeof(T), alignof(T)));
+
+        // crossing the threshold, copy once
+        T* const new_data = _alloc(size);
+        if (p != nullptr && new_data != nullptr)
+            std::memcpy(new_data, p, cc::min(old_capacity, size) * sizeof(T));
+        _free(p, old_capacity);
+        return new_data;
+    }
+    bool _try_resize_in_place(T* p, size_t size)
+    {
+        (void)p;
+        (void)size;
+        return false;
     }
 };
 
@@ -58,8 +116,8 @@ struct deferred_dtor_call
     ~deferred_dtor_call() { v.~T(); }
 };
 
-template <class T, class IndexT, bool HasAllocator>
-struct vector_base : protected std::conditional_t<HasAllocator, detail::vector_internals_with_allocator<T>, detail::vector_internals<T>>
+template <class T, class IndexT, bool HasAllocator, class AllocatorT = cc::allocator>
+struct vector_base : protected std::conditional_t<HasAllocator, detail::vector_internals_with_allocator<T, AllocatorT>, detail::vector_internals<T>>
 {
     using index_t = IndexT;
 
@@ -125,13 +183,22 @@ public:
                 // we can use realloc (size limit to keep stack usage limited)
                 // temporary object required because the arg could reference memory inside this buffer
                 auto tmp_obj = T(cc::forward<Args>(args)...);
-                _data = this->_realloc(_data, new_cap);
+                _data = this->_realloc(_data, _capacity, new_cap);
                 CC_ASSERT(cc::is_aligned(_data, alignof(T)));
                 T* new_element = new (placement_new, &_data[_size]) T(cc::move(tmp_obj));
                 _capacity = new_cap;
                 _size++;
                 return *new_element;
             }
+            else if (this->_try_resize_in_place(_data, new_cap))
+            {
+                // the allocator grew the buffer without moving it
+                // args can reference memory inside this buffer, which is still valid
+                T* new_element = new (placement_new, &_data[_size]) T(cc::forward<Args>(args)...);
+                _capacity = new_cap;
+                _size++;
+                return *new_element;
+            }
             else
             {
                 // we can't use realloc, use separate alloc/free calls
@@ -139,7 +206,7 @@ public:
                 T* new_element = new (placement_new, &new_data[_size]) T(cc::forward<Args>(args)...);
                 detail::container_move_construct_range<T>(_data, _size, new_data);
                 detail::container_destroy_reverse<T>(_data, _size);
-                this->_free(_data);
+                this->_free(_data, _capacity);
                 _data = new_data;
                 _capacity = new_cap;
                 _size++;
@@ -257,7 +324,12 @@ public:
         if constexpr (std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>)
         {
             // we can use realloc
-            _data = this->_realloc(_data, new_cap);
+            _data = this->_realloc(_data, _capacity, new_cap);
+            _capacity = new_cap;
+        }
+        else if (this->_try_resize_in_place(_data, new_cap))
+        {
+            // grown without moving any elements
             _capacity = new_cap;
         }
         else
@@ -266,7 +338,7 @@ public:
             T* new_data = this->_alloc(new_cap);
             detail::container_move_construct_range<T>(_data, _size, new_data);
             detail::container_destroy_reverse<T>(_data, _size);
-            this->_free(_data);
+            this->_free(_data, _capacity);
             _data = new_data;
             _capacity = new_cap;
         }
@@ -282,6 +354,18 @@ public:
         _size = new_size;
     }
 
+    /// like resize, but new elements are default-initialized (trivial types are not written at all)
+    /// for buffers that are overwritten afterwards anyway (I/O, decoding)
+    void resize_for_overwrite(size_t new_size)
+    {
+        if (new_size > _capacity)
+            reserve(new_size);
+        if (new_size > _size)
+            detail::container_default_initialize(new_size - _size, _data + _size);
+        detail::container_destroy_reverse<T>(_data, _size, new_size);
+        _size = new_size;
+    }
+
     /// CAUTION: currently default_value must not be an interior reference
     void resize(size_t new_size, T const& default_value)
     {
@@ -309,7 +393,11 @@ public:
             if constexpr (std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>)
             {
                 // we can use realloc
-                _data = this->_realloc(_data, _size);
+                _data = this->_realloc(_data, _capacity, _size);
+                _capacity = _size;
+            }
+            else if (this->_try_resize_in_place(_data, _size))
+            {
                 _capacity = _size;
             }
             else
@@ -317,7 +405,7 @@ public:
                 // we can't
                 T* new_data = this->_alloc(_size);
                 detail::container_move_construct_range<T>(_data, _size, new_data);
-                this->_free(_data);
+                this->_free(_data, _capacity);
                 _data = new_data;
                 _capacity = _size;
             }
@@ -481,7 +569,7 @@ protected:
         static_assert(!HasAllocator, "wrong ctor");
     }
     // alloc
-    explicit constexpr vector_base(cc::allocator* alloc) noexcept : vector_internals_with_allocator<T>(alloc)
+    explicit constexpr vector_base(AllocatorT* alloc) noexcept : vector_internals_with_allocator<T, AllocatorT>(alloc)
     {
         static_assert(HasAllocator, "wrong ctor");
     }
@@ -0,0 +1,361 @@
+#include "epoch_domain.hh"
+
+#include <clean-core/sort.hh>
+
+namespace
+{
+// the record of a thread for a single domain
+struct epoch_thread_entry
+{
+    uint64_t domain_id = 0;
+    cc::epoch_domain* domain = nullptr;
+    void* record = nullptr;
+};
+
+// a thread usually only uses very few domains, an idle entry is evicted on overflow
+enum
+{
+    epoch_num_cached_records = 8
+};
+
+// all live domains, guards against releasing records of destroyed domains on thread exit
+std::mutex& epoch_registry_mutex()
+{
+    static std::mutex m;
+    return m;
+}
+cc::vector<cc::epoch_domain*>& epoch_registry()
+{
+    static cc::vector<cc::epoch_domain*> domains;
+    return domains;
+}
+
+// ids are never reused so caches of destroyed domains can't alias new ones at the same address
+std::atomic<uint64_t> s_epoch_next_id = {1};
+
+// releases the records of all live domains when the thread exits
+struct epoch_thread_cache
+{
+    epoch_thread_entry entries[epoch_num_cached_records] = {};
+    void (*release)(epoch_thread_entry const& entry) = nullptr;
+
+    ~epoch_thread_cache()
+    {
+        if (!release)
+            return;
+
+        for (auto const& e : entries)
+            if (e.domain_id != 0)
+                release(e);
+    }
+};
+
+thread_local epoch_thread_cache tl_epoch_cache;
+
+// fast path for the most recently used domain
+thread_local uint64_t tl_epoch_last_domain_id = 0;
+thread_local void* tl_epoch_last_record = nullptr;
+}
+
+cc::epoch_domain::epoch_domain()
+{
+    _id = s_epoch_next_id.fetch_add(1, std::memory_order_relaxed);
+
+    auto lg = std::lock_guard(epoch_registry_mutex());
+    epoch_registry().push_back(this);
+}
+
+cc::epoch_domain::~epoch_domain()
+{
+    {
+        auto lg = std::lock_guard(epoch_registry_mutex());
+        epoch_registry().remove_first([this](epoch_domain* d) { return d == this; });
+    }
+
+    // nobody can see the retired objects anymore
+    thread_record* record = _records.load(std::memory_order_acquire);
+    while (record)
+    {
+        CC_ASSERT(record->pinned_epoch.load() == 0 && "epoch_domain destroyed while pinned");
+
+        for (auto const& o : record->retired)
+            o.deleter(o.ptr, o.context);
+
+        thread_record* const next = record->next;
+        cc::free(record);
+        record = next;
+    }
+
+    for (auto const& o : _orphans)
+        o.deleter(o.ptr, o.context);
+}
+
+cc::epoch_domain::thread_record* cc::epoch_domain::_local_record()
+{
+    if (CC_LIKELY(tl_epoch_last_domain_id == _id))
+        return static_cast<thread_record*>(tl_epoch_last_record);
+
+    auto& cache = tl_epoch_cache;
+    cache.release = [](epoch_thread_entry const& e) {
+        auto lg = std::lock_guard(epoch_registry_mutex());
+        for (auto* d : epoch_registry())
+            if (d == e.domain && d->_id == e.domain_id)
+                d->_release_record(static_cast<thread_record*>(e.record));
+    };
+
+    epoch_thread_entry* entry = nullptr;
+    for (auto& e : cache.entries)
+        if (e.domain_id == _id)
+            entry = &e;
+
+    if (!entry)
+    {
+        // free slot, otherwise evict a record that is neither pinned nor holds hazard pointers
+        for (auto& e : cache.entries)
+            if (e.domain_id == 0)
+            {
+                entry = &e;
+                break;
+            }
+
+        if (!entry)
+        {
+            auto lg = std::lock_guard(epoch_registry_mutex());
+            for (auto& e : cache.entries)
+            {
+                bool is_live = false;
+                for (auto* d : epoch_registry())
+                    is_live |= d == e.domain && d->_id == e.domain_id;
+
+                if (!is_live)
+                {
+                    entry = &e;
+                    break;
+                }
+
+                auto const* r = static_cast<thread_record*>(e.record);
+                bool is_idle = r->pin_depth == 0;
+                for (auto used : r->is_hazard_used)
+                    is_idle &= !used;
+
+                if (is_idle)
+                {
+                    e.domain->_release_record(static_cast<thread_record*>(e.record));
+                    entry = &e;
+                    break;
+                }
+            }
+
+            CC_ASSERT(entry && "thread uses too many epoch_domains at the same time");
+        }
+
+        entry->domain_id = _id;
+        entry->domain = this;
+        entry->record = _acquire_record();
+    }
+
+    tl_epoch_last_domain_id = _id;
+    tl_epoch_last_record = entry->record;
+    return static_cast<thread_record*>(entry->record);
+}
+
+cc::epoch_domain::thread_record* cc::epoch_domain::_acquire_record()
+{
+    // reuse the record of an exited thread
+    for (thread_record* r = _records.load(std::memory_order_acquire); r; r = r->next)
+    {
+        bool expected = false;
+        if (!r->is_in_use.load(std::memory_order_relaxed) && r->is_in_use.compare_exchange_strong(expected, true, std::memory_order_acquire))
+            return r;
+    }
+
+    thread_record* const r = cc::alloc<thread_record>();
+    r->domain = this;
+    r->is_in_use.store(true, std::memory_order_relaxed);
+
+    thread_record* head = _records.load(std::memory_order_relaxed);
+    do
+    {
+        r->next = head;
+    } while (!_records.compare_exchange_weak(head, r, std::memory_order_release, std::memory_order_relaxed));
+
+    return r;
+}
+
+void cc::epoch_domain::_release_record(thread_record* record)
+{
+    CC_ASSERT(record->pin_depth == 0 && "thread exited while pinned");
+    for (auto used : record->is_hazard_used)
+        CC_ASSERT(!used && "thread exited while holding a hazard pointer");
+
+    // the remaining objects are freed by other threads
+    if (!record->retired.empty())
+    {
+        auto lg = std::lock_guard(_orphans_mutex);
+        _orphans.push_back_range(record->retired);
+    }
+
+    record->retired = {};
+    record->next_reclaim_size = CC_EPOCH_RECLAIM_THRESHOLD;
+    record->is_in_use.store(false, std::memory_order_release);
+}
+
+void cc::epoch_domain::retire(void* ptr, deleter_t deleter, void* context)
+{
+    CC_CONTRACT(deleter != nullptr);
+    thread_record* const record = _local_record();
+
+    // the object was unlinked before, so every thread pinned from now on cannot see it
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    record->retired.push_back({ptr, deleter, context, _global_epoch.load(std::memory_order_relaxed)});
+
+    if (record->retired.size() >= record->next_reclaim_size)
+    {
+        _reclaim(record);
+
+        // objects blocked by a pinned thread would otherwise trigger a scan on every retire
+        record->next_reclaim_size = record->retired.size() + CC_EPOCH_RECLAIM_THRESHOLD;
+    }
+}
+
+cc::epoch_domain::hazard_pointer cc::epoch_domain::make_hazard_pointer()
+{
+    thread_record* const record = _local_record();
+    for (auto i = 0; i < CC_EPOCH_HAZARD_POINTERS_PER_THREAD; ++i)
+        if (!record->is_hazard_used[i])
+        {
+            record->is_hazard_used[i] = true;
+            _num_hazard_pointers.fetch_add(1, std::memory_order_relaxed);
+            return hazard_pointer(record, i);
+        }
+
+    CC_UNREACHABLE("thread holds more than CC_EPOCH_HAZARD_POINTERS_PER_THREAD hazard pointers");
+}
+
+void cc::epoch_domain::hazard_pointer::_release()
+{
+    if (!_record)
+        return;
+
+    _record->hazards[_slot].store(nullptr, std::memory_order_release);
+    _record->is_hazard_used[_slot] = false;
+    _record->domain->_num_hazard_pointers.fetch_sub(1, std::memory_order_relaxed);
+    _record = nullptr;
+}
+
+size_t cc::epoch_domain::flush()
+{
+    thread_record* const record = _local_record();
+
+    // objects retired now need two epoch advances
+    for (auto i = 0; i < 3; ++i)
+        _try_advance_epoch();
+
+    _reclaim(record);
+    record->next_reclaim_size = record->retired.size() + CC_EPOCH_RECLAIM_THRESHOLD;
+    return record->retired.size();
+}
+
+bool cc::epoch_domain::_try_advance_epoch()
+{
+    // pairs with the fence in _pin: either we see the pin or the pinned thread sees the current epoch
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    uint64_t epoch = _global_epoch.load(std::memory_order_relaxed);
+    for (thread_record* r = _records.load(std::memory_order_acquire); r; r = r->next)
+    {
+        uint64_t const pinned = r->pinned_epoch.load(std::memory_order_acquire);
+        if ((pinned & 1) && (pinned >> 1) != epoch)
+            return false; // still pinned in an older epoch
+    }
+
+    return _global_epoch.compare_exchange_strong(epoch, epoch + 1, std::memory_order_acq_rel, std::memory_order_relaxed);
+}
+
+void cc::epoch_domain::_collect_hazards(cc::vector<void*>& out_hazards) const
+{
+    out_hazards.clear();
+    if (_num_hazard_pointers.load(std::memory_order_relaxed) == 0)
+        return;
+
+    for (thread_record* r = _records.load(std::memory_order_acquire); r; r = r->next)
+        for (auto const& h : r->hazards)
+            if (void* const p = h.load(std::memory_order_acquire))
+                out_hazards.push_back(p);
+
+    cc::sort(out_hazards);
+}
+
+void cc::epoch_domain::_free_safe_objects(cc::vector<retired_object>& objects, uint64_t epoch, cc::vector<void*> const& hazards)
+{
+    size_t num_kept = 0;
+    for (size_t i = 0; i < objects.size(); ++i)
+    {
+        retired_object const o = objects[i];
+
+        // retired in epoch e: threads pinned in e - 1 and e may still see it, which ends once the epoch reached e + 2
+        bool is_safe = o.epoch + 2 <= epoch;
+        if (is_safe && !hazards.empty())
+        {
+            // binary search in the sorted hazards
+            size_t lo = 0, hi = hazards.size();
+            while (lo < hi)
+            {
+                size_t const mid = (lo + hi) / 2;
+                if (hazards[mid] < o.ptr)
+                    lo = mid + 1;
+                else
+                    hi = mid;
+            }
+            is_safe = lo == hazards.size() || hazards[lo] != o.ptr;
+        }
+
+        if (is_safe)
+            o.deleter(o.ptr, o.context);
+        else
+            objects[num_kept++] = o;
+    }
+    objects.resize(num_kept);
+}
+
+void cc::epoch_domain::_reclaim(thread_record* record)
+{
+    // deleters can retire further objects
+    if (record->is_reclaiming)
+        return;
+    record->is_reclaiming = true;
+
+    _try_advance_epoch();
+    uint64_t const epoch = _global_epoch.load(std::memory_order_acquire);
+
+    // pairs with the fence in hazard_pointer::protect: either we see the hazard or the protecting thread sees the object unlinked
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    cc::vector<void*> hazards;
+    _collect_hazards(hazards);
+
+    // deleters may push into record->retired, so the current batch is taken out first
+    auto objects = cc::move(record->retired);
+    record->retired = {};
+    _free_safe_objects(objects, epoch, hazards);
+    objects.push_back_range(record->retired);
+    record->retired = cc::move(objects);
+
+    // objects of exited threads
+    if (_orphans_mutex.try_lock())
+    {
+        if (!_orphans.empty())
+        {
+            auto orphans = cc::move(_orphans);
+            _orphans = {};
+            _orphans_mutex.unlock();
+
+            _free_safe_objects(orphans, epoch, hazards);
+
+            _orphans_mutex.lock();
+            _orphans.push_back_range(orphans);
+        }
+        _orphans_mutex.unlock();
+    }
+
+    record->is_reclaiming = false;
+}
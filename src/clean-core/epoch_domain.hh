@@ -0,0 +1,277 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <atomic>
+#include <mutex>
+
+#include <clean-core/allocate.hh>
+#include <clean-core/assert.hh>
+#include <clean-core/macros.hh>
+#include <clean-core/vector.hh>
+
+// amount of retired pointers per thread after which a reclamation is attempted
+#ifndef CC_EPOCH_RECLAIM_THRESHOLD
+#define CC_EPOCH_RECLAIM_THRESHOLD 64
+#endif
+
+// amount of hazard pointers a thread can hold per domain at the same time
+#ifndef CC_EPOCH_HAZARD_POINTERS_PER_THREAD
+#define CC_EPOCH_HAZARD_POINTERS_PER_THREAD 4
+#endif
+
+namespace cc
+{
+/// epoch-based memory reclamation for lock-free data structures
+///
+/// readers pin the domain while they hold pointers into a shared structure
+/// writers unlink objects and retire them instead of freeing them directly
+/// a retired object is freed once every thread that was pinned at the time of retiring has unpinned
+/// (tracked with a global epoch that only advances once all pinned threads have observed it)
+///
+/// pinning costs a thread-local lookup, a store and a fence, readers never write shared cache lines
+/// retired objects are collected per thread and freed in batches (CC_EPOCH_RECLAIM_THRESHOLD)
+///
+/// hazard pointers protect single objects without pinning, e.g. references held for a long time:
+/// a long pin stalls all reclamation in the domain, a hazard pointer only keeps its own object alive
+///
+/// Usage:
+///
+///   cc::epoch_domain domain;
+///
+///   // reader
+///   {
+///       auto g = domain.pin();
+///       for (node* n = head.load(std::memory_order_acquire); n; n = n->next.load(std::memory_order_acquire))
+///           visit(n);
+///   }
+///
+///   // writer
+///   node* n = unlink_front(head);
+///   domain.retire(n); // cc::free(n) once no reader can see it anymore
+///
+///   // long-held reference
+///   auto hp = domain.make_hazard_pointer();
+///   config* c = hp.protect(current_config);
+///
+/// NOTE: each thread registers itself with a domain on first use, the registration is released when the thread exits
+///       the domain must outlive all guards and hazard pointers, and nobody may be pinned when it is destroyed
+///       remaining retired objects are freed on destruction
+struct epoch_domain
+{
+    using deleter_t = void (*)(void* ptr, void* context);
+
+private:
+    struct thread_record;
+
+public:
+    /// keeps the calling thread pinned until destroyed, can be nested
+    struct [[nodiscard]] guard
+    {
+        guard(guard&& rhs) noexcept : _record(rhs._record) { rhs._record = nullptr; }
+        guard& operator=(guard&& rhs) noexcept
+        {
+            if (this != &rhs)
+            {
+                release();
+                _record = rhs._record;
+                rhs._record = nullptr;
+            }
+            return *this;
+        }
+        ~guard() { release(); }
+
+        /// unpins early
+        void release()
+        {
+            if (_record)
+                epoch_domain::_unpin(_record);
+            _record = nullptr;
+        }
+
+        guard(guard const&) = delete;
+        guard& operator=(guard const&) = delete;
+
+    private:
+        explicit guard(thread_record* record) : _record(record) {}
+        thread_record* _record;
+        friend epoch_domain;
+    };
+
+    /// a slot that keeps a single object alive while it is protected, independent of pinning
+    /// must be used and destroyed by the thread that created it
+    struct [[nodiscard]] hazard_pointer
+    {
+        hazard_pointer(hazard_pointer&& rhs) noexcept : _record(rhs._record), _slot(rhs._slot) { rhs._record = nullptr; }
+        hazard_pointer& operator=(hazard_pointer&& rhs) noexcept
+        {
+            if (this != &rhs)
+            {
+                _release();
+                _record = rhs._record;
+                _slot = rhs._slot;
+                rhs._record = nullptr;
+            }
+            return *this;
+        }
+        ~hazard_pointer() { _release(); }
+
+        /// loads src and protects the loaded object, retries until src still contains it after publishing
+        /// the result stays valid until reset_protection(), the next protect() or destruction, even if it is retired meanwhile
+        template <class T>
+        T* protect(std::atomic<T*> const& src)
+        {
+            std::atomic<void*>& slot = _record->hazards[_slot];
+            T* ptr = src.load(std::memory_order_relaxed);
+            while (true)
+            {
+                slot.store(ptr, std::memory_order_relaxed);
+                // pairs with the fence before the hazard scan in reclamation
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                T* const current = src.load(std::memory_order_acquire);
+                if (current == ptr)
+                    return ptr;
+                ptr = current;
+            }
+        }
+
+        /// protects an object the caller already knows to be alive, e.g. loaded while pinned
+        template <class T>
+        void reset_protection(T* ptr)
+        {
+            _record->hazards[_slot].store(ptr, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+
+        void reset_protection() { _record->hazards[_slot].store(nullptr, std::memory_order_release); }
+
+        hazard_pointer(hazard_pointer const&) = delete;
+        hazard_pointer& operator=(hazard_pointer const&) = delete;
+
+    private:
+        hazard_pointer(thread_record* record, int slot) : _record(record), _slot(slot) {}
+        void _release();
+
+        thread_record* _record;
+        int _slot;
+        friend epoch_domain;
+    };
+
+public:
+    epoch_domain();
+    ~epoch_domain();
+
+    /// pins the calling thread: objects retired from now on are not freed until the guard is destroyed
+    [[nodiscard]] guard pin()
+    {
+        thread_record* const record = _local_record();
+        _pin(record);
+        return guard(record);
+    }
+
+    /// true if the calling thread is pinned in this domain
+    bool is_pinned() { return _local_record()->pin_depth > 0; }
+
+    /// deleter(ptr, context) is called once no pinned thread and no hazard pointer can see ptr anymore
+    /// ptr must already be unreachable for new readers
+    /// can be called pinned or unpinned, the deleter runs on an arbitrary thread calling retire or flush
+    void retire(void* ptr, deleter_t deleter, void* context = nullptr);
+
+    /// retires an object allocated with cc::alloc
+    template <class T>
+    void retire(T* ptr)
+    {
+        retire(ptr, [](void* p, void*) { cc::free(static_cast<T*>(p)); });
+    }
+
+    /// acquires one of the CC_EPOCH_HAZARD_POINTERS_PER_THREAD slots of the calling thread
+    [[nodiscard]] hazard_pointer make_hazard_pointer();
+
+    /// tries to advance the epoch and frees everything retired by the calling thread (and exited threads) that is safe to free
+    /// returns the amount of objects of the calling thread still waiting
+    size_t flush();
+
+    /// the current global epoch, mostly for testing
+    uint64_t get_epoch() const { return _global_epoch.load(std::memory_order_relaxed); }
+
+    epoch_domain(epoch_domain const&) = delete;
+    epoch_domain(epoch_domain&&) = delete;
+    epoch_domain& operator=(epoch_domain const&) = delete;
+    epoch_domain& operator=(epoch_domain&&) = delete;
+
+private:
+    struct retired_object
+    {
+        void* ptr;
+        deleter_t deleter;
+        void* context;
+        uint64_t epoch;
+    };
+
+    // per thread and domain, never freed before the domain, reused after a thread exits
+    struct alignas(64) thread_record
+    {
+        // (epoch << 1) | 1 while pinned, 0 otherwise
+        std::atomic<uint64_t> pinned_epoch = {0};
+        std::atomic<bool> is_in_use = {false};
+        std::atomic<void*> hazards[CC_EPOCH_HAZARD_POINTERS_PER_THREAD] = {};
+
+        // immutable once published
+        thread_record* next = nullptr;
+        epoch_domain* domain = nullptr;
+
+        // only accessed by the owning thread
+        uint32_t pin_depth = 0;
+        bool is_reclaiming = false;
+        bool is_hazard_used[CC_EPOCH_HAZARD_POINTERS_PER_THREAD] = {};
+        size_t next_reclaim_size = CC_EPOCH_RECLAIM_THRESHOLD;
+        cc::vector<retired_object> retired;
+    };
+
+    CC_FORCE_INLINE void _pin(thread_record* record)
+    {
+        if (record->pin_depth++ > 0)
+            return;
+
+        uint64_t const epoch = _global_epoch.load(std::memory_order_relaxed);
+        record->pinned_epoch.store((epoch << 1) | 1, std::memory_order_relaxed);
+        // the pin must be visible before any pointer of the structure is loaded
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    CC_FORCE_INLINE static void _unpin(thread_record* record)
+    {
+        CC_ASSERT(record->pin_depth > 0 && "unbalanced unpin");
+        if (--record->pin_depth == 0)
+            record->pinned_epoch.store(0, std::memory_order_release);
+    }
+
+    // the record of the calling thread, registers it on first use
+    thread_record* _local_record();
+    thread_record* _acquire_record();
+
+    // called with the global registry locked, by exiting threads or on eviction from the thread-local cache
+    void _release_record(thread_record* record);
+
+    bool _try_advance_epoch();
+    void _reclaim(thread_record* record);
+
+    // frees the objects that are safe to free, keeps the others in "objects"
+    void _free_safe_objects(cc::vector<retired_object>& objects, uint64_t epoch, cc::vector<void*> const& hazards);
+    void _collect_hazards(cc::vector<void*>& out_hazards) const;
+
+private:
+    alignas(64) std::atomic<uint64_t> _global_epoch = {1};
+
+    alignas(64) std::atomic<thread_record*> _records = {nullptr};
+    std::atomic<int32_t> _num_hazard_pointers = {0};
+
+    // retired objects of exited threads
+    std::mutex _orphans_mutex;
+    cc::vector<retired_object> _orphans;
+
+    // identifies this domain in the thread-local record caches, never reused
+    uint64_t _id = 0;
+};
+}
@@ -0,0 +1,32 @@
+#include "executor.hh"
+
+#include <atomic>
+
+#include <clean-core/assert.hh>
+
+namespace
+{
+struct sequential_executor_t final : cc::executor
+{
+    void run_chunks(size_t num_chunks, cc::function_ref<void(size_t)> chunk) override
+    {
+        for (size_t i = 0; i < num_chunks; ++i)
+            chunk(i);
+    }
+
+    size_t get_num_threads() const override { return 1; }
+};
+
+sequential_executor_t g_sequential_executor;
+std::atomic<cc::executor*> g_default_executor = {&g_sequential_executor};
+}
+
+cc::executor* const cc::sequential_executor = &g_sequential_executor;
+
+cc::executor* cc::get_default_executor() { return g_default_executor.load(std::memory_order_acquire); }
+
+void cc::set_default_executor(executor* ex)
+{
+    CC_CONTRACT(ex != nullptr);
+    g_default_executor.store(ex, std::memory_order_release);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+
+#include <clean-core/function_ref.hh>
+#include <clean-core/fwd.hh>
+
+namespace cc
+{
+/// interface for running independent chunks of work, possibly in parallel
+/// used by the parallel algorithms (see parallel_algorithms.hh)
+///
+/// implementations:
+///   cc::sequential_executor - runs all chunks on the calling thread
+///   cc::task_scheduler      - distributes the chunks across its worker threads
+struct executor
+{
+    /// calls chunk(i) for all i in [0, num_chunks), in any order and on any thread
+    /// returns once all calls have returned
+    virtual void run_chunks(size_t num_chunks, cc::function_ref<void(size_t)> chunk) = 0;
+
+    /// amount of chunks that can run at the same time
+    virtual size_t get_num_threads() const = 0;
+
+    executor() = default;
+    executor(executor const&) = delete;
+    executor& operator=(executor const&) = delete;
+    virtual ~executor() = default;
+};
+
+/// global executor running everything on the calling thread
+extern executor* const sequential_executor;
+
+/// executor used by the parallel algorithms if none is given
+/// initially the sequential_executor
+/// NOTE: the executor must outlive all uses, set it back before destroying it
+executor* get_default_executor();
+void set_default_executor(executor* ex);
+}
@@ -4,32 +4,52 @@
 #include <stdint.h>
 
 #include <atomic>
+#include <type_traits>
 
 #include <clean-core/alloc_array.hh>
 #include <clean-core/assert.hh>
 #include <clean-core/bits.hh>
+#include <clean-core/forward.hh>
+#include <clean-core/intrinsics.hh>
+#include <clean-core/macros.hh>
+#include <clean-core/move.hh>
+#include <clean-core/native/futex.hh>
+#include <clean-core/native/timing.hh>
+#include <clean-core/new.hh>
+#include <clean-core/span.hh>
+#include <clean-core/storage.hh>
 
 namespace cc
 {
 #ifndef CC_MPMC_QUEUE_TRACK_SIZE
 #define CC_MPMC_QUEUE_TRACK_SIZE false
 #endif
-	
+
 // Multi-Producer/Multi-Consumer Queue
 // FIFO
 // ~75 cycles per enqueue and dequeue under contention
+// the bulk versions reserve a run of slots with a single CAS, which amortizes this over the batch
+// elements are constructed in place, T does not have to be default constructible
 // Adapted from http://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
-template <class T>
+//
+// EnableWaiting: adds dequeue_wait / enqueue_wait, which block on a futex instead of spinning
+//   waiting threads announce themselves in a counter, the other side only performs a syscall if it is non-zero
+//   costs a full fence per enqueue and dequeue, the non-blocking functions stay usable
+template <class T, bool EnableWaiting = false>
 struct mpmc_queue
 {
 public:
     mpmc_queue() = default;
     explicit mpmc_queue(size_t num_elements, cc::allocator* allocator) { initialize(num_elements, allocator); }
+    ~mpmc_queue() { _destroy_elements(); }
 
+    // NOTE: elements still in the queue are destroyed, no other thread may access the queue
     void initialize(size_t num_elements, cc::allocator* allocator)
     {
         CC_ASSERT(num_elements >= 2 && cc::is_pow2(num_elements) && "mpmc_queue size not a power of two");
 
+        _destroy_elements();
+
         _buffer_mask = num_elements - 1;
         _buffer.reset(allocator, num_elements);
         for (size_t i = 0; i < num_elements; ++i)
@@ -41,7 +61,12 @@ public:
         _dequeue_pos.store(0, std::memory_order_relaxed);
     }
 
-    bool enqueue(const T& data)
+    bool enqueue(T const& data) { return emplace(data); }
+    bool enqueue(T&& data) { return emplace(cc::move(data)); }
+
+    // constructs the element in place, returns false if the queue is full
+    template <class... Args>
+    bool emplace(Args&&... args)
     {
         cell* cell;
         size_t pos = _enqueue_pos.load(std::memory_order_relaxed);
@@ -60,13 +85,16 @@ public:
             else
                 pos = _enqueue_pos.load(std::memory_order_relaxed);
         }
-        cell->data_ = data;
+        new (placement_new, &cell->data_.value) T(cc::forward<Args>(args)...);
         cell->sequence_.store(pos + 1, std::memory_order_release);
 
 #if CC_MPMC_QUEUE_TRACK_SIZE
-		_current_size.fetch_add(1);
+        _current_size.fetch_add(1);
 #endif
 
+        if constexpr (EnableWaiting)
+            _notify(_not_empty_epoch, _num_waiting_consumers, 1);
+
         return true;
     }
 
@@ -89,30 +117,230 @@ public:
             else
                 pos = _dequeue_pos.load(std::memory_order_relaxed);
         }
-        *out_data = cell->data_;
+        *out_data = cc::move(cell->data_.value);
+        cell->data_.value.~T();
         cell->sequence_.store(pos + _buffer_mask + 1, std::memory_order_release);
-        
+
+#if CC_MPMC_QUEUE_TRACK_SIZE
+        _current_size.fetch_add(-1);
+#endif
+
+        if constexpr (EnableWaiting)
+            _notify(_not_full_epoch, _num_waiting_producers, 1);
+
+        return true;
+    }
+
+    // enqueues a prefix of data with a single CAS, as long as there are consecutive free slots
+    // returns the amount of enqueued elements, 0 if the queue is full
+    size_t enqueue_bulk(cc::span<T const> data)
+    {
+        if (data.empty())
+            return 0;
+
+        size_t num = 0;
+        size_t pos = _enqueue_pos.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            // slots are free for this round if their sequence equals their position
+            num = 0;
+            while (num < data.size() && _buffer[(pos + num) & _buffer_mask].sequence_.load(std::memory_order_acquire) == pos + num)
+                ++num;
+
+            if (num == 0)
+            {
+                size_t seq = _buffer[pos & _buffer_mask].sequence_.load(std::memory_order_acquire);
+                if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos) < 0)
+                    return 0; // full
+
+                pos = _enqueue_pos.load(std::memory_order_relaxed);
+                continue;
+            }
+
+            // the slots cannot be taken by anyone else once the position moved past them
+            if (_enqueue_pos.compare_exchange_weak(pos, pos + num, std::memory_order_relaxed))
+                break;
+        }
+
+        for (size_t i = 0; i < num; ++i)
+        {
+            cell* cell = &_buffer[(pos + i) & _buffer_mask];
+            new (placement_new, &cell->data_.value) T(data[i]);
+            cell->sequence_.store(pos + i + 1, std::memory_order_release);
+        }
+
 #if CC_MPMC_QUEUE_TRACK_SIZE
-		_current_size.fetch_add(-1);
+        _current_size.fetch_add(int64_t(num));
 #endif
 
-		return true;
+        if constexpr (EnableWaiting)
+            _notify(_not_empty_epoch, _num_waiting_consumers, num);
+
+        return num;
     }
 
+    // dequeues up to out_data.size() consecutive elements with a single CAS
+    // returns the amount of dequeued elements, 0 if the queue is empty
+    size_t dequeue_bulk(cc::span<T> out_data)
+    {
+        if (out_data.empty())
+            return 0;
+
+        size_t num = 0;
+        size_t pos = _dequeue_pos.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            // slots are filled if their sequence is one past their position
+            num = 0;
+            while (num < out_data.size() && _buffer[(pos + num) & _buffer_mask].sequence_.load(std::memory_order_acquire) == pos + num + 1)
+                ++num;
+
+            if (num == 0)
+            {
+                size_t seq = _buffer[pos & _buffer_mask].sequence_.load(std::memory_order_acquire);
+                if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1) < 0)
+                    return 0; // empty
+
+                pos = _dequeue_pos.load(std::memory_order_relaxed);
+                continue;
+            }
+
+            if (_dequeue_pos.compare_exchange_weak(pos, pos + num, std::memory_order_relaxed))
+                break;
+        }
+
+        for (size_t i = 0; i < num; ++i)
+        {
+            cell* cell = &_buffer[(pos + i) & _buffer_mask];
+            out_data[i] = cc::move(cell->data_.value);
+            cell->data_.value.~T();
+            cell->sequence_.store(pos + i + _buffer_mask + 1, std::memory_order_release);
+        }
+
 #if CC_MPMC_QUEUE_TRACK_SIZE
-	int64_t get_approximate_size() const 
-	{
-		return _current_size.load();
-	}
+        _current_size.fetch_add(-int64_t(num));
+#endif
+
+        if constexpr (EnableWaiting)
+            _notify(_not_full_epoch, _num_waiting_producers, num);
+
+        return num;
+    }
+
+    // dequeues an element, blocks while the queue is empty
+    // returns false if the timeout passed (timeout_ns < 0 waits indefinitely)
+    bool dequeue_wait(T* out_data, int64_t timeout_ns = -1)
+    {
+        static_assert(EnableWaiting, "requires mpmc_queue<T, true>");
+        return _wait(_not_empty_epoch, _num_waiting_consumers, timeout_ns, [&] { return dequeue(out_data); });
+    }
+
+    // enqueues an element, blocks while the queue is full
+    // returns false if the timeout passed (timeout_ns < 0 waits indefinitely)
+    bool enqueue_wait(T const& data, int64_t timeout_ns = -1)
+    {
+        static_assert(EnableWaiting, "requires mpmc_queue<T, true>");
+        return _wait(_not_full_epoch, _num_waiting_producers, timeout_ns, [&] { return enqueue(data); });
+    }
+    bool enqueue_wait(T&& data, int64_t timeout_ns = -1)
+    {
+        static_assert(EnableWaiting, "requires mpmc_queue<T, true>");
+        // data is only moved from on success
+        return _wait(_not_full_epoch, _num_waiting_producers, timeout_ns, [&] { return emplace(cc::move(data)); });
+    }
+
+#if CC_MPMC_QUEUE_TRACK_SIZE
+    int64_t get_approximate_size() const { return _current_size.load(); }
 #endif
 
 private:
     struct cell
     {
         std::atomic<size_t> sequence_;
-        T data_;
+        cc::storage_for<T> data_;
     };
 
+    // amount of unsuccessful tries before a waiting thread sleeps
+    static constexpr int sc_wait_num_spins = 64;
+
+    // wakes waiters after the queue state changed
+    CC_FORCE_INLINE static void _notify(std::atomic<uint32_t>& epoch, std::atomic<uint32_t>& num_waiting, size_t num_changed)
+    {
+        // pairs with the fence in _wait: either the waiter sees the new queue state or this sees the waiter
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (CC_LIKELY(num_waiting.load(std::memory_order_relaxed) == 0))
+            return;
+
+        epoch.fetch_add(1, std::memory_order_release);
+        if (num_changed == 1)
+            cc::futex_wake_one(&epoch);
+        else
+            cc::futex_wake_all(&epoch);
+    }
+
+    // eventcount: retries try_op until it succeeds, sleeps on the epoch in between
+    template <class TryF>
+    static bool _wait(std::atomic<uint32_t>& epoch, std::atomic<uint32_t>& num_waiting, int64_t timeout_ns, TryF&& try_op)
+    {
+        for (auto i = 0; i < sc_wait_num_spins; ++i)
+        {
+            if (try_op())
+                return true;
+            cc::intrin_pause();
+        }
+
+        int64_t const frequency = cc::get_high_precision_frequency();
+        int64_t const deadline = timeout_ns < 0 ? 0 : cc::get_high_precision_ticks() + int64_t(double(timeout_ns) * double(frequency) / 1e9);
+
+        while (true)
+        {
+            // announce first, then check once more, then sleep unless the epoch changed in between
+            uint32_t const current_epoch = epoch.load(std::memory_order_acquire);
+            num_waiting.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            if (try_op())
+            {
+                num_waiting.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+
+            int64_t remaining_ns = -1;
+            if (timeout_ns >= 0)
+            {
+                remaining_ns = int64_t(double(deadline - cc::get_high_precision_ticks()) * 1e9 / double(frequency));
+                if (remaining_ns <= 0)
+                {
+                    num_waiting.fetch_sub(1, std::memory_order_relaxed);
+                    return false;
+                }
+            }
+
+            cc::futex_wait(&epoch, current_epoch, remaining_ns);
+            num_waiting.fetch_sub(1, std::memory_order_relaxed);
+
+            if (try_op())
+                return true;
+        }
+    }
+
+    // destroys the elements that were enqueued but not dequeued
+    void _destroy_elements()
+    {
+        if constexpr (!std::is_trivially_destructible_v<T>)
+        {
+            if (_buffer.empty())
+                return;
+
+            size_t const end = _enqueue_pos.load(std::memory_order_relaxed);
+            for (size_t pos = _dequeue_pos.load(std::memory_order_relaxed); pos != end; ++pos)
+            {
+                cell& c = _buffer[pos & _buffer_mask];
+                if (c.sequence_.load(std::memory_order_relaxed) == pos + 1)
+                    c.data_.value.~T();
+            }
+        }
+    }
 
     using cacheline_pad_t = char[64];
 
@@ -132,9 +360,18 @@ private:
     cacheline_pad_t _pad3;
 
 #if CC_MPMC_QUEUE_TRACK_SIZE
-	std::atomic<int64_t> _current_size = {0};
+    std::atomic<int64_t> _current_size = {0};
 #endif
 
+    // waiting (only used with EnableWaiting)
+    std::atomic<uint32_t> _num_waiting_consumers = {0};
+    std::atomic<uint32_t> _not_empty_epoch = {0};
+
+    cacheline_pad_t _pad4;
+
+    std::atomic<uint32_t> _num_waiting_producers = {0};
+    std::atomic<uint32_t> _not_full_epoch = {0};
+
     mpmc_queue(mpmc_queue const& other) = delete;
     mpmc_queue(mpmc_queue&& other) noexcept = delete;
     mpmc_queue& operator=(mpmc_queue const& other) = delete;
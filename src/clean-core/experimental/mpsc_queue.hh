@@ -0,0 +1,163 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <atomic>
+#include <type_traits>
+
+#include <clean-core/assert.hh>
+#include <clean-core/macros.hh>
+#include <clean-core/span.hh>
+
+namespace cc
+{
+// link of an element in a cc::mpsc_queue, elements derive from it
+struct mpsc_node
+{
+    std::atomic<mpsc_node*> next_in_queue = {nullptr};
+};
+
+// Multi-Producer/Single-Consumer Queue, intrusive and unbounded
+// FIFO per producer, lock-free
+// push is a single atomic exchange (and one exchange per batch with push_n), pop does no atomic RMW except when re-inserting the stub
+// any thread may push, only one thread at a time may pop
+//
+// the queue does not own its elements, they are linked via their mpsc_node base
+// (allocated e.g. with cc::alloc or from an atomic_linked_pool)
+// a node must not be pushed again before it was popped, after pop it belongs to the consumer again
+//
+// the consumer never blocks: while a producer is between its exchange and linking its node,
+// pop can return nullptr even though the queue is not empty (the elements appear once the producer finishes)
+// Adapted from http://www.1024cores.net/home/lock-free-algorithms/queues/intrusive-mpsc-node-based-queue
+//
+// Usage:
+//
+//   struct message : cc::mpsc_node
+//   {
+//       int payload;
+//   };
+//
+//   cc::mpsc_queue<message> mailbox;
+//   mailbox.push(cc::alloc<message>()); // any thread
+//
+//   message* batch[64];
+//   auto const num = mailbox.pop_n(batch); // owning thread
+template <class T>
+struct mpsc_queue
+{
+    static_assert(std::is_base_of_v<mpsc_node, T>, "elements of mpsc_queue must derive from cc::mpsc_node");
+
+public:
+    mpsc_queue() = default;
+
+    // producers
+public:
+    void push(T* node)
+    {
+        CC_CONTRACT(node != nullptr);
+        _push_chain(node, node);
+    }
+
+    // pushes all nodes in order with a single atomic exchange
+    void push_n(cc::span<T* const> nodes)
+    {
+        if (nodes.empty())
+            return;
+
+        for (size_t i = 0; i + 1 < nodes.size(); ++i)
+            nodes[i]->next_in_queue.store(nodes[i + 1], std::memory_order_relaxed);
+        _push_chain(nodes[0], nodes[nodes.size() - 1]);
+    }
+
+    // consumer
+public:
+    // returns nullptr if the queue is empty (or the next element is not fully linked yet)
+    T* pop()
+    {
+        mpsc_node* tail = _tail;
+        mpsc_node* next = tail->next_in_queue.load(std::memory_order_acquire);
+
+        // skip the stub
+        if (tail == &_stub)
+        {
+            if (next == nullptr)
+                return nullptr;
+
+            _tail = next;
+            tail = next;
+            next = next->next_in_queue.load(std::memory_order_acquire);
+        }
+
+        if (next != nullptr)
+        {
+            _tail = next;
+            return static_cast<T*>(tail);
+        }
+
+        // tail is the last linked node, a producer is appending behind it
+        if (tail != _head.load(std::memory_order_acquire))
+            return nullptr;
+
+        // tail is the last node: re-insert the stub so tail can be handed out
+        _push_chain(&_stub, &_stub);
+
+        next = tail->next_in_queue.load(std::memory_order_acquire);
+        if (next != nullptr)
+        {
+            _tail = next;
+            return static_cast<T*>(tail);
+        }
+
+        return nullptr;
+    }
+
+    // pops up to out_nodes.size() elements
+    // returns the amount of popped elements
+    size_t pop_n(cc::span<T*> out_nodes)
+    {
+        size_t num = 0;
+        while (num < out_nodes.size())
+        {
+            T* const node = pop();
+            if (node == nullptr)
+                break;
+            out_nodes[num++] = node;
+        }
+        return num;
+    }
+
+    // approximate when called concurrently, only for the consumer
+    bool empty_approx() const { return _tail == &_stub && _stub.next_in_queue.load(std::memory_order_acquire) == nullptr; }
+
+private:
+    // links first..last (already linked among themselves) behind the current head
+    CC_FORCE_INLINE void _push_chain(mpsc_node* first, mpsc_node* last)
+    {
+        last->next_in_queue.store(nullptr, std::memory_order_relaxed);
+        mpsc_node* const prev = _head.exchange(last, std::memory_order_acq_rel);
+        // the queue is "broken" between these two lines, pop returns nullptr if it reaches prev meanwhile
+        prev->next_in_queue.store(first, std::memory_order_release);
+    }
+
+    using cacheline_pad_t = char[64];
+
+    cacheline_pad_t _pad0;
+
+    // written by the producers
+    std::atomic<mpsc_node*> _head = {&_stub};
+
+    cacheline_pad_t _pad1;
+
+    // owned by the consumer
+    mpsc_node* _tail = &_stub;
+    mpsc_node _stub;
+
+    cacheline_pad_t _pad2;
+
+    // the stub is referenced by address
+    mpsc_queue(mpsc_queue const& other) = delete;
+    mpsc_queue(mpsc_queue&& other) noexcept = delete;
+    mpsc_queue& operator=(mpsc_queue const& other) = delete;
+    mpsc_queue& operator=(mpsc_queue&& other) noexcept = delete;
+};
+}
@@ -22,12 +22,15 @@ namespace cc
 ///       - reserve
 ///
 /// This implementation is quite efficient: https://godbolt.org/z/zYPrPcT8K
-template <class T>
+///
+/// AllocatorT can be a concrete allocator type to bind allocation calls at compile time (see alloc_vector)
+template <class T, class AllocatorT>
 struct ringbuffer
 {
     // ctors
 public:
-    explicit ringbuffer(cc::allocator* allocator = cc::system_allocator) : _allocator(allocator) { CC_CONTRACT(allocator != nullptr); }
+    ringbuffer() : _allocator(detail::default_container_allocator<AllocatorT>()) {}
+    explicit ringbuffer(AllocatorT* allocator) : _allocator(allocator) { CC_CONTRACT(allocator != nullptr); }
 
     ringbuffer(ringbuffer&& rhs) noexcept
     {
@@ -41,7 +44,7 @@ public:
         rhs._end = 0;
         rhs._mask = 0;
         rhs._data = nullptr;
-        rhs._allocator = cc::system_allocator;
+        rhs._allocator = detail::default_container_allocator<AllocatorT>();
     }
     ringbuffer& operator=(ringbuffer&& rhs) noexcept
     {
@@ -51,7 +54,7 @@ public:
             for (size_t i = 0; i < s; ++i)
                 _data[(_begin + i) & _mask].~T();
         }
-        this->_free(_data);
+        this->_free(_data, _mask + 1);
 
         _begin = rhs._begin;
         _end = rhs._end;
@@ -63,7 +66,7 @@ public:
         rhs._end = 0;
         rhs._mask = 0;
         rhs._data = nullptr;
-        rhs._allocator = cc::system_allocator;
+        rhs._allocator = detail::default_container_allocator<AllocatorT>();
 
         return *this;
     }
@@ -92,7 +95,7 @@ public:
             for (size_t i = 0; i < s; ++i)
                 _data[(_begin + i) & _mask].~T();
         }
-        this->_free(_data);
+        this->_free(_data, _mask + 1);
     }
 
     // container API
@@ -136,7 +139,7 @@ public:
         return _data[(_begin + i) & _mask];
     }
 
-    cc::allocator* allocator() const { return _allocator; }
+    AllocatorT* allocator() const { return _allocator; }
 
     // methods
 public:
@@ -256,7 +259,7 @@ private:
             new (placement_new, &new_data[i]) T(cc::move(v));
             v.~T();
         }
-        this->_free(_data);
+        this->_free(_data, _mask + 1);
         _data = new_data;
         _mask = new_mask;
         _begin = 0;
@@ -280,7 +283,7 @@ private:
             new (placement_new, &new_data[i + 1]) T(cc::move(v));
             v.~T();
         }
-        this->_free(_data);
+        this->_free(_data, _mask + 1);
         _data = new_data;
         _mask = new_mask;
         _begin = 0;
@@ -293,10 +296,13 @@ private:
         CC_ASSERT(_allocator && "no allocator set?");
         return reinterpret_cast<T*>(_allocator->alloc(size * sizeof(T), alignof(T)));
     }
-    void _free(T* p)
+    void _free(T* p, size_t size)
     {
+        if (p == nullptr)
+            return;
+
         CC_ASSERT(_allocator && "no allocator set?");
-        _allocator->free(p);
+        _allocator->free_sized(p, size * sizeof(T), alignof(T));
     }
 
 private:
@@ -304,6 +310,6 @@ private:
     size_t _end = 0;   // points BEHIND last valid entry (or == _begin if empty)
     size_t _mask = 0;  // "_mask + 1" is size, "& _mask" wraps around ringbuffer
     T* _data = nullptr;
-    cc::allocator* _allocator = nullptr;
+    AllocatorT* _allocator = nullptr;
 };
 }
@@ -0,0 +1,250 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <type_traits>
+
+#include <clean-core/alloc_array.hh>
+#include <clean-core/assert.hh>
+#include <clean-core/bits.hh>
+#include <clean-core/forward.hh>
+#include <clean-core/macros.hh>
+#include <clean-core/move.hh>
+#include <clean-core/new.hh>
+#include <clean-core/span.hh>
+#include <clean-core/storage.hh>
+#include <clean-core/utility.hh>
+
+namespace cc
+{
+// Single-Producer/Single-Consumer Queue
+// FIFO, bounded, lock-free (no CAS, one release store per operation or batch)
+// exactly one thread may call the producer functions and exactly one thread the consumer functions
+//
+// both sides keep a cached copy of the other side's position and only reload it when the cache says full / empty,
+// so the shared cache lines are touched about once per wrap-around instead of once per operation
+//
+// bulk versions:
+//   push_n / pop_n copy / move whole batches, handling the wrap-around internally
+//   reserve_write / commit_write and reserve_read / commit_read give direct access to the contiguous slots,
+//   reserving again after a commit returns the segment behind the wrap-around
+//
+// Usage:
+//
+//   cc::spsc_queue<msg> queue(1024, cc::system_allocator);
+//
+//   // producer thread
+//   while (!queue.push(m))
+//       ;
+//
+//   // consumer thread
+//   auto const in = queue.reserve_read(64);
+//   for (auto const& m : in)
+//       handle(m);
+//   queue.commit_read(in.size());
+template <class T>
+struct spsc_queue
+{
+public:
+    spsc_queue() = default;
+    explicit spsc_queue(size_t num_elements, cc::allocator* allocator) { initialize(num_elements, allocator); }
+    ~spsc_queue() { _destroy_elements(); }
+
+    // NOTE: elements still in the queue are destroyed, no other thread may access the queue
+    void initialize(size_t num_elements, cc::allocator* allocator)
+    {
+        CC_ASSERT(num_elements >= 2 && cc::is_pow2(num_elements) && "spsc_queue size not a power of two");
+
+        _destroy_elements();
+
+        _buffer_mask = num_elements - 1;
+        _buffer.reset(allocator, num_elements);
+
+        _write_pos.store(0, std::memory_order_relaxed);
+        _cached_read_pos = 0;
+        _read_pos.store(0, std::memory_order_relaxed);
+        _cached_write_pos = 0;
+    }
+
+    size_t capacity() const { return _buffer_mask + 1; }
+
+    // producer
+public:
+    bool push(T const& data) { return emplace(data); }
+    bool push(T&& data) { return emplace(cc::move(data)); }
+
+    // constructs the element in place, returns false if the queue is full
+    template <class... Args>
+    bool emplace(Args&&... args)
+    {
+        size_t const pos = _write_pos.load(std::memory_order_relaxed);
+        if (CC_UNLIKELY(_num_writable(pos, 1) == 0))
+            return false;
+
+        new (placement_new, &_buffer[pos & _buffer_mask].value) T(cc::forward<Args>(args)...);
+        _write_pos.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // pushes a prefix of data, as much as fits
+    // returns the amount of pushed elements, 0 if the queue is full
+    size_t push_n(cc::span<T const> data)
+    {
+        size_t const pos = _write_pos.load(std::memory_order_relaxed);
+        size_t const num = _num_writable(pos, data.size());
+
+        for (size_t i = 0; i < num; ++i)
+            new (placement_new, &_buffer[(pos + i) & _buffer_mask].value) T(data[i]);
+
+        if (num > 0)
+            _write_pos.store(pos + num, std::memory_order_release);
+        return num;
+    }
+
+    // up to max_num free contiguous slots, ends at the wrap-around, empty if the queue is full
+    // the slots are uninitialized memory, only the first num of them are published by commit_write(num)
+    // (thus restricted to trivially copyable types)
+    cc::span<T> reserve_write(size_t max_num)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "reserve_write hands out raw slots, use push / emplace for other types");
+
+        size_t const pos = _write_pos.load(std::memory_order_relaxed);
+        size_t const offset = pos & _buffer_mask;
+        size_t const num = cc::min(_num_writable(pos, max_num), _buffer_mask + 1 - offset);
+        return {&_buffer[offset].value, num};
+    }
+
+    // publishes the first num slots of the last reserve_write
+    void commit_write(size_t num)
+    {
+        size_t const pos = _write_pos.load(std::memory_order_relaxed);
+        CC_ASSERT(num <= _buffer_mask + 1 - (pos - _cached_read_pos) && "committed more than was reserved");
+        _write_pos.store(pos + num, std::memory_order_release);
+    }
+
+    // consumer
+public:
+    bool pop(T* out_data)
+    {
+        size_t const pos = _read_pos.load(std::memory_order_relaxed);
+        if (CC_UNLIKELY(_num_readable(pos, 1) == 0))
+            return false;
+
+        T& value = _buffer[pos & _buffer_mask].value;
+        *out_data = cc::move(value);
+        value.~T();
+        _read_pos.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // pops up to out_data.size() elements
+    // returns the amount of popped elements, 0 if the queue is empty
+    size_t pop_n(cc::span<T> out_data)
+    {
+        size_t const pos = _read_pos.load(std::memory_order_relaxed);
+        size_t const num = _num_readable(pos, out_data.size());
+
+        for (size_t i = 0; i < num; ++i)
+        {
+            T& value = _buffer[(pos + i) & _buffer_mask].value;
+            out_data[i] = cc::move(value);
+            value.~T();
+        }
+
+        if (num > 0)
+            _read_pos.store(pos + num, std::memory_order_release);
+        return num;
+    }
+
+    // up to max_num contiguous elements, ends at the wrap-around, empty if the queue is empty
+    // the elements stay in the queue (and may be modified or moved from) until commit_read
+    cc::span<T> reserve_read(size_t max_num)
+    {
+        size_t const pos = _read_pos.load(std::memory_order_relaxed);
+        size_t const offset = pos & _buffer_mask;
+        size_t const num = cc::min(_num_readable(pos, max_num), _buffer_mask + 1 - offset);
+        return {&_buffer[offset].value, num};
+    }
+
+    // destroys and releases the first num elements of the last reserve_read
+    void commit_read(size_t num)
+    {
+        size_t const pos = _read_pos.load(std::memory_order_relaxed);
+        CC_ASSERT(num <= _cached_write_pos - pos && "committed more than was reserved");
+
+        if constexpr (!std::is_trivially_destructible_v<T>)
+            for (size_t i = 0; i < num; ++i)
+                _buffer[(pos + i) & _buffer_mask].value.~T();
+
+        _read_pos.store(pos + num, std::memory_order_release);
+    }
+
+    // approximate when called concurrently
+public:
+    size_t size_approx() const { return _write_pos.load(std::memory_order_acquire) - _read_pos.load(std::memory_order_acquire); }
+    bool empty_approx() const { return size_approx() == 0; }
+
+private:
+    // free slots at pos (at most max_num), reloads the read position only if the cached one is not enough
+    CC_FORCE_INLINE size_t _num_writable(size_t pos, size_t max_num)
+    {
+        size_t free = _buffer_mask + 1 - (pos - _cached_read_pos);
+        if (free < max_num)
+        {
+            _cached_read_pos = _read_pos.load(std::memory_order_acquire);
+            free = _buffer_mask + 1 - (pos - _cached_read_pos);
+        }
+        return cc::min(free, max_num);
+    }
+
+    // filled slots at pos (at most max_num), reloads the write position only if the cached one is not enough
+    CC_FORCE_INLINE size_t _num_readable(size_t pos, size_t max_num)
+    {
+        size_t filled = _cached_write_pos - pos;
+        if (filled < max_num)
+        {
+            _cached_write_pos = _write_pos.load(std::memory_order_acquire);
+            filled = _cached_write_pos - pos;
+        }
+        return cc::min(filled, max_num);
+    }
+
+    void _destroy_elements()
+    {
+        if constexpr (!std::is_trivially_destructible_v<T>)
+        {
+            size_t const end = _write_pos.load(std::memory_order_relaxed);
+            for (size_t pos = _read_pos.load(std::memory_order_relaxed); pos != end; ++pos)
+                _buffer[pos & _buffer_mask].value.~T();
+        }
+    }
+
+    using cacheline_pad_t = char[64];
+
+    cacheline_pad_t _pad0;
+
+    cc::alloc_array<cc::storage_for<T>> _buffer;
+    size_t _buffer_mask = 0;
+
+    cacheline_pad_t _pad1;
+
+    // written by the producer
+    std::atomic<size_t> _write_pos = {0};
+    size_t _cached_read_pos = 0;
+
+    cacheline_pad_t _pad2;
+
+    // written by the consumer
+    std::atomic<size_t> _read_pos = {0};
+    size_t _cached_write_pos = 0;
+
+    cacheline_pad_t _pad3;
+
+    spsc_queue(spsc_queue const& other) = delete;
+    spsc_queue(spsc_queue&& other) noexcept = delete;
+    spsc_queue& operator=(spsc_queue const& other) = delete;
+    spsc_queue& operator=(spsc_queue&& other) noexcept = delete;
+};
+}
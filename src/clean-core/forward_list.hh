@@ -1,20 +1,30 @@
 #pragma once
 
+#include <type_traits>
+
 #include <clean-core/allocate.hh>
+#include <clean-core/allocator.hh>
 #include <clean-core/forward.hh>
 #include <clean-core/fwd.hh>
 #include <clean-core/move.hh>
 #include <clean-core/sentinel.hh>
+#include <clean-core/span.hh>
 
 namespace cc
 {
+namespace detail
+{
+/// singly linked list that does not own its nodes
+/// all allocating operations receive the allocator explicitly, the owner has to clear the list
+/// used by forward_list and as buckets of the node-based containers (map, set)
+///
+/// nodes are allocated from the given cc::allocator
+/// or, if it is nullptr, from the thread-local pools of cc::alloc
 template <class T>
-struct forward_list
+struct forward_list_base
 {
     struct iterator;
     struct const_iterator;
-
-private:
     struct node;
 
     // container
@@ -42,30 +52,28 @@ public:
         return _first->value;
     }
 
-    // methods
+    // node management
 public:
     template <class... Args>
-    T& emplace_front(Args&&... args)
+    T& _emplace_front(cc::allocator* allocator, Args&&... args)
     {
-        auto n = cc::alloc<node>(cc::forward<Args>(args)...);
+        auto n = _new_node(allocator, cc::forward<Args>(args)...);
         n->next = _first;
         _first = n;
         return n->value;
     }
-    void push_front(T const& v) { emplace_front(v); }
-    void push_front(T&& v) { emplace_front(cc::move(v)); }
 
-    T pop_front()
+    T _pop_front(cc::allocator* allocator)
     {
         CC_CONTRACT(!empty());
         T v = cc::move(_first->value);
         auto n = _first;
         _first = _first->next;
-        cc::free(n);
+        _delete_node(allocator, n);
         return v;
     }
 
-    iterator erase_after(const_iterator it)
+    iterator _erase_after(cc::allocator* allocator, const_iterator it)
     {
         CC_CONTRACT(it.n->next); // no element after exists
 
@@ -75,21 +83,104 @@ public:
         auto to_erase = n->next;
         n->next = to_erase->next;
 
-        cc::free(to_erase);
+        _delete_node(allocator, to_erase);
 
         return n->next;
     }
 
-    void clear()
+    void _clear(cc::allocator* allocator)
     {
         auto p = _first;
-        while (p)
+        _first = nullptr;
+
+        if (allocator == nullptr)
         {
-            auto n = p->next;
-            cc::free(p);
-            p = n;
+            while (p)
+            {
+                auto n = p->next;
+                cc::free(p);
+                p = n;
+            }
+        }
+        else if (allocator->is_free_noop())
+        {
+            // no individual frees, only run destructors
+            if constexpr (!std::is_trivially_destructible_v<T>)
+            {
+                while (p)
+                {
+                    auto n = p->next;
+                    p->~node();
+                    p = n;
+                }
+            }
+        }
+        else
+        {
+            // free in batches
+            enum
+            {
+                batch_size = 32
+            };
+            void* batch[batch_size];
+            size_t num_batched = 0;
+
+            while (p)
+            {
+                auto n = p->next;
+                p->~node();
+
+                batch[num_batched++] = p;
+                if (num_batched == batch_size)
+                {
+                    allocator->free_batch(cc::span<void* const>(batch, num_batched));
+                    num_batched = 0;
+                }
+
+                p = n;
+            }
+
+            if (num_batched > 0)
+                allocator->free_batch(cc::span<void* const>(batch, num_batched));
         }
-        _first = nullptr;
+    }
+
+    /// appends copies of all elements of rhs (preserving their order)
+    void _append_copy(cc::allocator* allocator, forward_list_base const& rhs)
+    {
+        node* pn = _first;
+        while (pn && pn->next)
+            pn = pn->next;
+
+        auto rn = rhs._first;
+        while (rn != nullptr)
+        {
+            auto n = _new_node(allocator, rn->value);
+            (pn ? pn->next : _first) = n;
+            pn = n;
+            rn = rn->next;
+        }
+    }
+
+    template <class... Args>
+    static node* _new_node(cc::allocator* allocator, Args&&... args)
+    {
+        if (allocator == nullptr)
+            return cc::alloc<node>(cc::forward<Args>(args)...);
+
+        return new (placement_new, allocator->alloc(sizeof(node), alignof(node))) node(cc::forward<Args>(args)...);
+    }
+
+    static void _delete_node(cc::allocator* allocator, node* n)
+    {
+        if (allocator == nullptr)
+        {
+            cc::free(n);
+            return;
+        }
+
+        n->~node();
+        allocator->free_sized(n, sizeof(node), alignof(node));
     }
 
     // iteration
@@ -106,7 +197,7 @@ public:
         iterator(node* n) : n(n) {}
         node* n = nullptr;
 
-        friend forward_list;
+        friend forward_list_base;
     };
     struct const_iterator
     {
@@ -122,86 +213,121 @@ public:
         const_iterator(node const* n) : n(n) {}
         node const* n = nullptr;
 
-        friend forward_list;
+        friend forward_list_base;
     };
 
     iterator begin() { return {_first}; }
     const_iterator begin() const { return {_first}; }
     sentinel end() const { return {}; }
 
-    // ctors
+    // internal types
 public:
-    forward_list() = default;
-    forward_list(forward_list const& rhs)
+    // NOTE: node is NON-OWNING!
+    //       freeing a node does NOT free next
+    struct node
     {
-        auto rn = rhs._first;
-        node* pn = nullptr;
-        while (rn != nullptr)
+        T value;
+        node* next = nullptr;
+
+        template <class... Args>
+        node(Args&&... args) : value(cc::forward<Args>(args)...)
         {
-            auto n = cc::alloc<node>(rn->value);
-            (pn ? pn->next : _first) = n;
-            pn = n;
-            rn = rn->next;
         }
+
+        node(node const&) = delete;
+        node(node&&) = delete;
+        node& operator=(node const&) = delete;
+        node& operator=(node&&) = delete;
+    };
+
+    node* _first = nullptr;
+};
+}
+
+/// singly linked list
+///
+/// nodes are allocated via cc::alloc or, if given, via a cc::allocator
+/// copies and moves propagate the allocator
+/// if the allocator has no-op frees (e.g. linear allocators), clear() and the destructor only run destructors
+template <class T>
+struct forward_list : protected detail::forward_list_base<T>
+{
+    using base_t = detail::forward_list_base<T>;
+    using typename base_t::const_iterator;
+    using typename base_t::iterator;
+
+    // container
+public:
+    using base_t::empty;
+    using base_t::front;
+    using base_t::size;
+
+    // methods
+public:
+    template <class... Args>
+    T& emplace_front(Args&&... args)
+    {
+        return this->_emplace_front(_allocator, cc::forward<Args>(args)...);
     }
-    forward_list(forward_list&& rhs) noexcept
+    void push_front(T const& v) { emplace_front(v); }
+    void push_front(T&& v) { emplace_front(cc::move(v)); }
+
+    T pop_front() { return this->_pop_front(_allocator); }
+
+    iterator erase_after(const_iterator it) { return this->_erase_after(_allocator, it); }
+
+    void clear() { this->_clear(_allocator); }
+
+    /// the allocator of the nodes, nullptr if cc::alloc is used
+    cc::allocator* allocator() const { return _allocator; }
+
+    // iteration
+public:
+    using base_t::begin;
+    using base_t::end;
+
+    // ctors
+public:
+    forward_list() = default;
+    explicit forward_list(cc::allocator* allocator) : _allocator(allocator) {}
+
+    forward_list(forward_list const& rhs) : _allocator(rhs._allocator) { this->_append_copy(_allocator, rhs); }
+    forward_list(forward_list const& rhs, cc::allocator* allocator) : _allocator(allocator) { this->_append_copy(_allocator, rhs); }
+    forward_list(forward_list&& rhs) noexcept : _allocator(rhs._allocator)
     {
-        _first = rhs._first;
+        this->_first = rhs._first;
         rhs._first = nullptr;
+        rhs._allocator = nullptr;
     }
     forward_list& operator=(forward_list const& rhs)
     {
-        clear();
-
-        auto rn = rhs._first;
-        node* pn = nullptr;
-        while (rn != nullptr)
+        if (this != &rhs)
         {
-            auto n = cc::alloc<node>(rn->value);
-            (pn ? pn->next : _first) = n;
-            pn = n;
-            rn = rn->next;
+            clear();
+            _allocator = rhs._allocator;
+            this->_append_copy(_allocator, rhs);
         }
 
         return *this;
     }
     forward_list& operator=(forward_list&& rhs) noexcept
     {
-        clear();
+        if (this != &rhs)
+        {
+            clear();
 
-        _first = rhs._first;
-        rhs._first = nullptr;
+            this->_first = rhs._first;
+            _allocator = rhs._allocator;
+            rhs._first = nullptr;
+            rhs._allocator = nullptr;
+        }
 
         return *this;
     }
 
     ~forward_list() { clear(); }
 
-    // internal types
-private:
-    // NOTE: node is NON-OWNING!
-    //       cc::free(node) does NOT free next
-    struct node
-    {
-        T value;
-        node* next = nullptr;
-
-        template <class... Args>
-        node(Args&&... args) : value(cc::forward<Args>(args)...)
-        {
-        }
-
-        node(node const&) = delete;
-        node(node&&) = delete;
-        node& operator=(node const&) = delete;
-        node& operator=(node&&) = delete;
-    };
-
 private:
-    node* _first = nullptr;
-
-    // to guarantee pointer stability, map currently needs unexposed internal access
-    template <class KeyT, class ValueT, class HashT, class EqualT>
-    friend struct map;
+    cc::allocator* _allocator = nullptr;
 };
 }
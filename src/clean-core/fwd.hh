@@ -34,6 +34,9 @@ struct pair;
 template <class... Types>
 struct tuple;
 
+// allocator interface, the default allocator type of containers
+struct allocator;
+
 // containers and ranges
 template <class T>
 struct span;
@@ -46,7 +49,7 @@ template <class Traits>
 struct vector_ex;
 template <class T, size_t N>
 struct capped_vector;
-template <class T>
+template <class T, class AllocatorT = allocator>
 struct alloc_vector;
 
 template <class T, size_t N = dynamic_size>
@@ -55,7 +58,7 @@ template <class T>
 struct fwd_array;
 template <class T, size_t N>
 struct capped_array;
-template <class T>
+template <class T, class AllocatorT = allocator>
 struct alloc_array;
 
 template <size_t N = dynamic_size>
@@ -93,7 +96,7 @@ template <class T>
 struct stream_ref;
 
 // functional
-template <class Signature>
+template <class Signature, class AllocatorT = allocator>
 struct unique_function;
 template <class Signature>
 struct function_ref;
@@ -108,20 +111,36 @@ struct shared_ptr;
 
 // locks
 struct spin_lock;
+struct mutex;
+struct ticket_lock;
+struct mcs_lock;
+struct rw_spin_lock;
+template <class T>
+struct seqlock;
 template <class T>
 struct lock_guard;
+template <class T>
+struct shared_lock_guard;
+
+// threading
+struct executor;
+struct task_scheduler;
+struct epoch_domain;
 
 // allocators
-struct allocator;
 struct linear_allocator;
 struct stack_allocator;
 struct tlsf_allocator;
 struct atomic_pool_allocator;
 struct atomic_linear_allocator;
+struct atomic_virtual_linear_allocator;
+struct mapped_arena_allocator;
+struct object_arena;
+struct scratch_scope;
 
 extern allocator* const system_allocator;
 
 // experimental
-template <class T>
+template <class T, class AllocatorT = allocator>
 struct ringbuffer;
 } // namespace cc
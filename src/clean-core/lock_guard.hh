@@ -15,6 +15,22 @@ struct [[nodiscard]] lock_guard
     lock_guard& operator=(lock_guard const&) = delete;
     lock_guard& operator=(lock_guard&&) noexcept = delete;
 
+private:
+    T& _lock;
+};
+
+// shared (reader) lock of a lock with lock_shared() / unlock_shared(), e.g. cc::rw_spin_lock
+template <typename T>
+struct [[nodiscard]] shared_lock_guard
+{
+    CC_FORCE_INLINE explicit shared_lock_guard(T& mutex) : _lock(mutex) { _lock.lock_shared(); }
+    CC_FORCE_INLINE ~shared_lock_guard() { _lock.unlock_shared(); }
+
+    shared_lock_guard(shared_lock_guard const&) = delete;
+    shared_lock_guard(shared_lock_guard&&) noexcept = delete;
+    shared_lock_guard& operator=(shared_lock_guard const&) = delete;
+    shared_lock_guard& operator=(shared_lock_guard&&) noexcept = delete;
+
 private:
     T& _lock;
 };
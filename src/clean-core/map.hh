@@ -1,6 +1,6 @@
 #pragma once
 
-#include <clean-core/array.hh>
+#include <clean-core/alloc_array.hh>
 #include <clean-core/detail/srange.hh>
 #include <clean-core/equal_to.hh>
 #include <clean-core/forward_list.hh>
@@ -49,6 +49,12 @@ size_t bucket_size(map<KeyT, ValueT, HashT, EqualT> const& map, size_t bucket_id
  * - currently guarantees pointer stability for values (TODO: should we keep this?)
  * - hash is currently NOT transparent (until we resolve the int/float issue)
  *
+ * Allocators:
+ * - by default, nodes come from cc::alloc and the bucket array from the system allocator
+ * - optionally, a cc::allocator can be passed that provides all memory (e.g. a per-request arena)
+ * - copies and moves propagate the allocator
+ * - if the allocator has no-op frees (e.g. linear allocators), clear() and the destructor skip individual frees
+ *
  * TODO:
  * - emplace functions
  */
@@ -81,13 +87,55 @@ public:
     // ctors
 public:
     map() = default;
-    map(map const&) = default;
-    map(map&&) = default;
-    map& operator=(map const&) = default;
-    map& operator=(map&&) = default;
+
+    /// creates an empty map that allocates all its memory from the given allocator
+    explicit map(cc::allocator* allocator) : _entries(allocator), _allocator(allocator) { CC_CONTRACT(allocator != nullptr); }
+
+    map(map const& rhs) : _entries(rhs._bucket_allocator()), _allocator(rhs._allocator) { _copy_entries(rhs); }
+
+    /// copies rhs into a map with a different allocator (nullptr for the default)
+    map(map const& rhs, cc::allocator* allocator) : _entries(allocator ? allocator : cc::system_allocator), _allocator(allocator)
+    {
+        _copy_entries(rhs);
+    }
+
+    map(map&& rhs) noexcept : _entries(cc::move(rhs._entries)), _size(rhs._size), _allocator(rhs._allocator)
+    {
+        rhs._size = 0;
+        rhs._allocator = nullptr;
+    }
+
+    map& operator=(map const& rhs)
+    {
+        if (this != &rhs)
+        {
+            clear();
+            _allocator = rhs._allocator;
+            _entries.reset(_bucket_allocator());
+            _copy_entries(rhs);
+        }
+        return *this;
+    }
+
+    map& operator=(map&& rhs) noexcept
+    {
+        if (this != &rhs)
+        {
+            clear();
+            _entries = cc::move(rhs._entries);
+            _size = rhs._size;
+            _allocator = rhs._allocator;
+            rhs._size = 0;
+            rhs._allocator = nullptr;
+        }
+        return *this;
+    }
+
+    ~map() { _clear_nodes(); }
 
     /// creates a map and adds all key-value pairs
-    map(std::initializer_list<pair<KeyT const, ValueT>> entries)
+    map(std::initializer_list<pair<KeyT const, ValueT>> entries, cc::allocator* allocator = nullptr)
+      : _entries(allocator ? allocator : cc::system_allocator), _allocator(allocator)
     {
         reserve(entries.size());
         for (auto&& kvp : entries)
@@ -99,7 +147,7 @@ public:
     /// TODO: make sure it doesn't interfere with copy ctor?
     /// TODO: use emplace and move if range is rvalue ref
     template <class Range, cc::enable_if<cc::is_any_range<Range>> = true>
-    explicit map(Range&& range)
+    explicit map(Range&& range, cc::allocator* allocator = nullptr) : _entries(allocator ? allocator : cc::system_allocator), _allocator(allocator)
     {
         for (auto&& [key, value] : range)
             operator[](key) = value;
@@ -123,7 +171,7 @@ public:
                 return e.value;
 
         ++_size;
-        return l.emplace_front(KeyT(key)).value;
+        return l._emplace_front(_allocator, KeyT(key)).value;
     }
 
     /// looks up the given key
@@ -144,7 +192,7 @@ public:
             if (EqualT{}(e.key, key))
                 return e.value;
 
-        auto& val = l.emplace_front(KeyT(key), create()).value;
+        auto& val = l._emplace_front(_allocator, KeyT(key), create()).value;
         ++_size; // AFTER create
         return val;
     }
@@ -249,7 +297,7 @@ public:
 
         if (EqualT{}((*it).key, key))
         {
-            list.pop_front();
+            list._pop_front(_allocator);
             --_size;
             return true;
         }
@@ -259,7 +307,7 @@ public:
         {
             if (EqualT{}((*it).key, key))
             {
-                list.erase_after(prev);
+                list._erase_after(_allocator, prev);
                 --_size;
                 return true;
             }
@@ -287,10 +335,12 @@ public:
     void clear()
     {
         _size = 0;
-        for (auto& l : _entries)
-            l.clear();
+        _clear_nodes();
     }
 
+    /// the allocator of all memory of this map, nullptr for the default (cc::alloc for nodes)
+    cc::allocator* allocator() const { return _allocator; }
+
     // operators
 public:
     bool operator==(map const& rhs) const
@@ -363,29 +413,29 @@ public:
             }
         }
     };
-    struct iterator : iterator_base<cc::forward_list<entry>>
+    struct iterator : iterator_base<detail::forward_list_base<entry>>
     {
-        using iterator_base<cc::forward_list<entry>>::iterator_base;
+        using iterator_base<detail::forward_list_base<entry>>::iterator_base;
         entry_ref<ValueT&> operator*() { return {(*this->it).key, (*this->it).value}; }
     };
-    struct const_iterator : iterator_base<cc::forward_list<entry> const>
+    struct const_iterator : iterator_base<detail::forward_list_base<entry> const>
     {
-        using iterator_base<cc::forward_list<entry> const>::iterator_base;
+        using iterator_base<detail::forward_list_base<entry> const>::iterator_base;
         entry_ref<ValueT const&> operator*() { return {(*this->it).key, (*this->it).value}; }
     };
-    struct key_iterator : iterator_base<cc::forward_list<entry> const>
+    struct key_iterator : iterator_base<detail::forward_list_base<entry> const>
     {
-        using iterator_base<cc::forward_list<entry> const>::iterator_base;
+        using iterator_base<detail::forward_list_base<entry> const>::iterator_base;
         KeyT const& operator*() { return (*this->it).key; }
     };
-    struct value_iterator : iterator_base<cc::forward_list<entry>>
+    struct value_iterator : iterator_base<detail::forward_list_base<entry>>
     {
-        using iterator_base<cc::forward_list<entry>>::iterator_base;
+        using iterator_base<detail::forward_list_base<entry>>::iterator_base;
         ValueT& operator*() { return (*this->it).value; }
     };
-    struct value_const_iterator : iterator_base<cc::forward_list<entry> const>
+    struct value_const_iterator : iterator_base<detail::forward_list_base<entry> const>
     {
-        using iterator_base<cc::forward_list<entry> const>::iterator_base;
+        using iterator_base<detail::forward_list_base<entry> const>::iterator_base;
         ValueT const& operator*() { return (*this->it).value; }
     };
     iterator begin() { return {_entries.begin(), _entries.end()}; }
@@ -419,7 +469,7 @@ private:
         CC_ASSERT((new_cap & (new_cap - 1)) == 0 && "capacity not power-of-two");
 
         auto old_entries = cc::move(_entries);
-        _entries = cc::array<cc::forward_list<entry>>::defaulted(new_cap);
+        _entries = cc::alloc_array<detail::forward_list_base<entry>>::defaulted(new_cap, _bucket_allocator());
         for (auto& l : old_entries)
         {
             auto n = l._first;
@@ -435,9 +485,38 @@ private:
 
                 n = nn;
             }
+        }
+    }
 
-            l._first = nullptr; // all added to new lists, make sure they are not deleted
+    cc::allocator* _bucket_allocator() const { return _allocator ? _allocator : cc::system_allocator; }
+
+    /// destroys all nodes, keeps the buckets
+    void _clear_nodes()
+    {
+        // nothing to destroy or free individually
+        if (_allocator && _allocator->is_free_noop() && std::is_trivially_destructible_v<entry>)
+        {
+            for (auto& l : _entries)
+                l._first = nullptr;
+            return;
         }
+
+        for (auto& l : _entries)
+            l._clear(_allocator);
+    }
+
+    /// copies all entries of rhs, expects this map to be empty
+    void _copy_entries(map const& rhs)
+    {
+        CC_ASSERT(_size == 0 && _entries.empty());
+
+        if (rhs._entries.empty())
+            return;
+
+        _entries = cc::alloc_array<detail::forward_list_base<entry>>::defaulted(rhs._entries.size(), _bucket_allocator());
+        for (size_t i = 0; i < _entries.size(); ++i)
+            _entries[i]._append_copy(_allocator, rhs._entries[i]);
+        _size = rhs._size;
     }
 
     // member
@@ -452,8 +531,9 @@ private:
         {
         }
     };
-    cc::array<cc::forward_list<entry>> _entries;
+    cc::alloc_array<detail::forward_list_base<entry>> _entries;
     size_t _size = 0;
+    cc::allocator* _allocator = nullptr; // nullptr: nodes via cc::alloc, buckets via system allocator
 
     friend double experimental::compute_hash_badness<KeyT, ValueT, HashT, EqualT>(map const& map);
 
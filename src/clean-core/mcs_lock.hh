@@ -0,0 +1,124 @@
+#pragma once
+
+#include <atomic>
+
+#include <clean-core/assert.hh>
+#include <clean-core/intrinsics.hh>
+#include <clean-core/macros.hh>
+
+// maximum amount of mcs_locks a thread can hold at the same time via lock() without explicit node
+#ifndef CC_MCS_LOCK_MAX_HELD
+#define CC_MCS_LOCK_MAX_HELD 8
+#endif
+
+namespace cc
+{
+// FIFO-fair queue lock (Mellor-Crummey and Scott)
+// waiters form a linked list, each one spins on its own node (own cache line),
+// so a handoff only touches the cache lines of the releasing and the next thread
+// NOTE: like ticket_lock, degrades badly if there are more threads than cores
+//
+// lock() / unlock() use nodes from a small thread-local pool, which makes it usable with cc::lock_guard and as LockT
+// lock(node&) / unlock(node&) take the node explicitly (e.g. from the stack)
+struct mcs_lock
+{
+    struct alignas(64) node
+    {
+        std::atomic<node*> next = {nullptr};
+        std::atomic<bool> is_waiting = {false};
+        bool is_in_use = false; // only for the thread-local pool
+    };
+
+    CC_FORCE_INLINE void lock(node& n) noexcept
+    {
+        n.next.store(nullptr, std::memory_order_relaxed);
+        n.is_waiting.store(true, std::memory_order_relaxed);
+
+        node* const prev = _tail.exchange(&n, std::memory_order_acq_rel);
+        if (prev == nullptr)
+            return;
+
+        // enqueue behind the previous waiter, who hands over the lock by clearing our flag
+        prev->next.store(&n, std::memory_order_release);
+        while (n.is_waiting.load(std::memory_order_acquire))
+            cc::intrin_pause();
+    }
+
+    CC_FORCE_INLINE bool try_lock(node& n) noexcept
+    {
+        n.next.store(nullptr, std::memory_order_relaxed);
+        node* expected = nullptr;
+        return _tail.load(std::memory_order_relaxed) == nullptr //
+               && _tail.compare_exchange_strong(expected, &n, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    CC_FORCE_INLINE void unlock(node& n) noexcept
+    {
+        node* next = n.next.load(std::memory_order_acquire);
+        if (next == nullptr)
+        {
+            // no known successor: release if we are still the last node
+            node* expected = &n;
+            if (_tail.compare_exchange_strong(expected, nullptr, std::memory_order_release, std::memory_order_relaxed))
+                return;
+
+            // a successor swapped itself in but has not linked yet
+            while ((next = n.next.load(std::memory_order_acquire)) == nullptr)
+                cc::intrin_pause();
+        }
+
+        next->is_waiting.store(false, std::memory_order_release);
+    }
+
+    void lock() noexcept
+    {
+        node& n = _acquire_local_node();
+        lock(n);
+        _holder = &n;
+    }
+
+    bool try_lock() noexcept
+    {
+        node& n = _acquire_local_node();
+        if (!try_lock(n))
+        {
+            n.is_in_use = false;
+            return false;
+        }
+        _holder = &n;
+        return true;
+    }
+
+    void unlock() noexcept
+    {
+        // _holder is only accessed by the thread holding the lock
+        node* const n = _holder;
+        unlock(*n);
+        n->is_in_use = false;
+    }
+
+    mcs_lock() = default;
+    mcs_lock(mcs_lock const& other) = delete;
+    mcs_lock(mcs_lock&& other) noexcept = delete;
+    mcs_lock& operator=(mcs_lock const& other) = delete;
+    mcs_lock& operator=(mcs_lock&& other) noexcept = delete;
+
+private:
+    // locks can be released in any order, so the pool is scanned for a free node
+    static node& _acquire_local_node() noexcept
+    {
+        static thread_local node local_nodes[CC_MCS_LOCK_MAX_HELD];
+        for (auto& n : local_nodes)
+            if (!n.is_in_use)
+            {
+                n.is_in_use = true;
+                return n;
+            }
+
+        CC_UNREACHABLE("thread holds more than CC_MCS_LOCK_MAX_HELD mcs_locks");
+    }
+
+    std::atomic<node*> _tail = {nullptr};
+    node* _holder = nullptr;
+};
+}
@@ -0,0 +1,31 @@
+#include "mutex.hh"
+
+#include <clean-core/intrinsics.hh>
+#include <clean-core/native/futex.hh>
+
+// Ref: Drepper, "Futexes Are Tricky", mutex take 3
+void cc::mutex::_lock_contended() noexcept
+{
+    // spin while the holder is likely to release soon
+    for (auto i = 0; i < CC_MUTEX_SPIN_COUNT; ++i)
+    {
+        uint32_t const state = _state.load(std::memory_order_relaxed);
+        if (state == sc_unlocked)
+        {
+            uint32_t expected = sc_unlocked;
+            if (_state.compare_exchange_weak(expected, sc_locked, std::memory_order_acquire))
+                return;
+        }
+        else if (state == sc_locked_parked)
+            break; // others are already parked, spinning is unlikely to help
+
+        cc::intrin_pause();
+    }
+
+    // park: mark the mutex as contended, so the unlocking thread wakes us
+    // acquiring it from here on keeps the contended state as we cannot know whether other threads are still parked
+    while (_state.exchange(sc_locked_parked, std::memory_order_acquire) != sc_unlocked)
+        cc::futex_wait(&_state, sc_locked_parked);
+}
+
+void cc::mutex::_wake_one() noexcept { cc::futex_wake_one(&_state); }
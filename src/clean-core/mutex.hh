@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+
+#include <atomic>
+
+#include <clean-core/macros.hh>
+
+// amount of spin iterations before a contended lock() parks the thread
+#ifndef CC_MUTEX_SPIN_COUNT
+#define CC_MUTEX_SPIN_COUNT 128
+#endif
+
+namespace cc
+{
+// mutex that spins briefly, then parks the thread on a futex (see native/futex.hh)
+// uncontended lock and unlock are a single atomic operation each, unlock only wakes if somebody is parked
+// unlike spin_lock, waiting threads do not burn CPU time of the lock holder when there are more threads than cores
+// can be used as LockT / MutexT of the synced allocators
+struct mutex
+{
+    CC_FORCE_INLINE void lock() noexcept
+    {
+        uint32_t expected = sc_unlocked;
+        if (CC_UNLIKELY(!_state.compare_exchange_strong(expected, sc_locked, std::memory_order_acquire)))
+            _lock_contended();
+    }
+
+    CC_FORCE_INLINE bool try_lock() noexcept
+    {
+        uint32_t expected = sc_unlocked;
+        return _state.load(std::memory_order_relaxed) == sc_unlocked //
+               && _state.compare_exchange_strong(expected, sc_locked, std::memory_order_acquire);
+    }
+
+    CC_FORCE_INLINE void unlock() noexcept
+    {
+        if (CC_UNLIKELY(_state.exchange(sc_unlocked, std::memory_order_release) == sc_locked_parked))
+            _wake_one();
+    }
+
+    mutex() = default;
+    mutex(mutex const& other) = delete;
+    mutex(mutex&& other) noexcept = delete;
+    mutex& operator=(mutex const& other) = delete;
+    mutex& operator=(mutex&& other) noexcept = delete;
+
+private:
+    static constexpr uint32_t sc_unlocked = 0;
+    static constexpr uint32_t sc_locked = 1;
+    static constexpr uint32_t sc_locked_parked = 2; // locked, threads might be parked
+
+    void _lock_contended() noexcept;
+    void _wake_one() noexcept;
+
+    std::atomic<uint32_t> _state = {sc_unlocked};
+};
+}
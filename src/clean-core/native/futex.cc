@@ -0,0 +1,125 @@
+#include "futex.hh"
+
+#include <clean-core/assert.hh>
+#include <clean-core/macros.hh>
+
+#if defined(CC_OS_LINUX)
+
+#include <cerrno>
+#include <climits>
+#include <ctime>
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#elif defined(CC_OS_WINDOWS)
+
+#include <clean-core/native/win32_sanitized.hh>
+
+#pragma comment(lib, "Synchronization.lib")
+
+#else
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+#endif
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex words must be plain 32 bit integers");
+
+#if defined(CC_OS_LINUX)
+
+bool cc::futex_wait(std::atomic<uint32_t>* address, uint32_t expected, int64_t timeout_ns)
+{
+    ::timespec ts;
+    ::timespec* timeout = nullptr;
+    if (timeout_ns >= 0)
+    {
+        ts.tv_sec = time_t(timeout_ns / 1000000000LL);
+        ts.tv_nsec = long(timeout_ns % 1000000000LL);
+        timeout = &ts;
+    }
+
+    // FUTEX_WAIT returns immediately (EAGAIN) if the value is no longer expected
+    long const res = ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(address), FUTEX_WAIT_PRIVATE, expected, timeout, nullptr, 0);
+    return !(res == -1 && errno == ETIMEDOUT);
+}
+
+void cc::futex_wake_one(std::atomic<uint32_t>* address)
+{
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(address), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+}
+
+void cc::futex_wake_all(std::atomic<uint32_t>* address)
+{
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(address), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+}
+
+#elif defined(CC_OS_WINDOWS)
+
+bool cc::futex_wait(std::atomic<uint32_t>* address, uint32_t expected, int64_t timeout_ns)
+{
+    DWORD const timeout_ms = timeout_ns < 0 ? INFINITE : DWORD((timeout_ns + 999999) / 1000000);
+    if (!::WaitOnAddress(reinterpret_cast<volatile VOID*>(address), &expected, sizeof(uint32_t), timeout_ms))
+        return ::GetLastError() != ERROR_TIMEOUT;
+    return true;
+}
+
+void cc::futex_wake_one(std::atomic<uint32_t>* address) { ::WakeByAddressSingle(reinterpret_cast<PVOID>(address)); }
+
+void cc::futex_wake_all(std::atomic<uint32_t>* address) { ::WakeByAddressAll(reinterpret_cast<PVOID>(address)); }
+
+#else
+
+namespace
+{
+// waiters are spread over a fixed set of buckets by address
+// a wake notifies all waiters in the bucket, they re-check their own address
+struct futex_bucket
+{
+    std::mutex mutex;
+    std::condition_variable cv;
+};
+
+constexpr size_t futex_num_buckets = 64;
+futex_bucket g_futex_buckets[futex_num_buckets];
+
+futex_bucket& futex_get_bucket(void const* address) { return g_futex_buckets[(reinterpret_cast<uintptr_t>(address) >> 4) % futex_num_buckets]; }
+}
+
+bool cc::futex_wait(std::atomic<uint32_t>* address, uint32_t expected, int64_t timeout_ns)
+{
+    auto& bucket = futex_get_bucket(address);
+    std::unique_lock<std::mutex> lock(bucket.mutex);
+
+    if (address->load(std::memory_order_relaxed) != expected)
+        return true;
+
+    if (timeout_ns < 0)
+    {
+        bucket.cv.wait(lock);
+        return true;
+    }
+
+    return bucket.cv.wait_for(lock, std::chrono::nanoseconds(timeout_ns)) == std::cv_status::no_timeout;
+}
+
+void cc::futex_wake_one(std::atomic<uint32_t>* address)
+{
+    // the bucket is shared, waking a single thread could wake the wrong one
+    futex_wake_all(address);
+}
+
+void cc::futex_wake_all(std::atomic<uint32_t>* address)
+{
+    auto& bucket = futex_get_bucket(address);
+    {
+        // pairs with the check under the lock in futex_wait
+        std::lock_guard<std::mutex> lg(bucket.mutex);
+    }
+    bucket.cv.notify_all();
+}
+
+#endif
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+
+#include <atomic>
+
+namespace cc
+{
+// blocks the calling thread while *address == expected, until it is woken via futex_wake_* or the timeout passes
+// returns false if the timeout passed, true otherwise (woken, value changed, or spuriously)
+// timeout_ns < 0 waits indefinitely
+// NOTE: can wake up spuriously, callers must check their condition in a loop
+// Linux: futex, Win32: WaitOnAddress, otherwise: condition variables in a global hash table
+bool futex_wait(std::atomic<uint32_t>* address, uint32_t expected, int64_t timeout_ns = -1);
+
+// wakes one / all threads blocked in futex_wait on this address
+// NOTE: always a syscall, callers should only wake if they know about waiters (e.g. via a separate waiter count)
+void futex_wake_one(std::atomic<uint32_t>* address);
+void futex_wake_all(std::atomic<uint32_t>* address);
+}
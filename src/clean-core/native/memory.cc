@@ -109,19 +109,28 @@ void cc::commit_physical_memory(std::byte* ptr, size_t size)
 
 void cc::decommit_physical_memory(std::byte* ptr, size_t size)
 {
+    // only whole pages inside the range can be decommitted, partial pages at the ends can still hold live data
+    auto new_ptr = cc::align_up(ptr, 4096);
+    auto new_end = cc::align_down(ptr + size, 4096);
+    if (new_end <= new_ptr)
+        return;
+
 #ifdef CC_OS_WINDOWS
 
-    auto const res = VirtualFree(ptr, size, MEM_DECOMMIT);
+    auto const res = VirtualFree(new_ptr, size_t(new_end - new_ptr), MEM_DECOMMIT);
     CC_ASSERT(!!res && "virtual decommit failed");
 
 #elif defined(CC_OS_LINUX)|| defined(CC_OS_APPLE)
 
-    // ensure ptr and size are page-aligned
-    auto new_ptr = cc::align_down(ptr, 4096);
-    auto new_size = cc::align_up(size + (ptr - new_ptr), 4096);
+    // PROT_NONE alone keeps the pages resident
+#ifdef CC_OS_LINUX
+    int const advise_res = ::madvise(new_ptr, size_t(new_end - new_ptr), MADV_DONTNEED);
+#else
+    int const advise_res = ::madvise(new_ptr, size_t(new_end - new_ptr), MADV_FREE);
+#endif
+    CC_ASSERT(advise_res == 0 && "virtual decommit failed");
 
-    // TODO: not sure if this actually decommits memory
-    int const res = ::mprotect(new_ptr, new_size, PROT_NONE);
+    int const res = ::mprotect(new_ptr, size_t(new_end - new_ptr), PROT_NONE);
     CC_ASSERT(res == 0 && "virtual decommit failed");
 
 #else
@@ -129,6 +138,69 @@ void cc::decommit_physical_memory(std::byte* ptr, size_t size)
 #endif
 }
 
+void cc::purge_physical_memory(std::byte* ptr, size_t size)
+{
+#ifdef CC_OS_WINDOWS
+
+    void* res = VirtualAlloc(ptr, size, MEM_RESET, PAGE_READWRITE);
+    CC_ASSERT(res != nullptr && "virtual purge failed");
+
+#elif defined(CC_OS_LINUX) || defined(CC_OS_APPLE)
+
+    // only whole pages inside the range can be purged
+    auto new_ptr = cc::align_up(ptr, 4096);
+    auto new_end = cc::align_down(ptr + size, 4096);
+    if (new_end <= new_ptr)
+        return;
+
+#ifdef MADV_FREE
+    int res = ::madvise(new_ptr, size_t(new_end - new_ptr), MADV_FREE);
+    if (res != 0) // kernels before 4.5
+        res = ::madvise(new_ptr, size_t(new_end - new_ptr), MADV_DONTNEED);
+#else
+    int const res = ::madvise(new_ptr, size_t(new_end - new_ptr), MADV_DONTNEED);
+#endif
+    CC_ASSERT(res == 0 && "virtual purge failed");
+
+#else
+    static_assert(false, "unsupported platform");
+#endif
+}
+
+size_t cc::virtual_trim_state::advance(virtual_trim_policy const& policy, size_t period_peak_bytes)
+{
+    CC_ASSERT(policy.window > 0 && policy.headroom >= 0.f && "invalid trim policy");
+
+    current_window_peak = cc::max(current_window_peak, period_peak_bytes);
+    size_t const peak = get_peak();
+
+    if (++num_trims_in_window >= policy.window)
+    {
+        // peaks older than two windows are forgotten
+        previous_window_peak = current_window_peak;
+        current_window_peak = 0;
+        num_trims_in_window = 0;
+    }
+
+    return peak + size_t(double(peak) * policy.headroom);
+}
+
+std::byte* cc::trim_physical_memory(std::byte* virtual_begin, std::byte* physical_current, std::byte* physical_end, size_t chunk_size, size_t keep_size_bytes, bool lazy)
+{
+    std::byte* const keep_end = virtual_begin + cc::min(keep_size_bytes, size_t(physical_end - virtual_begin));
+    std::byte* const new_end = cc::align_up(cc::max(keep_end, physical_current), chunk_size);
+
+    if (new_end >= physical_end)
+        return physical_end;
+
+    if (lazy)
+        purge_physical_memory(new_end, size_t(physical_end - new_end));
+    else
+        decommit_physical_memory(new_end, size_t(physical_end - new_end));
+
+    return new_end;
+}
+
 std::byte* cc::grow_physical_memory(std::byte* physical_current, std::byte* physical_end, std::byte* virtual_end, size_t chunk_size, size_t grow_num_bytes)
 {
     if (physical_current + grow_num_bytes <= physical_end)
@@ -21,12 +21,54 @@ void commit_physical_memory(std::byte* ptr, size_t size_bytes);
 void prefault_memory(std::byte* ptr, size_t size_bytes);
 
 // decommits a region of pages inside a reserved, virtual memory range
+// only pages entirely inside the region are decommitted, the content of the others is kept
 void decommit_physical_memory(std::byte* ptr, size_t size_bytes);
 
+// returns the physical memory of a committed region to the OS lazily, its content becomes undefined
+// the pages stay accessible and are only reclaimed when the OS needs the memory (in the background)
+// the region counts as decommitted, committing it again is cheap and does not fault for pages that were not reclaimed yet
+// Linux / Apple: MADV_FREE, Win32: MEM_RESET
+void purge_physical_memory(std::byte* ptr, size_t size_bytes);
+
 // commits new region of pages in multiples of a given chunk size
 // checks if virtual_end is exceeded, returns the new physical end ptr
 std::byte* grow_physical_memory(std::byte* physical_current, std::byte* physical_end, std::byte* virtual_end, size_t chunk_size, size_t grow_num_bytes);
 
+// policy for trimming the committed memory of virtual allocators (see e.g. virtual_linear_allocator::trim)
+// memory is only returned once it exceeded the recent usage peaks for a while,
+// which keeps the footprint tight without commit / decommit thrashing for fluctuating usage
+struct virtual_trim_policy
+{
+    // usage peaks are remembered for between window and 2 * window calls to trim()
+    uint32_t window = 8;
+
+    // memory kept committed on top of the remembered peak, relative to it
+    float headroom = 0.25f;
+
+    // purge instead of decommit (see purge_physical_memory)
+    // pages are reclaimed by the OS in the background and reusing them does not fault until then
+    // NOTE: purged pages still count towards the resident set size until they are reclaimed
+    bool lazy = false;
+};
+
+// recent usage peaks of a virtual allocator, in bytes
+struct virtual_trim_state
+{
+    size_t current_window_peak = 0;
+    size_t previous_window_peak = 0;
+    uint32_t num_trims_in_window = 0;
+
+    size_t get_peak() const { return cc::max(current_window_peak, previous_window_peak); }
+
+    // ends a trim period during which usage peaked at the given amount
+    // returns the amount of bytes that should stay committed
+    size_t advance(virtual_trim_policy const& policy, size_t period_peak_bytes);
+};
+
+// decommits (or purges) the committed memory past the given size, but never below physical_current
+// keeps multiples of the chunk size committed, returns the new physical end ptr
+std::byte* trim_physical_memory(std::byte* virtual_begin, std::byte* physical_current, std::byte* physical_end, size_t chunk_size, size_t keep_size_bytes, bool lazy);
+
 // header for an allocation in a stack-like allocator
 struct stack_alloc_header
 {
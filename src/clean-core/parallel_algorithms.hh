@@ -0,0 +1,257 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring> // std::memcpy
+
+#include <type_traits>
+
+#include <clean-core/assert.hh>
+#include <clean-core/executor.hh>
+#include <clean-core/invoke.hh>
+#include <clean-core/macros.hh>
+#include <clean-core/move.hh>
+#include <clean-core/span.hh>
+#include <clean-core/strided_span.hh>
+#include <clean-core/utility.hh>
+#include <clean-core/vector.hh>
+
+// minimum amount of elements per chunk with automatic grain sizing
+// smaller ranges run sequentially on the calling thread
+#ifndef CC_PARALLEL_MIN_GRAIN
+#define CC_PARALLEL_MIN_GRAIN 8192
+#endif
+
+// amount of chunks per thread with automatic grain sizing
+// more chunks balance uneven work better, fewer chunks have less overhead
+#ifndef CC_PARALLEL_CHUNKS_PER_THREAD
+#define CC_PARALLEL_CHUNKS_PER_THREAD 4
+#endif
+
+namespace cc
+{
+/// parallel versions of the basic range algorithms
+/// work on contiguous ranges (span, vector, array, C arrays, ...) and strided_spans
+///
+/// the range is split into chunks of "grain" elements which are run by an executor (see executor.hh)
+///   grain == 0 picks a grain size automatically (at least CC_PARALLEL_MIN_GRAIN elements)
+///   ex == nullptr uses cc::get_default_executor()
+/// ranges with only a single chunk and single-threaded executors run directly on the calling thread
+///
+/// Usage:
+///
+///   cc::task_scheduler scheduler;
+///   scheduler.initialize();
+///   cc::set_default_executor(&scheduler);
+///
+///   cc::parallel_for(particles, 0, [&](particle& p) { p.pos += p.vel * dt; });
+///   auto const energy = cc::parallel_reduce(energies, 0.0, [](double a, double b) { return a + b; });
+///
+/// NOTE: the functions are called concurrently and in no particular order
+///       the chunks of a given range, grain and executor are always the same,
+///       so parallel_reduce is deterministic as long as the amount of threads does not change
+
+/// calls fn(e) for each element e of the range
+template <class Range, class F>
+void parallel_for(Range&& range, size_t grain, F&& fn, executor* ex = nullptr);
+
+/// combines all elements with op, starting each chunk with init
+/// the results of the chunks are then combined with op in order
+/// @param op : (T const& a, Element const& e) -> T and (T const& a, T const& b) -> T, must be associative
+/// @param init : identity of op (e.g. 0 for addition), can be used more than once!
+template <class Range, class T, class ReduceF>
+[[nodiscard]] T parallel_reduce(Range&& range, T init, ReduceF&& op, size_t grain = 0, executor* ex = nullptr);
+
+/// to[i] = fn(from[i]), to must be at least as large as from
+template <class RangeFrom, class RangeTo, class F>
+void parallel_transform(RangeFrom&& from, RangeTo&& to, F&& fn, size_t grain = 0, executor* ex = nullptr);
+
+/// sets all elements of the range to value
+template <class Range, class T>
+void parallel_fill(Range&& range, T const& value, size_t grain = 0, executor* ex = nullptr);
+
+/// to[i] = from[i], to must be at least as large as from
+/// uses memcpy per chunk for contiguous ranges of trivially copyable types
+template <class RangeFrom, class RangeTo>
+void parallel_copy(RangeFrom&& from, RangeTo&& to, size_t grain = 0, executor* ex = nullptr);
+
+//
+// Implementation
+//
+
+namespace detail
+{
+template <class T>
+struct is_strided_span_t : std::false_type
+{
+};
+template <class T>
+struct is_strided_span_t<cc::strided_span<T>> : std::true_type
+{
+};
+
+// span or strided_span of the range
+template <class Range>
+auto parallel_view(Range&& range)
+{
+    if constexpr (is_strided_span_t<std::decay_t<Range>>::value)
+        return range;
+    else
+    {
+        static_assert(cc::is_any_contiguous_range<Range>, "parallel algorithms require a contiguous range or a strided_span");
+        return cc::span(range);
+    }
+}
+
+// element access without range checks, the chunk bounds are checked once
+template <class T>
+CC_FORCE_INLINE T& parallel_at(cc::span<T> const& s, size_t i)
+{
+    return s.data()[i];
+}
+template <class T>
+CC_FORCE_INLINE T& parallel_at(cc::strided_span<T> const& s, size_t i)
+{
+    return *reinterpret_cast<T*>(s.data_ptr() + int64_t(i) * int64_t(s.stride()));
+}
+
+struct parallel_plan
+{
+    executor* ex;
+    size_t size;
+    size_t grain;
+    size_t num_chunks;
+};
+
+inline parallel_plan make_parallel_plan(size_t size, size_t grain, executor* ex)
+{
+    if (ex == nullptr)
+        ex = cc::get_default_executor();
+
+    size_t const num_threads = ex->get_num_threads();
+
+    if (grain == 0)
+    {
+        size_t const target_chunks = num_threads * CC_PARALLEL_CHUNKS_PER_THREAD;
+        grain = cc::max<size_t>(CC_PARALLEL_MIN_GRAIN, (size + target_chunks - 1) / target_chunks);
+    }
+
+    // sequential fallback
+    if (num_threads <= 1 || size <= grain)
+        return {ex, size, size, size > 0 ? size_t(1) : size_t(0)};
+
+    return {ex, size, grain, (size + grain - 1) / grain};
+}
+
+// calls body(chunk_idx, begin, end) for each chunk
+template <class BodyF>
+void run_parallel_plan(parallel_plan const& plan, BodyF&& body)
+{
+    if (plan.num_chunks == 0)
+        return;
+
+    if (plan.num_chunks == 1)
+    {
+        body(size_t(0), size_t(0), plan.size);
+        return;
+    }
+
+    plan.ex->run_chunks(plan.num_chunks, [&](size_t chunk) {
+        size_t const begin = chunk * plan.grain;
+        size_t const end = cc::min(begin + plan.grain, plan.size);
+        body(chunk, begin, end);
+    });
+}
+}
+
+template <class Range, class F>
+void parallel_for(Range&& range, size_t grain, F&& fn, executor* ex)
+{
+    auto const view = detail::parallel_view(range);
+
+    detail::run_parallel_plan(detail::make_parallel_plan(view.size(), grain, ex), [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            cc::invoke(fn, detail::parallel_at(view, i));
+    });
+}
+
+template <class Range, class T, class ReduceF>
+T parallel_reduce(Range&& range, T init, ReduceF&& op, size_t grain, executor* ex)
+{
+    auto const view = detail::parallel_view(range);
+    auto const plan = detail::make_parallel_plan(view.size(), grain, ex);
+
+    if (plan.num_chunks <= 1)
+    {
+        for (size_t i = 0; i < view.size(); ++i)
+            init = cc::invoke(op, cc::move(init), detail::parallel_at(view, i));
+        return init;
+    }
+
+    auto partials = cc::vector<T>::filled(plan.num_chunks, init);
+
+    detail::run_parallel_plan(plan, [&](size_t chunk, size_t begin, size_t end) {
+        T acc = init;
+        for (size_t i = begin; i < end; ++i)
+            acc = cc::invoke(op, cc::move(acc), detail::parallel_at(view, i));
+        partials[chunk] = cc::move(acc);
+    });
+
+    T result = cc::move(partials[0]);
+    for (size_t i = 1; i < partials.size(); ++i)
+        result = cc::invoke(op, cc::move(result), partials[i]);
+    return result;
+}
+
+template <class RangeFrom, class RangeTo, class F>
+void parallel_transform(RangeFrom&& from, RangeTo&& to, F&& fn, size_t grain, executor* ex)
+{
+    auto const from_view = detail::parallel_view(from);
+    auto const to_view = detail::parallel_view(to);
+    CC_CONTRACT(to_view.size() >= from_view.size());
+
+    detail::run_parallel_plan(detail::make_parallel_plan(from_view.size(), grain, ex), [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            detail::parallel_at(to_view, i) = cc::invoke(fn, detail::parallel_at(from_view, i));
+    });
+}
+
+template <class Range, class T>
+void parallel_fill(Range&& range, T const& value, size_t grain, executor* ex)
+{
+    auto const view = detail::parallel_view(range);
+
+    detail::run_parallel_plan(detail::make_parallel_plan(view.size(), grain, ex), [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            detail::parallel_at(view, i) = value;
+    });
+}
+
+template <class RangeFrom, class RangeTo>
+void parallel_copy(RangeFrom&& from, RangeTo&& to, size_t grain, executor* ex)
+{
+    auto const from_view = detail::parallel_view(from);
+    auto const to_view = detail::parallel_view(to);
+    CC_CONTRACT(to_view.size() >= from_view.size());
+
+    using from_view_t = std::decay_t<decltype(from_view)>;
+    using to_view_t = std::decay_t<decltype(to_view)>;
+    using from_elem_t = std::remove_const_t<std::remove_reference_t<decltype(detail::parallel_at(from_view, 0))>>;
+    using to_elem_t = std::remove_reference_t<decltype(detail::parallel_at(to_view, 0))>;
+
+    constexpr bool is_memcpyable = !detail::is_strided_span_t<from_view_t>::value && !detail::is_strided_span_t<to_view_t>::value
+                                   && std::is_same_v<from_elem_t, to_elem_t> && std::is_trivially_copyable_v<to_elem_t>;
+
+    detail::run_parallel_plan(detail::make_parallel_plan(from_view.size(), grain, ex), [&](size_t, size_t begin, size_t end) {
+        if constexpr (is_memcpyable)
+        {
+            if (end > begin)
+                std::memcpy(to_view.data() + begin, from_view.data() + begin, (end - begin) * sizeof(to_elem_t));
+        }
+        else
+        {
+            for (size_t i = begin; i < end; ++i)
+                detail::parallel_at(to_view, i) = detail::parallel_at(from_view, i);
+        }
+    });
+}
+}
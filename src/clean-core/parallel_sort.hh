@@ -0,0 +1,311 @@
+#pragma once
+
+#include <cstdint>
+
+#include <clean-core/assert.hh>
+#include <clean-core/collection_traits.hh>
+#include <clean-core/executor.hh>
+#include <clean-core/functors.hh>
+#include <clean-core/invoke.hh>
+#include <clean-core/less.hh>
+#include <clean-core/sort.hh>
+#include <clean-core/utility.hh>
+#include <clean-core/vector.hh>
+
+// ranges up to this size are sorted sequentially with sort_ex
+// larger ranges are partitioned in parallel and both sides are sorted as parallel tasks
+#ifndef CC_PARALLEL_SORT_THRESHOLD
+#define CC_PARALLEL_SORT_THRESHOLD 65536
+#endif
+
+namespace cc
+{
+/// parallel versions of sort, sort_by and sort_multi (see sort.hh)
+/// same comparator and key function API, the chunks are run by an executor (see executor.hh)
+///   ex == nullptr uses cc::get_default_executor()
+///   (the sort_multi variants always use the default executor)
+///
+/// above CC_PARALLEL_SORT_THRESHOLD elements, the pivot is selected as in sort_ex,
+/// the range is partitioned in parallel blocks and both sides are recursed into as parallel tasks
+/// below it (or with a single-threaded executor), the range is sorted with sort_ex
+///
+/// Usage:
+///
+///   cc::task_scheduler scheduler;
+///   scheduler.initialize();
+///
+///   cc::parallel_sort(values, cc::less<>{}, &scheduler);
+///   cc::parallel_sort_by(entities, [](entity const& e) { return e.depth; }, cc::less<>{}, &scheduler);
+///
+/// NOTE: is deterministic for a given amount of threads, but not stable
+///       get, compare and swap are called concurrently (for disjoint indices)
+template <class GetF, class CompareF, class SwapF>
+void parallel_sort_ex(int64_t start, size_t size, GetF&& get, CompareF&& compare, SwapF&& swap, executor* ex = nullptr);
+
+template <class IndexedRange, class CompareF = cc::less<void>>
+void parallel_sort(IndexedRange&& values, CompareF&& compare = {}, executor* ex = nullptr);
+template <class IndexedRange, class KeyF, class CompareF = cc::less<void>>
+void parallel_sort_by(IndexedRange&& values, KeyF&& key, CompareF&& compare = {}, executor* ex = nullptr);
+template <class IndexedRange>
+void parallel_sort_descending(IndexedRange&& values, executor* ex = nullptr);
+template <class IndexedRange, class KeyF>
+void parallel_sort_by_descending(IndexedRange&& values, KeyF&& key, executor* ex = nullptr);
+
+template <class CompareF, class IndexedKeyRange, class... IndexedRanges>
+void parallel_sort_multi(CompareF&& compare, IndexedKeyRange&& keys, IndexedRanges&&... values);
+template <class KeyF, class CompareF, class... IndexedRanges>
+void parallel_sort_multi_by(KeyF&& key, CompareF&& compare, IndexedRanges&&... values);
+
+//
+// Implementation
+//
+
+namespace detail
+{
+// a range of misplaced elements after the block-wise partitioning
+struct parallel_sort_interval
+{
+    int64_t begin;
+    int64_t end;
+};
+
+// iterates the positions of a list of non-empty intervals, starting at the k-th position
+struct parallel_sort_interval_cursor
+{
+    parallel_sort_interval const* intervals;
+    size_t num_intervals;
+    size_t idx = 0;
+    int64_t pos = 0;
+
+    parallel_sort_interval_cursor(cc::vector<parallel_sort_interval> const& v, int64_t k) : intervals(v.data()), num_intervals(v.size())
+    {
+        while (k >= intervals[idx].end - intervals[idx].begin)
+        {
+            k -= intervals[idx].end - intervals[idx].begin;
+            ++idx;
+        }
+        pos = intervals[idx].begin + k;
+    }
+
+    int64_t next()
+    {
+        int64_t const res = pos;
+        if (++pos == intervals[idx].end && ++idx < num_intervals)
+            pos = intervals[idx].begin;
+        return res;
+    }
+};
+
+// same result as partition_ex, but in parallel:
+// the blocks are partitioned independently, then the right elements before the split
+// are swapped with the left elements after it
+template <class IsRightF, class SwapF>
+int64_t parallel_partition_ex(int64_t start, int64_t size, IsRightF& is_right, SwapF& swap, executor* ex, size_t num_blocks)
+{
+    int64_t const end = start + size;
+    int64_t const block_size = (size + int64_t(num_blocks) - 1) / int64_t(num_blocks);
+    num_blocks = size_t((size + block_size - 1) / block_size);
+
+    auto block_splits = cc::vector<int64_t>::filled(num_blocks, 0);
+    ex->run_chunks(num_blocks, [&](size_t b) {
+        int64_t const b_start = start + int64_t(b) * block_size;
+        int64_t const b_size = cc::min(block_size, end - b_start);
+        block_splits[b] = cc::partition_ex(b_start, size_t(b_size), is_right, swap);
+    });
+
+    int64_t split = start;
+    for (size_t b = 0; b < num_blocks; ++b)
+        split += block_splits[b] - (start + int64_t(b) * block_size);
+
+    cc::vector<parallel_sort_interval> misplaced_right; // right elements before the split
+    cc::vector<parallel_sort_interval> misplaced_left;  // left elements after the split
+    int64_t num_misplaced = 0;
+    int64_t num_misplaced_left = 0;
+    for (size_t b = 0; b < num_blocks; ++b)
+    {
+        int64_t const b_start = start + int64_t(b) * block_size;
+        int64_t const b_end = cc::min(b_start + block_size, end);
+        int64_t const b_split = block_splits[b];
+
+        int64_t const r_end = cc::min(b_end, split);
+        if (b_split < r_end)
+        {
+            misplaced_right.push_back({b_split, r_end});
+            num_misplaced += r_end - b_split;
+        }
+
+        int64_t const l_begin = cc::max(b_start, split);
+        if (l_begin < b_split)
+        {
+            misplaced_left.push_back({l_begin, b_split});
+            num_misplaced_left += b_split - l_begin;
+        }
+    }
+    CC_ASSERT(num_misplaced == num_misplaced_left);
+
+    if (num_misplaced == 0)
+        return split;
+
+    int64_t const num_swap_chunks = cc::min(int64_t(num_blocks), 1 + num_misplaced / CC_PARALLEL_SORT_THRESHOLD);
+    ex->run_chunks(size_t(num_swap_chunks), [&](size_t c) {
+        int64_t const k_begin = num_misplaced * int64_t(c) / num_swap_chunks;
+        int64_t const k_end = num_misplaced * int64_t(c + 1) / num_swap_chunks;
+        if (k_begin == k_end)
+            return;
+
+        parallel_sort_interval_cursor right(misplaced_right, k_begin);
+        parallel_sort_interval_cursor left(misplaced_left, k_begin);
+        for (int64_t k = k_begin; k < k_end; ++k)
+            cc::invoke(swap, right.next(), left.next());
+    });
+
+    return split;
+}
+
+// same recursion as sort_ex_impl, but partitions in parallel and runs both sides as parallel tasks
+template <class GetF, class CompareF, class SwapF>
+void parallel_sort_impl(int64_t start, int64_t size, GetF& get, CompareF& compare, SwapF& swap, executor* ex, size_t num_threads, bool leftmost)
+{
+    if (size <= CC_PARALLEL_SORT_THRESHOLD)
+    {
+        cc::constant_function<true> select;
+        detail::sort_ex_impl(start, size, get, compare, swap, select, leftmost);
+        return;
+    }
+
+    detail::select_pivot(start, size, get, compare, swap);
+    // NOTE: pivot is now at start
+
+    int64_t const end = start + size;
+    size_t const num_blocks = cc::min(num_threads, size_t(size / CC_PARALLEL_SORT_THRESHOLD));
+
+    // pivot is equal to the previous pivot: all elements equal to it are moved left and are done
+    if (!leftmost && !cc::invoke(compare, cc::invoke(get, start - 1), cc::invoke(get, start)))
+    {
+        int64_t pivot_pos;
+        if (num_blocks <= 1)
+            pivot_pos = detail::partition_left(start, size, get, compare, swap);
+        else
+        {
+            auto&& pivot = cc::invoke(get, start);
+            auto is_right = [&](int64_t i) { return cc::invoke(compare, pivot, cc::invoke(get, i)); };
+            pivot_pos = detail::parallel_partition_ex(start + 1, size - 1, is_right, swap, ex, num_blocks) - 1;
+            if (pivot_pos != start)
+                cc::invoke(swap, start, pivot_pos);
+        }
+
+        detail::parallel_sort_impl(pivot_pos + 1, end - (pivot_pos + 1), get, compare, swap, ex, num_threads, false);
+        return;
+    }
+
+    // partition range, equal elements go to the right
+    int64_t pivot_pos;
+    if (num_blocks <= 1)
+    {
+        bool was_already_partitioned = false;
+        pivot_pos = detail::partition_right(was_already_partitioned, start, size, get, compare, swap);
+    }
+    else
+    {
+        auto&& pivot = cc::invoke(get, start);
+        auto is_right = [&](int64_t i) { return !cc::invoke(compare, cc::invoke(get, i), pivot); };
+        pivot_pos = detail::parallel_partition_ex(start + 1, size - 1, is_right, swap, ex, num_blocks) - 1;
+
+        // move pivot to correct pos
+        if (pivot_pos != start)
+            cc::invoke(swap, start, pivot_pos);
+    }
+
+    int64_t const size_left = pivot_pos - start;
+    int64_t const start_right = pivot_pos + 1;
+    int64_t const size_right = end - start_right;
+
+    ex->run_chunks(2, [&](size_t side) {
+        if (side == 0)
+            detail::parallel_sort_impl(start, size_left, get, compare, swap, ex, num_threads, leftmost);
+        else
+            detail::parallel_sort_impl(start_right, size_right, get, compare, swap, ex, num_threads, false);
+    });
+}
+}
+
+template <class GetF, class CompareF, class SwapF>
+void parallel_sort_ex(int64_t start, size_t size, GetF&& get, CompareF&& compare, SwapF&& swap, executor* ex)
+{
+    if (ex == nullptr)
+        ex = cc::get_default_executor();
+
+    size_t const num_threads = ex->get_num_threads();
+    if (num_threads <= 1 || size <= CC_PARALLEL_SORT_THRESHOLD)
+    {
+        cc::sort_ex(start, size, get, compare, swap, cc::constant_function<true>{});
+        return;
+    }
+
+    detail::parallel_sort_impl(start, int64_t(size), get, compare, swap, ex, num_threads, true);
+}
+
+template <class IndexedRange, class CompareF>
+void parallel_sort(IndexedRange&& values, CompareF&& compare, executor* ex)
+{
+    static_assert(cc::is_indexed_range<IndexedRange>);
+    size_t size = cc::collection_size(values);
+    cc::parallel_sort_ex(0, size,                                      //
+                         detail::values_access<IndexedRange&>{values}, //
+                         compare,                                      //
+                         detail::values_swap<IndexedRange&>{values},   //
+                         ex);
+}
+template <class IndexedRange, class KeyF, class CompareF>
+void parallel_sort_by(IndexedRange&& values, KeyF&& key, CompareF&& compare, executor* ex)
+{
+    static_assert(cc::is_indexed_range<IndexedRange>);
+    size_t size = cc::collection_size(values);
+    cc::parallel_sort_ex(0, size,                                                      //
+                         detail::values_key_access<IndexedRange&, KeyF&>{values, key}, //
+                         compare,                                                      //
+                         detail::values_swap<IndexedRange&>{values},                   //
+                         ex);
+}
+template <class IndexedRange>
+void parallel_sort_descending(IndexedRange&& values, executor* ex)
+{
+    cc::parallel_sort(values, cc::greater<void>{}, ex);
+}
+template <class IndexedRange, class KeyF>
+void parallel_sort_by_descending(IndexedRange&& values, KeyF&& key, executor* ex)
+{
+    cc::parallel_sort_by(values, key, cc::greater<void>{}, ex);
+}
+
+template <class CompareF, class IndexedKeyRange, class... IndexedRanges>
+void parallel_sort_multi(CompareF&& compare, IndexedKeyRange&& keys, IndexedRanges&&... values)
+{
+    static_assert(collection_traits<IndexedKeyRange>::is_range);
+    static_assert((collection_traits<IndexedRanges>::is_range && ...));
+    size_t size = cc::collection_size(keys);
+    CC_ASSERT(((cc::collection_size(values) == size) && ...) && "values must have the same size");
+    cc::parallel_sort_ex(
+        0, size,                                       //
+        detail::values_access<IndexedKeyRange&>{keys}, //
+        compare,                                       //
+        [&](int64_t a, int64_t b)
+        {
+            cc::swap(keys[a], keys[b]);
+            (cc::swap(values[a], values[b]), ...);
+        });
+}
+template <class KeyF, class CompareF, class... IndexedRanges>
+void parallel_sort_multi_by(KeyF&& key, CompareF&& compare, IndexedRanges&&... values)
+{
+    static_assert(sizeof...(values) >= 1, "must sort at least one values");
+    static_assert((collection_traits<IndexedRanges>::is_range && ...));
+    size_t size = (cc::collection_size(values), ...);
+    CC_ASSERT(((cc::collection_size(values) == size) && ...) && "values must have the same size");
+    cc::parallel_sort_ex(
+        0, size,                                                             //
+        [&](int64_t i) { return key(values[i]...); },                        //
+        compare,                                                             //
+        [&](int64_t a, int64_t b) { (cc::swap(values[a], values[b]), ...); });
+}
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+
+#include <atomic>
+
+#include <clean-core/intrinsics.hh>
+#include <clean-core/macros.hh>
+
+namespace cc
+{
+// reader-writer spinlock: any number of readers or a single writer
+// writer preference: a waiting writer blocks new readers, so a steady stream of readers cannot starve it
+//
+// lock() / unlock() are exclusive (usable with cc::lock_guard)
+// lock_shared() / unlock_shared() are shared (usable with cc::shared_lock_guard)
+// NOTE: readers still write the lock's cache line, for tiny read-mostly snapshots see cc::seqlock
+struct rw_spin_lock
+{
+    CC_FORCE_INLINE void lock() noexcept
+    {
+        while (true)
+        {
+            uint32_t state = _state.load(std::memory_order_relaxed);
+            if ((state & ~sc_writer_waiting) == 0)
+            {
+                // free (maybe with other writers waiting, they re-announce themselves)
+                if (_state.compare_exchange_weak(state, sc_writer_locked, std::memory_order_acquire, std::memory_order_relaxed))
+                    return;
+                continue;
+            }
+
+            // announce, blocks new readers
+            if ((state & sc_writer_waiting) == 0)
+                _state.fetch_or(sc_writer_waiting, std::memory_order_relaxed);
+
+            cc::intrin_pause();
+        }
+    }
+
+    CC_FORCE_INLINE bool try_lock() noexcept
+    {
+        uint32_t state = _state.load(std::memory_order_relaxed);
+        return (state & ~sc_writer_waiting) == 0 //
+               && _state.compare_exchange_strong(state, sc_writer_locked, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    CC_FORCE_INLINE void unlock() noexcept
+    {
+        // keeps the waiting bit of other writers
+        _state.fetch_and(~sc_writer_locked, std::memory_order_release);
+    }
+
+    CC_FORCE_INLINE void lock_shared() noexcept
+    {
+        while (!try_lock_shared())
+            cc::intrin_pause();
+    }
+
+    CC_FORCE_INLINE bool try_lock_shared() noexcept
+    {
+        uint32_t state = _state.load(std::memory_order_relaxed);
+        while ((state & (sc_writer_locked | sc_writer_waiting)) == 0)
+        {
+            if (_state.compare_exchange_weak(state, state + 1, std::memory_order_acquire, std::memory_order_relaxed))
+                return true;
+        }
+        return false;
+    }
+
+    CC_FORCE_INLINE void unlock_shared() noexcept { _state.fetch_sub(1, std::memory_order_release); }
+
+    rw_spin_lock() = default;
+    rw_spin_lock(rw_spin_lock const& other) = delete;
+    rw_spin_lock(rw_spin_lock&& other) noexcept = delete;
+    rw_spin_lock& operator=(rw_spin_lock const& other) = delete;
+    rw_spin_lock& operator=(rw_spin_lock&& other) noexcept = delete;
+
+private:
+    // lower bits: amount of readers
+    static constexpr uint32_t sc_writer_locked = 1u << 31;
+    static constexpr uint32_t sc_writer_waiting = 1u << 30;
+
+    std::atomic<uint32_t> _state = {0};
+};
+}
@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <cstring>
 
+#include <clean-core/allocator.hh>
 #include <clean-core/assert.hh>
 #include <clean-core/fwd.hh>
 #include <clean-core/hash_combine.hh>
@@ -18,6 +19,13 @@ namespace cc
  *       https://stackoverflow.com/questions/27631065/why-does-libcs-implementation-of-stdstring-take-up-3x-memory-as-libstdc/28003328#28003328
  *       https://stackoverflow.com/questions/10315041/meaning-of-acronym-sso-in-the-context-of-stdstring/10319672#10319672
  *       maybe via template arg the sbo capacity?
+ *
+ * Allocators:
+ * - by default, heap memory is allocated via new[] / delete[]
+ * - optionally, a cc::allocator can be passed that provides the memory (e.g. a per-request arena)
+ *   such strings store the allocator in front of their heap buffer and never use the small buffer
+ *   (so sizeof(sbo_string) is unchanged)
+ * - copies and moves propagate the allocator
  */
 template <size_t sbo_capacity>
 struct sbo_string
@@ -35,7 +43,10 @@ public:
     char const* end() const { return _data + _size; }
 
     size_t size() const { return _size; }
-    size_t capacity() const { return _is_short() ? sbo_capacity : _capacity; }
+    size_t capacity() const { return _is_short() ? sbo_capacity : _capacity & ~_allocator_bit; }
+
+    /// the allocator of the heap buffer, nullptr for the default (new[] / delete[])
+    cc::allocator* allocator() const { return _get_allocator(); }
 
     bool empty() const { return _size == 0; }
 
@@ -120,18 +131,42 @@ public:
     }
     sbo_string(string_view s) : sbo_string(s.data(), s.size()) {}
 
-    [[nodiscard]] static sbo_string uninitialized(size_t size)
+    /// creates an empty string that allocates its memory from the given allocator
+    /// NOTE: the initial capacity (at least sbo_capacity) is allocated immediately
+    explicit sbo_string(cc::allocator* allocator, size_t initial_capacity = sbo_capacity)
+    {
+        CC_CONTRACT(allocator != nullptr);
+
+        if (initial_capacity < sbo_capacity)
+            initial_capacity = sbo_capacity;
+
+        _size = 0;
+        _sbo_words = {};
+        _data = _alloc_heap(initial_capacity, allocator);
+        _capacity = initial_capacity | _allocator_bit;
+        _data[0] = '\0';
+    }
+    sbo_string(string_view s, cc::allocator* allocator) : sbo_string(allocator, s.size())
+    {
+        if (!s.empty())
+            std::memcpy(_data, s.data(), s.size());
+        _size = s.size();
+        _data[_size] = '\0';
+    }
+
+    /// if allocator is nullptr, the default allocation is used
+    [[nodiscard]] static sbo_string uninitialized(size_t size, cc::allocator* allocator = nullptr)
     {
-        sbo_string s;
+        sbo_string s = allocator ? sbo_string(allocator, size) : sbo_string();
         s.reserve(size);
         s._size = size;
         s._data[size] = '\0';
         return s;
     }
 
-    [[nodiscard]] static sbo_string filled(size_t size, char value)
+    [[nodiscard]] static sbo_string filled(size_t size, char value, cc::allocator* allocator = nullptr)
     {
-        sbo_string s;
+        sbo_string s = allocator ? sbo_string(allocator, size) : sbo_string();
         s.resize(size, value);
         return s;
     }
@@ -140,7 +175,11 @@ public:
     {
         _sbo_words = {}; // also sets capacity to 0
 
-        if (rhs._is_short())
+        if (auto const allocator = rhs._get_allocator())
+        {
+            _copy_with_allocator(rhs, allocator);
+        }
+        else if (rhs._is_short())
         {
             _data = _sbo;
             _size = rhs._size;
@@ -183,10 +222,13 @@ public:
         if (this == &rhs)
             return *this;
 
-        if (!_is_short())
-            delete[] _data;
+        _free_heap();
 
-        if (rhs._is_short())
+        if (auto const allocator = rhs._get_allocator())
+        {
+            _copy_with_allocator(rhs, allocator);
+        }
+        else if (rhs._is_short())
         {
             _data = _sbo;
             _size = rhs._size;
@@ -212,7 +254,7 @@ public:
     {
         if (!_is_short())
         {
-            delete[] _data;
+            _free_heap();
             _data = _sbo;
             _capacity = 0; // make sure self-move doesn't crash
         }
@@ -233,11 +275,7 @@ public:
         return *this;
     }
 
-    ~sbo_string()
-    {
-        if (!_is_short())
-            delete[] _data;
-    }
+    ~sbo_string() { _free_heap(); }
 
     // methods
 public:
@@ -280,8 +318,15 @@ public:
 
     void clear()
     {
-        if (!_is_short())
-            delete[] _data;
+        if (_has_allocator())
+        {
+            // keep the buffer, strings with allocators never use the small buffer
+            _size = 0;
+            _data[0] = '\0';
+            return;
+        }
+
+        _free_heap();
 
         _data = _sbo;
         _size = 0;
@@ -298,25 +343,25 @@ public:
         if (s == c)
             return; // fit
 
-        if (s <= sbo_capacity)
+        if (s <= sbo_capacity && !_has_allocator())
         {
             std::memcpy(_sbo, _data, s + 1);
 
-            if (!_is_short())
-                delete[] _data;
+            _free_heap();
 
             _data = _sbo;
         }
         else
         {
-            auto new_data = new char[s + 1];
-            std::memcpy(new_data, _data, s + 1);
+            // strings with allocators keep at least the small buffer capacity
+            auto const new_cap = s < sbo_capacity ? sbo_capacity : s;
+            if (new_cap == c)
+                return;
 
-            if (!_is_short())
-                delete[] _data;
+            auto new_data = _alloc_heap(new_cap, _get_allocator());
+            std::memcpy(new_data, _data, s + 1);
 
-            _data = new_data;
-            _capacity = s;
+            _replace_heap(new_data, new_cap);
         }
     }
 
@@ -351,14 +396,10 @@ public:
         }
         else if (n != dynamic_size)
         {
-            if (!_is_short())
-                delete[] _data;
-
             CC_ASSERT(n >= sbo_capacity);
-            _data = new char[n + 1];
+            _replace_heap(_alloc_heap(n, _get_allocator()), n);
             _data[n] = '\0';
             _size = n;
-            _capacity = n;
         }
 
         for (size_t i = 0; i < _size; ++i)
@@ -367,14 +408,14 @@ public:
 
     [[nodiscard]] sbo_string to_lower() const
     {
-        auto r = uninitialized(_size);
+        auto r = uninitialized(_size, _get_allocator());
         for (size_t i = 0; i < _size; ++i)
             r._data[i] = cc::to_lower(_data[i]);
         return r;
     }
     [[nodiscard]] sbo_string to_upper() const
     {
-        auto r = uninitialized(_size);
+        auto r = uninitialized(_size, _get_allocator());
         for (size_t i = 0; i < _size; ++i)
             r._data[i] = cc::to_upper(_data[i]);
         return r;
@@ -388,7 +429,7 @@ public:
     }
     [[nodiscard]] sbo_string capitalized() const
     {
-        auto r = uninitialized(_size);
+        auto r = uninitialized(_size, _get_allocator());
         if (_size > 0)
             r._data[0] = cc::to_upper(_data[0]);
         for (size_t i = 1; i < _size; ++i)
@@ -554,19 +595,15 @@ public:
             if (new_size > new_cap)
                 new_cap = new_size;
 
-            auto new_data = new char[new_cap + 1];
+            auto new_data = _alloc_heap(new_cap, _get_allocator());
 
             std::memcpy(new_data, _data, pos);
             std::memcpy(new_data + pos, replacement.data(), replacement.size());
             std::memcpy(new_data + pos + replacement.size(), _data + pos + count, _size - count - pos);
             new_data[new_size] = '\0';
 
-            if (!_is_short())
-                delete[] _data;
-
+            _replace_heap(new_data, new_cap);
             _size = new_size;
-            _data = new_data;
-            _capacity = new_cap;
         }
         else
         {
@@ -609,7 +646,7 @@ public:
 
     [[nodiscard]] sbo_string replaced(char old, char replacement) const
     {
-        auto r = uninitialized(_size);
+        auto r = uninitialized(_size, _get_allocator());
         for (size_t i = 0; i < _size; ++i)
         {
             auto c = _data[i];
@@ -621,7 +658,7 @@ public:
     {
         CC_CONTRACT(pos <= _size);
         CC_CONTRACT(pos + count <= _size);
-        auto r = uninitialized(_size - count + replacement.size());
+        auto r = uninitialized(_size - count + replacement.size(), _get_allocator());
         std::memcpy(r._data, _data, pos);
         std::memcpy(r._data + pos, replacement.data(), replacement.size());
         std::memcpy(r._data + pos + replacement.size(), _data + pos + count, _size - count - pos);
@@ -633,7 +670,7 @@ public:
         if (old.size() > _size)
             return *this; // early out
 
-        sbo_string r;
+        auto r = uninitialized(0, _get_allocator());
         size_t i = 0;
         auto const os = old.size();
         while (i < _size)
@@ -683,18 +720,14 @@ public:
             if (new_cap < new_size)
                 new_cap = new_size;
 
-            auto new_data = new char[new_cap + 1];
+            auto new_data = _alloc_heap(new_cap, _get_allocator());
 
             std::memcpy(new_data, _data, _size);
             std::memcpy(new_data + _size, s.data(), s.size());
             new_data[new_size] = '\0';
 
-            if (!_is_short())
-                delete[] _data;
-
+            _replace_heap(new_data, new_cap);
             _size = new_size;
-            _data = new_data;
-            _capacity = new_cap;
         }
 
         return *this;
@@ -729,7 +762,7 @@ public:
     }
     friend sbo_string operator+(char lhs, sbo_string const& rhs)
     {
-        auto r = uninitialized(1 + rhs.size());
+        auto r = uninitialized(1 + rhs.size(), rhs._get_allocator());
         auto d = r.data();
         d[0] = lhs;
         std::memcpy(d + 1, rhs.data(), rhs.size());
@@ -737,7 +770,7 @@ public:
     }
     friend sbo_string operator+(string_view lhs, sbo_string const& rhs)
     {
-        auto r = uninitialized(lhs.size() + rhs.size());
+        auto r = uninitialized(lhs.size() + rhs.size(), rhs._get_allocator());
         auto d = r.data();
         std::memcpy(d, lhs.data(), lhs.size());
         std::memcpy(d + lhs.size(), rhs.data(), rhs.size());
@@ -750,16 +783,78 @@ private:
 
     void _reserve_force(size_t new_capacity)
     {
-        auto new_data = new char[new_capacity + 1];
-        auto old_data = _data;
+        auto new_data = _alloc_heap(new_capacity, _get_allocator());
 
-        std::memcpy(new_data, old_data, _size + 1);
+        std::memcpy(new_data, _data, _size + 1);
 
-        if (!_is_short())
+        _replace_heap(new_data, new_capacity);
+    }
+
+    // heap buffers of strings with an allocator are prefixed with it:
+    // [cc::allocator*] [chars ... '\0']
+    // such strings never use the small buffer, the top bit of _capacity marks them
+    static constexpr size_t _allocator_bit = size_t(1) << 63;
+
+    // NOTE: moved-from strings have a nullptr heap buffer
+    bool _has_allocator() const { return !_is_short() && _data != nullptr && (_capacity & _allocator_bit); }
+
+    cc::allocator* _get_allocator() const
+    {
+        if (!_has_allocator())
+            return nullptr;
+
+        cc::allocator* allocator;
+        std::memcpy(&allocator, _data - sizeof(cc::allocator*), sizeof(cc::allocator*));
+        return allocator;
+    }
+
+    /// (re)initializes as a copy of rhs with a heap buffer from the given allocator
+    void _copy_with_allocator(sbo_string const& rhs, cc::allocator* allocator)
+    {
+        // strings with allocators keep at least the small buffer capacity (so growth by doubling works)
+        auto const cap = rhs._size < sbo_capacity ? sbo_capacity : rhs._size;
+        _size = rhs._size;
+        _data = _alloc_heap(cap, allocator);
+        _capacity = cap | _allocator_bit;
+        std::memcpy(_data, rhs._data, _size + 1);
+    }
+
+    /// allocates a heap buffer for capacity chars and the null terminator
+    static char* _alloc_heap(size_t capacity, cc::allocator* allocator)
+    {
+        if (allocator == nullptr)
+            return new char[capacity + 1];
+
+        auto const buffer = allocator->alloc(sizeof(cc::allocator*) + capacity + 1, alignof(cc::allocator*));
+        std::memcpy(buffer, &allocator, sizeof(cc::allocator*));
+        return reinterpret_cast<char*>(buffer + sizeof(cc::allocator*));
+    }
+
+    /// frees the heap buffer (if any), does not change any members
+    void _free_heap()
+    {
+        if (_is_short())
+            return;
+
+        if (_capacity & _allocator_bit)
+        {
+            if (_data != nullptr)
+                _get_allocator()->free_sized(_data - sizeof(cc::allocator*), sizeof(cc::allocator*) + capacity() + 1, alignof(cc::allocator*));
+        }
+        else
+        {
             delete[] _data;
+        }
+    }
+
+    /// replaces the current buffer by one from _alloc_heap (with the same allocator)
+    void _replace_heap(char* new_data, size_t new_capacity)
+    {
+        bool const has_allocator = _has_allocator();
+        _free_heap();
 
         _data = new_data;
-        _capacity = new_capacity;
+        _capacity = has_allocator ? new_capacity | _allocator_bit : new_capacity;
     }
 
     void _grow() { _reserve_force(capacity() << 1); }
@@ -0,0 +1,102 @@
+#include "scratch_scope.hh"
+
+#include <cstring>
+
+#include <clean-core/assert.hh>
+#include <clean-core/utility.hh>
+
+// amount of virtual memory reserved per thread, physical memory is only committed on use
+#ifndef CC_SCRATCH_ARENA_VIRTUAL_SIZE
+#define CC_SCRATCH_ARENA_VIRTUAL_SIZE (size_t(1) << 30)
+#endif
+
+// increment of physical memory committed whenever a thread's arena has to grow
+#ifndef CC_SCRATCH_ARENA_CHUNK_SIZE
+#define CC_SCRATCH_ARENA_CHUNK_SIZE (size_t(1) << 16)
+#endif
+
+namespace
+{
+struct scratch_arena_state
+{
+    cc::virtual_stack_allocator arena;
+    int32_t depth = 0; // amount of currently alive scopes
+
+    cc::virtual_stack_allocator& get()
+    {
+        if (CC_UNLIKELY(arena.get_virtual_size_bytes() == 0))
+            arena.initialize(CC_SCRATCH_ARENA_VIRTUAL_SIZE, CC_SCRATCH_ARENA_CHUNK_SIZE);
+
+        return arena;
+    }
+};
+
+thread_local scratch_arena_state tl_scratch_arena;
+}
+
+cc::scratch_scope::scratch_scope()
+{
+    _marker = tl_scratch_arena.get().get_marker();
+    _depth = ++tl_scratch_arena.depth;
+}
+
+cc::scratch_scope::~scratch_scope()
+{
+    CC_ASSERT(_depth == tl_scratch_arena.depth && "scratch_scopes destroyed out of order or on a different thread");
+    --tl_scratch_arena.depth;
+    tl_scratch_arena.arena.free_to_marker(_marker);
+}
+
+std::byte* cc::scratch_scope::alloc(size_t size, size_t align)
+{
+    CC_ASSERT(_depth == tl_scratch_arena.depth && "only the innermost scratch_scope of a thread can allocate");
+    return tl_scratch_arena.arena.alloc(size, align);
+}
+
+void cc::scratch_scope::free(void* ptr)
+{
+    if (ptr == nullptr)
+        return;
+
+    CC_ASSERT(_depth == tl_scratch_arena.depth && "only the innermost scratch_scope of a thread can free");
+
+    // everything else is released once the scope ends
+    if (tl_scratch_arena.arena.is_latest_allocation(ptr))
+        tl_scratch_arena.arena.free(ptr);
+}
+
+std::byte* cc::scratch_scope::realloc(void* ptr, size_t new_size, size_t align)
+{
+    CC_ASSERT(_depth == tl_scratch_arena.depth && "only the innermost scratch_scope of a thread can reallocate");
+    auto& arena = tl_scratch_arena.arena;
+
+    if (new_size == 0)
+    {
+        this->free(ptr);
+        return nullptr;
+    }
+
+    if (ptr == nullptr || arena.is_latest_allocation(ptr))
+    {
+        // alloc or in-place growth
+        return arena.realloc(ptr, new_size, align);
+    }
+
+    // the old size is unknown, but everything up to the current head is readable arena memory
+    std::byte* const old_ptr = static_cast<std::byte*>(ptr);
+    size_t const old_size_bound = size_t(arena.get_marker().head - old_ptr);
+
+    std::byte* const res = arena.alloc(new_size, align);
+    std::memcpy(res, old_ptr, cc::min(old_size_bound, new_size));
+    return res;
+}
+
+size_t cc::scratch_scope::get_allocated_size_bytes() const { return size_t(tl_scratch_arena.arena.get_marker().head - _marker.head); }
+
+size_t cc::scratch_scope::decommit_idle_memory()
+{
+    if (tl_scratch_arena.arena.get_virtual_size_bytes() == 0)
+        return 0;
+
+    return tl_scratch_arena.arena.decommit_idle_memory();
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+
+#include <clean-core/allocator.hh>
+#include <clean-core/allocators/virtual_stack_allocator.hh>
+
+namespace cc
+{
+/**
+ * RAII scope for short-lived temporary allocations
+ * each thread owns a virtual_stack_allocator arena, a scope records its position on construction
+ * and rewinds to it on destruction, freeing everything allocated through the scope at once
+ * zero contention, allocating is a bump of the thread-local stack
+ *
+ * Usage:
+ *
+ *   {
+ *       cc::scratch_scope scratch;
+ *       auto tmp = cc::alloc_vector<int>(scratch.allocator());
+ *       // ...
+ *   } // all memory of tmp is released here
+ *
+ * NOTE: scopes can be nested, only the innermost scope of a thread can allocate
+ *       scopes are not thread safe and must not leave their thread
+ *       all objects allocated through a scope must be destroyed before the scope
+ *
+ * free() is a no-op unless the pointer is the most recent allocation (then it is popped)
+ * realloc() grows in place for the most recent allocation
+ */
+struct scratch_scope final : cc::allocator
+{
+    scratch_scope();
+    ~scratch_scope() override;
+
+    std::byte* alloc(size_t size, size_t align = alignof(std::max_align_t)) override;
+
+    void free(void* ptr) override;
+
+    std::byte* realloc(void* ptr, size_t new_size, size_t align = alignof(std::max_align_t)) override;
+
+    char const* get_name() const override { return "Scratch Scope"; }
+
+    // the allocator to pass to containers
+    cc::allocator* allocator() { return this; }
+
+    // amount of bytes allocated through this scope (and nested scopes)
+    size_t get_allocated_size_bytes() const;
+
+    // decommit the physical memory of all pages of the calling thread's arena not currently required
+    // returns amount of bytes decommitted
+    static size_t decommit_idle_memory();
+
+    scratch_scope(scratch_scope const&) = delete;
+    scratch_scope(scratch_scope&&) = delete;
+    scratch_scope& operator=(scratch_scope const&) = delete;
+    scratch_scope& operator=(scratch_scope&&) = delete;
+
+private:
+    cc::virtual_stack_allocator::marker_t _marker;
+    int32_t _depth = 0;
+};
+}
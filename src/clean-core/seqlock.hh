@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include <atomic>
+#include <type_traits>
+
+#include <clean-core/forward.hh>
+#include <clean-core/intrinsics.hh>
+#include <clean-core/lock_guard.hh>
+#include <clean-core/macros.hh>
+#include <clean-core/spin_lock.hh>
+
+namespace cc
+{
+// sequence lock for small, trivially copyable values that are read often and written rarely
+// readers copy the value and retry if a write happened meanwhile: they never write shared memory,
+// so any number of readers scale without cache line ping-pong
+// writers are serialized by a spinlock and make concurrent readers retry
+//
+// the value is stored as relaxed atomic words, so the racy reads are well-defined
+// readers can starve while writes happen back-to-back, only use it for rarely written data
+//
+// Usage:
+//
+//   cc::seqlock<camera_state> camera;
+//   camera.store(new_state);                  // writer
+//   camera_state const s = camera.load();     // readers
+//   camera.update([](camera_state& s) { s.fov = 60; });
+template <class T>
+struct seqlock
+{
+    static_assert(std::is_trivially_copyable_v<T>, "seqlock values are copied bytewise");
+
+public:
+    seqlock() : seqlock(T{}) {}
+    explicit seqlock(T const& value) { _write_words(value); }
+
+    // consistent snapshot of the value
+    [[nodiscard]] T load() const noexcept
+    {
+        T value;
+        while (!try_load(value))
+            cc::intrin_pause();
+        return value;
+    }
+
+    // single attempt, returns false if a write was in progress
+    bool try_load(T& out_value) const noexcept
+    {
+        uint32_t const seq_before = _sequence.load(std::memory_order_acquire);
+        if (seq_before & 1)
+            return false;
+
+        uint64_t words[sc_num_words];
+        for (size_t i = 0; i < sc_num_words; ++i)
+            words[i] = _words[i].load(std::memory_order_relaxed);
+
+        // the word loads must not be reordered after the second sequence load
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (_sequence.load(std::memory_order_relaxed) != seq_before)
+            return false;
+
+        std::memcpy(&out_value, words, sizeof(T));
+        return true;
+    }
+
+    void store(T const& value) noexcept
+    {
+        update([&](T& v) { v = value; });
+    }
+
+    // read-modify-write under the writer lock, f(T&) modifies a copy which is then published
+    template <class F>
+    void update(F&& f)
+    {
+        auto lg = cc::lock_guard(_writer_lock);
+
+        // only writers modify the words, so reading them under the lock is consistent
+        T value;
+        uint64_t words[sc_num_words];
+        for (size_t i = 0; i < sc_num_words; ++i)
+            words[i] = _words[i].load(std::memory_order_relaxed);
+        std::memcpy(&value, words, sizeof(T));
+
+        f(value);
+
+        uint32_t const seq = _sequence.load(std::memory_order_relaxed);
+        _sequence.store(seq + 1, std::memory_order_relaxed);
+        // the word stores must not be reordered before the odd sequence number
+        std::atomic_thread_fence(std::memory_order_release);
+        _write_words(value);
+        _sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    seqlock(seqlock const& other) = delete;
+    seqlock(seqlock&& other) noexcept = delete;
+    seqlock& operator=(seqlock const& other) = delete;
+    seqlock& operator=(seqlock&& other) noexcept = delete;
+
+private:
+    static constexpr size_t sc_num_words = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    void _write_words(T const& value) noexcept
+    {
+        uint64_t words[sc_num_words] = {};
+        std::memcpy(words, &value, sizeof(T));
+        for (size_t i = 0; i < sc_num_words; ++i)
+            _words[i].store(words[i], std::memory_order_relaxed);
+    }
+
+    std::atomic<uint32_t> _sequence = {0};
+    cc::spin_lock _writer_lock;
+    std::atomic<uint64_t> _words[sc_num_words];
+};
+}
@@ -2,7 +2,7 @@
 
 #include <initializer_list>
 
-#include <clean-core/array.hh>
+#include <clean-core/alloc_array.hh>
 #include <clean-core/equal_to.hh>
 #include <clean-core/forward_list.hh>
 #include <clean-core/fwd.hh>
@@ -12,6 +12,9 @@
 
 namespace cc
 {
+/// hash-based set
+/// nodes are allocated via cc::alloc or, if given, all memory comes from a cc::allocator
+/// copies and moves propagate the allocator
 template <class T, class HashT, class EqualT>
 struct set
 {
@@ -38,22 +41,63 @@ public:
 public:
     set() = default;
 
-    set(set&&) = default;
-    set(set const&) = default;
-    set& operator=(set&&) = default;
-    set& operator=(set const&) = default;
+    /// creates an empty set that allocates all its memory from the given allocator
+    explicit set(cc::allocator* allocator) : _entries(allocator), _allocator(allocator) { CC_CONTRACT(allocator != nullptr); }
+
+    set(set const& rhs) : _entries(rhs._bucket_allocator()), _allocator(rhs._allocator) { _copy_entries(rhs); }
+
+    /// copies rhs into a set with a different allocator (nullptr for the default)
+    set(set const& rhs, cc::allocator* allocator) : _entries(allocator ? allocator : cc::system_allocator), _allocator(allocator)
+    {
+        _copy_entries(rhs);
+    }
+
+    set(set&& rhs) noexcept : _entries(cc::move(rhs._entries)), _size(rhs._size), _allocator(rhs._allocator)
+    {
+        rhs._size = 0;
+        rhs._allocator = nullptr;
+    }
+
+    set& operator=(set const& rhs)
+    {
+        if (this != &rhs)
+        {
+            clear();
+            _allocator = rhs._allocator;
+            _entries.reset(_bucket_allocator());
+            _copy_entries(rhs);
+        }
+        return *this;
+    }
+
+    set& operator=(set&& rhs) noexcept
+    {
+        if (this != &rhs)
+        {
+            clear();
+            _entries = cc::move(rhs._entries);
+            _size = rhs._size;
+            _allocator = rhs._allocator;
+            rhs._size = 0;
+            rhs._allocator = nullptr;
+        }
+        return *this;
+    }
+
+    ~set() { _clear_nodes(); }
 
     /// constructs a set by adding all elements of the range
     /// TODO: proper support for move-only types
     template <class Range, cc::enable_if<cc::is_range<Range, T const>> = true>
-    explicit set(Range&& range)
+    explicit set(Range&& range, cc::allocator* allocator = nullptr) : _entries(allocator ? allocator : cc::system_allocator), _allocator(allocator)
     {
         for (auto&& e : range)
             this->add(e);
     }
 
     /// constructs a set by adding all elements of the range
-    set(std::initializer_list<T> values)
+    set(std::initializer_list<T> values, cc::allocator* allocator = nullptr)
+      : _entries(allocator ? allocator : cc::system_allocator), _allocator(allocator)
     {
         for (auto&& e : values)
             this->add(e);
@@ -76,7 +120,7 @@ public:
                 return false; // already contained
 
         ++_size;
-        l.emplace_front(value);
+        l._emplace_front(_allocator, value);
         return true;
     }
 
@@ -99,7 +143,7 @@ public:
 
         if (EqualT{}(*it, value))
         {
-            list.pop_front();
+            list._pop_front(_allocator);
             --_size;
             return true;
         }
@@ -109,7 +153,7 @@ public:
         {
             if (EqualT{}(*it, value))
             {
-                list.erase_after(prev);
+                list._erase_after(_allocator, prev);
                 --_size;
                 return true;
             }
@@ -177,10 +221,12 @@ public:
     void clear()
     {
         _size = 0;
-        for (auto& l : _entries)
-            l.clear();
+        _clear_nodes();
     }
 
+    /// the allocator of all memory of this set, nullptr for the default (cc::alloc for nodes)
+    cc::allocator* allocator() const { return _allocator; }
+
     // iteration
 public:
     struct iterator
@@ -207,9 +253,9 @@ public:
             last = s._entries.end();
             find_next_it();
         }
-        cc::forward_list<T> const* curr;
-        cc::forward_list<T> const* last;
-        typename cc::forward_list<T>::const_iterator it;
+        detail::forward_list_base<T> const* curr;
+        detail::forward_list_base<T> const* last;
+        typename detail::forward_list_base<T>::const_iterator it;
 
         void find_next_it()
         {
@@ -241,18 +287,60 @@ private:
     void _reserve(size_t new_cap)
     {
         auto old_entries = cc::move(_entries);
-        _entries = cc::array<cc::forward_list<T>>::defaulted(new_cap);
+        _entries = cc::alloc_array<detail::forward_list_base<T>>::defaulted(new_cap, _bucket_allocator());
+
+        // relink all nodes into the new buckets
         for (auto& l : old_entries)
-            for (auto& e : l)
+        {
+            auto n = l._first;
+            while (n)
             {
-                auto idx = this->_get_location(e);
-                _entries[idx].emplace_front(cc::move(e));
+                auto nn = n->next;
+
+                auto& nl = _entries[this->_get_location(n->value)];
+                n->next = nl._first;
+                nl._first = n;
+
+                n = nn;
             }
+        }
+    }
+
+    cc::allocator* _bucket_allocator() const { return _allocator ? _allocator : cc::system_allocator; }
+
+    /// destroys all nodes, keeps the buckets
+    void _clear_nodes()
+    {
+        // nothing to destroy or free individually
+        if (_allocator && _allocator->is_free_noop() && std::is_trivially_destructible_v<T>)
+        {
+            for (auto& l : _entries)
+                l._first = nullptr;
+            return;
+        }
+
+        for (auto& l : _entries)
+            l._clear(_allocator);
+    }
+
+    /// copies all elements of rhs, expects this set to be empty
+    void _copy_entries(set const& rhs)
+    {
+        CC_ASSERT(_size == 0 && _entries.empty());
+
+        if (rhs._entries.empty())
+            return;
+
+        _entries = cc::alloc_array<detail::forward_list_base<T>>::defaulted(rhs._entries.size(), _bucket_allocator());
+        for (size_t i = 0; i < _entries.size(); ++i)
+            _entries[i]._append_copy(_allocator, rhs._entries[i]);
+        _size = rhs._size;
     }
 
     // member
 private:
-    cc::array<cc::forward_list<T>> _entries;
+    cc::alloc_array<detail::forward_list_base<T>> _entries;
     size_t _size = 0;
+    cc::allocator* _allocator = nullptr; // nullptr: nodes via cc::alloc, buckets via system allocator
 };
 }
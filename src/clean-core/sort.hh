@@ -40,7 +40,7 @@ namespace cc
 /// - other steps of pdqsort also depend on local tmp copies that cannot be used
 /// - maybe a special swap location? prob better as sep arg
 /// - is_cheap_to_store trait (e.g. trivially copyable <= 256 bit) so that some get invocations can be removed
-/// - parallel version
+/// - parallel version: see parallel_sort.hh
 template <class GetF, class CompareF, class SwapF, class SelectF>
 constexpr void sort_ex(int64_t start, size_t size, GetF&& get, CompareF&& compare, SwapF&& swap, SelectF&& select);
 
@@ -271,23 +271,63 @@ constexpr int64_t partition_right(bool& was_already_partitioned, int64_t start,
     return pivot_pos;
 }
 
-template <class GetF, class CompareF, class SwapF, class SelectF>
-constexpr void sort_ex_impl(int64_t start, int64_t size, GetF& get, CompareF& compare, SwapF& swap, SelectF& select)
+// partitions the range around the pivot
+// equal elements are moved to the left of the pivot
+// pivot is initially at start
+// requires an element at start - 1 that is not greater than any element of the range (it is not accessed)
+// returns position of pivot
+template <class GetF, class CompareF, class SwapF>
+constexpr int64_t partition_left(int64_t start, int64_t size, GetF&& get, CompareF&& compare, SwapF&& swap)
 {
-    if (size <= detail::small_sort_threshold)
+    auto&& pivot = cc::invoke(get, start);
+
+    int64_t first = start;
+    int64_t last = start + size;
+
+    // find last element <= pivot (exists, the pivot itself)
+    while (cc::invoke(compare, pivot, cc::invoke(get, --last)))
     {
-        detail::small_sort(start, size, get, compare, swap);
-        return;
+        // empty
     }
 
+    // find first element > pivot
+    // guard is only needed if no element after
+    if (last + 1 == start + size)
+        while (first < last && !cc::invoke(compare, pivot, cc::invoke(get, ++first)))
+        {
+            // empty
+        }
+    else
+        while (!cc::invoke(compare, pivot, cc::invoke(get, ++first)))
+        {
+            // empty
+        }
 
-    // TODO: linear time for two element types
+    while (first < last)
+    {
+        cc::invoke(swap, first, last);
+        while (cc::invoke(compare, pivot, cc::invoke(get, --last)))
+        {
+            // empty
+        }
+        while (!cc::invoke(compare, pivot, cc::invoke(get, ++first)))
+        {
+            // empty
+        }
+    }
 
-    // TODO: some tail recursion opt? or simply a local stack?
+    // move pivot to correct pos
+    int64_t pivot_pos = last;
+    cc::invoke(swap, pivot_pos, start);
 
-    // TODO: optimization for highly unbalanced partitions
+    return pivot_pos;
+}
 
-    // select pivot (median of 3 or pseudomedian of 9)
+// selects the pivot (median of 3 or pseudomedian of 9) and moves it to start
+// partition_right relies on the pivot being a median of the sampled elements
+template <class GetF, class CompareF, class SwapF>
+constexpr void select_pivot(int64_t start, int64_t size, GetF& get, CompareF& compare, SwapF& swap)
+{
     int64_t end = start + size;
     int64_t size_half = size >> 1;
     if (size > detail::ninther_threshold)
@@ -302,8 +342,43 @@ constexpr void sort_ex_impl(int64_t start, int64_t size, GetF& get, CompareF& co
     {
         detail::sort3(start + size_half, start, end - 1, get, compare, swap);
     }
+}
+
+template <class GetF, class CompareF, class SwapF, class SelectF>
+// leftmost: false if the element at start - 1 belongs to the sorted range and is not greater than any element of this subrange
+//           (i.e. it is the pivot of a parent partition)
+constexpr void sort_ex_impl(int64_t start, int64_t size, GetF& get, CompareF& compare, SwapF& swap, SelectF& select, bool leftmost = true)
+{
+    if (size <= detail::small_sort_threshold)
+    {
+        detail::small_sort(start, size, get, compare, swap);
+        return;
+    }
+
+
+    // TODO: linear time for two element types
+
+    // TODO: some tail recursion opt? or simply a local stack?
+
+    // TODO: optimization for highly unbalanced partitions
+
+    detail::select_pivot(start, size, get, compare, swap);
     // NOTE: pivot is now at start
 
+    int64_t end = start + size;
+
+    // pivot is equal to the previous pivot: all elements equal to it are moved left and are done
+    // (without this, many equal elements lead to quadratic runtime and recursion depth)
+    if (!leftmost && !cc::invoke(compare, cc::invoke(get, start - 1), cc::invoke(get, start)))
+    {
+        int64_t start_right = detail::partition_left(start, size, get, compare, swap) + 1;
+        int64_t size_right = end - start_right;
+
+        if (cc::invoke(select, start_right, size_right))
+            detail::sort_ex_impl(start_right, size_right, get, compare, swap, select, false);
+        return;
+    }
+
     // partition range
     bool was_already_partitioned = false;
     auto pivot_pos = detail::partition_right(was_already_partitioned, start, size, get, compare, swap);
@@ -315,10 +390,10 @@ constexpr void sort_ex_impl(int64_t start, int64_t size, GetF& get, CompareF& co
     int64_t size_right = end - start_right;
 
     if (cc::invoke(select, start_left, size_left))
-        detail::sort_ex_impl(start_left, size_left, get, compare, swap, select);
+        detail::sort_ex_impl(start_left, size_left, get, compare, swap, select, leftmost);
 
     if (cc::invoke(select, start_right, size_right))
-        detail::sort_ex_impl(start_right, size_right, get, compare, swap, select);
+        detail::sort_ex_impl(start_right, size_right, get, compare, swap, select, false);
 }
 
 // the default values types that follow _could_ be lambdas
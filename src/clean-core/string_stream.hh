@@ -7,6 +7,9 @@
 
 namespace cc
 {
+/// builds strings by appending
+/// memory is allocated via new[] / delete[] or, if given, via a cc::allocator
+/// copies and moves propagate the allocator, to_string() creates a string with the same allocator
 struct string_stream
 {
 public: // methods
@@ -32,9 +35,9 @@ public: // methods
     [[nodiscard]] string to_string() const
     {
         if (empty())
-            return {}; // memcpy must not be empty
+            return string::uninitialized(0, m_allocator); // memcpy must not be empty
 
-        string s = string::uninitialized(size());
+        string s = string::uninitialized(size(), m_allocator);
         std::memcpy(s.data(), m_data, size());
         return s;
     }
@@ -47,10 +50,10 @@ public: // methods
             return;
 
         size_t new_cap = (m_capacity << 1) < req_size ? req_size : (m_capacity << 1);
-        char* new_data = new char[new_cap];
+        char* new_data = _alloc(new_cap);
         if (!empty())
             std::memcpy(new_data, m_data, this->size());
-        delete[] m_data;
+        _free(m_data, m_capacity);
         m_curr = m_curr - m_data + new_data;
         m_data = new_data;
         m_capacity = new_cap;
@@ -62,14 +65,18 @@ public: // properties
     [[nodiscard]] size_t size() const noexcept { return m_curr - m_data; }
     [[nodiscard]] bool empty() const { return m_curr == m_data; }
 
+    /// the allocator of the buffer, nullptr for the default (new[] / delete[])
+    [[nodiscard]] cc::allocator* allocator() const { return m_allocator; }
+
 public: // ctor
     string_stream() = default;
+    explicit string_stream(cc::allocator* allocator) : m_allocator(allocator) { CC_CONTRACT(allocator != nullptr); }
 
-    string_stream(string_stream const& rhs)
+    string_stream(string_stream const& rhs) : m_allocator(rhs.m_allocator)
     {
         if (!rhs.empty())
         {
-            m_data = new char[rhs.size()];
+            m_data = _alloc(rhs.size());
             std::memcpy(m_data, rhs.m_data, rhs.size());
             m_curr = m_data + rhs.size();
             m_capacity = rhs.size();
@@ -81,23 +88,26 @@ public: // ctor
         m_data = rhs.m_data;
         m_curr = rhs.m_curr;
         m_capacity = rhs.m_capacity;
+        m_allocator = rhs.m_allocator;
         rhs.m_data = nullptr;
         rhs.m_curr = nullptr;
         rhs.m_capacity = 0;
+        rhs.m_allocator = nullptr;
     };
 
-    ~string_stream() { delete[] m_data; }
+    ~string_stream() { _free(m_data, m_capacity); }
 
 public: // assignment
     string_stream& operator=(string_stream const& rhs)
     {
         if (this != &rhs)
         {
-            if (m_capacity < rhs.size())
+            if (m_capacity < rhs.size() || m_allocator != rhs.m_allocator)
             {
-                delete[] m_data;
-                m_data = new char[rhs.size()];
-                m_capacity = rhs.size();
+                _free(m_data, m_capacity);
+                m_allocator = rhs.m_allocator;
+                m_data = rhs.empty() ? nullptr : _alloc(rhs.size());
+                m_capacity = rhs.empty() ? 0 : rhs.size();
             }
             if (!rhs.empty())
                 std::memcpy(m_data, rhs.m_data, rhs.size());
@@ -108,20 +118,39 @@ public: // assignment
 
     string_stream& operator=(string_stream&& rhs) noexcept
     {
-        delete[] m_data;
+        _free(m_data, m_capacity);
         m_data = rhs.m_data;
         m_curr = rhs.m_curr;
         m_capacity = rhs.m_capacity;
+        m_allocator = rhs.m_allocator;
         rhs.m_data = nullptr;
         rhs.m_curr = nullptr;
         rhs.m_capacity = 0;
+        rhs.m_allocator = nullptr;
         return *this;
     }
 
+private: // helper
+    char* _alloc(size_t size) const
+    {
+        if (m_allocator == nullptr)
+            return new char[size];
+
+        return reinterpret_cast<char*>(m_allocator->alloc(size, 1));
+    }
+    void _free(char* data, size_t capacity) const
+    {
+        if (m_allocator == nullptr)
+            delete[] data;
+        else if (data != nullptr)
+            m_allocator->free_sized(data, capacity, 1);
+    }
+
 private: // member
     char* m_data = nullptr;
     char* m_curr = nullptr;
     size_t m_capacity = 0;
+    cc::allocator* m_allocator = nullptr; // nullptr: new[] / delete[]
 };
 
 inline string to_string(string_stream const& ss) { return ss.to_string(); }
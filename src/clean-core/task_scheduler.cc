@@ -0,0 +1,366 @@
+#include "task_scheduler.hh"
+
+#include <functional> // std::hash
+#include <thread>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include <clean-core/assert.hh>
+#include <clean-core/macros.hh>
+
+namespace
+{
+// capacity of the injection queue for tasks submitted from outside the workers
+constexpr size_t task_scheduler_injection_queue_size = 4096;
+
+// amount of unsuccessful searches for work before a worker parks
+constexpr int task_scheduler_num_spins = 256;
+
+// the scheduler and worker index of the calling thread
+thread_local cc::task_scheduler const* tl_task_scheduler = nullptr;
+thread_local int32_t tl_task_scheduler_worker_index = -1;
+
+CC_FORCE_INLINE void task_scheduler_pause()
+{
+#if defined(__x86_64__)
+    _mm_pause();
+#elif defined(__arm__) || defined(__arm64__) || defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+}
+
+// the deque is a member of cc::task_scheduler::worker and thus must not use the anonymous namespace
+namespace cc::detail
+{
+// capacity of each worker's deque, tasks are executed inline once it is full
+constexpr int64_t task_scheduler_deque_size = 4096;
+
+// Chase-Lev work-stealing deque with a fixed capacity
+// push and pop only from the owning thread (bottom), steal from any thread (top)
+// memory orders follow "Correct and Efficient Work-Stealing for Weak Memory Models" (Le et al. 2013)
+struct task_scheduler_deque
+{
+    bool push(uint32_t value)
+    {
+        int64_t const b = _bottom.load(std::memory_order_relaxed);
+        int64_t const t = _top.load(std::memory_order_acquire);
+        if (b - t >= task_scheduler_deque_size)
+            return false;
+
+        _buffer[b & (task_scheduler_deque_size - 1)].store(value, std::memory_order_relaxed);
+        _bottom.store(b + 1, std::memory_order_release); // publishes the task to thieves
+        return true;
+    }
+
+    bool pop(uint32_t& out_value)
+    {
+        int64_t const b = _bottom.load(std::memory_order_relaxed) - 1;
+        _bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = _top.load(std::memory_order_relaxed);
+
+        if (t > b)
+        {
+            // empty
+            _bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        out_value = _buffer[b & (task_scheduler_deque_size - 1)].load(std::memory_order_relaxed);
+        if (t == b)
+        {
+            // last element, race against thieves
+            bool const won = _top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            _bottom.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+
+        return true;
+    }
+
+    bool steal(uint32_t& out_value)
+    {
+        int64_t t = _top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t const b = _bottom.load(std::memory_order_acquire);
+
+        if (t >= b)
+            return false;
+
+        out_value = _buffer[t & (task_scheduler_deque_size - 1)].load(std::memory_order_relaxed);
+        return _top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    }
+
+private:
+    alignas(64) std::atomic<int64_t> _top = {0};
+    alignas(64) std::atomic<int64_t> _bottom = {0};
+    alignas(64) std::atomic<uint32_t> _buffer[task_scheduler_deque_size];
+};
+}
+
+struct cc::task_scheduler::worker
+{
+    detail::task_scheduler_deque deque;
+    task_pool_t::thread_cache cache;
+    std::thread thread;
+    uint32_t rng_state;
+
+    explicit worker(task_pool_t& pool, uint32_t seed) : cache(pool), rng_state(seed | 1) {}
+
+    // xorshift32 for picking steal victims
+    uint32_t next_random()
+    {
+        rng_state ^= rng_state << 13;
+        rng_state ^= rng_state >> 17;
+        rng_state ^= rng_state << 5;
+        return rng_state;
+    }
+};
+
+void cc::task_scheduler::initialize(size_t num_threads, size_t max_num_tasks)
+{
+    CC_ASSERT(_workers == nullptr && "double init");
+
+    if (num_threads == 0)
+        num_threads = cc::max<size_t>(1, std::thread::hardware_concurrency());
+
+    _task_pool.initialize_growable(max_num_tasks);
+    _injection_queue.initialize(task_scheduler_injection_queue_size, cc::system_allocator);
+    _is_stopping.store(false);
+
+    _num_workers = num_threads;
+    _workers = cc::system_allocator->new_array_sized<worker*>(_num_workers);
+    for (size_t i = 0; i < _num_workers; ++i)
+        _workers[i] = cc::system_allocator->new_t<worker>(_task_pool, uint32_t(i * 0x9E3779B9u));
+
+    // start threads once all workers exist, they steal from each other
+    for (size_t i = 0; i < _num_workers; ++i)
+        _workers[i]->thread = std::thread([this, i] { _worker_main(int32_t(i)); });
+}
+
+void cc::task_scheduler::destroy()
+{
+    if (_workers == nullptr)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lg(_park_mutex);
+        _is_stopping.store(true);
+        _wake_epoch.fetch_add(1);
+    }
+    _park_cv.notify_all();
+
+    for (size_t i = 0; i < _num_workers; ++i)
+        _workers[i]->thread.join();
+
+    // flushes the task caches into the pool
+    for (size_t i = 0; i < _num_workers; ++i)
+        cc::system_allocator->delete_t(_workers[i]);
+    cc::system_allocator->delete_array_sized(_workers, _num_workers);
+
+    _workers = nullptr;
+    _num_workers = 0;
+    _task_pool.destroy();
+}
+
+void cc::task_scheduler::wait(counter& c)
+{
+    int32_t const worker_index = get_current_worker_index();
+
+    int num_failed = 0;
+    while (!c.is_done())
+    {
+        if (_try_run_task(worker_index))
+        {
+            num_failed = 0;
+            continue;
+        }
+
+        // the remaining tasks are running on other threads
+        if (++num_failed < task_scheduler_num_spins)
+            task_scheduler_pause();
+        else
+            std::this_thread::yield();
+    }
+}
+
+void cc::task_scheduler::run_chunks(size_t num_chunks, cc::function_ref<void(size_t)> chunk)
+{
+    if (num_chunks == 0)
+        return;
+
+    counter c;
+    _split_chunks(0, num_chunks, chunk, c);
+    wait(c);
+}
+
+bool cc::task_scheduler::try_run_task() { return _try_run_task(get_current_worker_index()); }
+
+int32_t cc::task_scheduler::get_current_worker_index() const { return tl_task_scheduler == this ? tl_task_scheduler_worker_index : -1; }
+
+cc::task_scheduler::task_handle_t cc::task_scheduler::_acquire_task(task*& out_task)
+{
+    CC_ASSERT(_workers != nullptr && "task_scheduler uninitialized");
+
+    int32_t const worker_index = get_current_worker_index();
+    task_handle_t const handle = worker_index >= 0 ? _workers[worker_index]->cache.acquire() : _task_pool.acquire();
+    out_task = &_task_pool.get(handle);
+    return handle;
+}
+
+void cc::task_scheduler::_push_task(task_handle_t handle)
+{
+    int32_t const worker_index = get_current_worker_index();
+
+    if (worker_index >= 0)
+    {
+        if (!_workers[worker_index]->deque.push(handle))
+        {
+            // deque full, there is enough parallelism already
+            _run_task(handle, worker_index);
+            return;
+        }
+    }
+    else
+    {
+        while (!_injection_queue.enqueue(handle))
+        {
+            // queue full, help out
+            if (!_try_run_task(worker_index))
+                std::this_thread::yield();
+        }
+    }
+
+    _wake_one();
+}
+
+bool cc::task_scheduler::_try_run_task(int32_t worker_index)
+{
+    task_handle_t handle;
+
+    // own tasks first, most recent one (hot in cache)
+    if (worker_index >= 0 && _workers[worker_index]->deque.pop(handle))
+    {
+        _run_task(handle, worker_index);
+        return true;
+    }
+
+    if (_injection_queue.dequeue(&handle))
+    {
+        _run_task(handle, worker_index);
+        return true;
+    }
+
+    // steal the oldest task of another worker, starting at a random one
+    size_t const start = worker_index >= 0 ? _workers[worker_index]->next_random() : size_t(std::hash<std::thread::id>()(std::this_thread::get_id()));
+    for (size_t i = 0; i < _num_workers; ++i)
+    {
+        size_t const victim = (start + i) % _num_workers;
+        if (int32_t(victim) != worker_index && _workers[victim]->deque.steal(handle))
+        {
+            _run_task(handle, worker_index);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void cc::task_scheduler::_run_task(task_handle_t handle, int32_t worker_index)
+{
+    task& t = _task_pool.get(handle);
+    counter* const dependent = t.dependent;
+
+    t.execute(t.callable);
+
+    if (worker_index >= 0)
+        _workers[worker_index]->cache.release(handle);
+    else
+        _task_pool.release(handle);
+
+    // after the callable is destroyed, its captures may reference the stack of the waiting thread
+    if (dependent)
+        dependent->done(1);
+}
+
+void cc::task_scheduler::_split_chunks(size_t begin, size_t end, cc::function_ref<void(size_t)> const& chunk, counter& c)
+{
+    // hand out the upper half, continue with the lower one
+    while (end - begin > 1)
+    {
+        size_t const mid = begin + (end - begin) / 2;
+        submit([this, mid, end, &chunk, &c] { _split_chunks(mid, end, chunk, c); }, &c);
+        end = mid;
+    }
+
+    chunk(begin);
+}
+
+void cc::task_scheduler::_worker_main(int32_t worker_index)
+{
+    tl_task_scheduler = this;
+    tl_task_scheduler_worker_index = worker_index;
+
+    int num_failed = 0;
+    while (true)
+    {
+        if (_try_run_task(worker_index))
+        {
+            num_failed = 0;
+            continue;
+        }
+
+        if (_is_stopping.load(std::memory_order_acquire))
+            break;
+
+        if (++num_failed < task_scheduler_num_spins)
+        {
+            task_scheduler_pause();
+            continue;
+        }
+
+        num_failed = 0;
+        _park(worker_index);
+    }
+
+    tl_task_scheduler = nullptr;
+    tl_task_scheduler_worker_index = -1;
+}
+
+void cc::task_scheduler::_park(int32_t worker_index)
+{
+    // announce first, then check for work one last time
+    // pairs with the fence in _wake_one: either the submitter sees this worker parking or this worker sees the task
+    _num_parked.fetch_add(1, std::memory_order_seq_cst);
+    uint64_t const epoch = _wake_epoch.load(std::memory_order_seq_cst);
+
+    if (_try_run_task(worker_index))
+    {
+        _num_parked.fetch_sub(1, std::memory_order_relaxed);
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(_park_mutex);
+        _park_cv.wait(lock, [&] { return _wake_epoch.load(std::memory_order_relaxed) != epoch || _is_stopping.load(std::memory_order_relaxed); });
+    }
+
+    _num_parked.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void cc::task_scheduler::_wake_one()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (CC_LIKELY(_num_parked.load(std::memory_order_relaxed) == 0))
+        return;
+
+    {
+        // under the lock, so that a worker between its check and its wait does not miss it
+        std::lock_guard<std::mutex> lg(_park_mutex);
+        _wake_epoch.fetch_add(1, std::memory_order_relaxed);
+    }
+    _park_cv.notify_one();
+}
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <type_traits>
+
+#include <clean-core/atomic_linked_pool.hh>
+#include <clean-core/executor.hh>
+#include <clean-core/experimental/mpmc_queue.hh>
+#include <clean-core/forward.hh>
+#include <clean-core/new.hh>
+#include <clean-core/unique_function.hh>
+
+namespace cc
+{
+/// work-stealing task scheduler for fork-join parallelism
+///
+/// each worker thread owns a Chase-Lev deque: it pushes and pops its own tasks at the bottom (LIFO),
+/// idle workers steal from the top of the other deques (FIFO)
+/// tasks submitted from outside the workers go to a global injection queue (mpmc_queue)
+/// task nodes come from an atomic_linked_pool, small callables are stored inline (no allocation per task)
+/// workers that find no work for a while park on a condition variable instead of spinning
+///
+/// Usage:
+///
+///   cc::task_scheduler scheduler(num_threads);
+///
+///   cc::task_scheduler::counter c;
+///   for (auto i = 0; i < 100; ++i)
+///       scheduler.submit([&, i] { process(i); }, &c);
+///   scheduler.wait(c); // runs pending tasks on the calling thread until all 100 are done
+///
+/// submit() and wait() can be called from any thread, including from inside tasks (nested fork-join)
+/// as a cc::executor, it runs the chunks of the parallel algorithms
+struct task_scheduler final : executor
+{
+    /// amount of unfinished tasks submitted with it, wait() returns once it reaches zero
+    /// can also be used as a latch for dependencies outside the scheduler via add() and done()
+    struct counter
+    {
+        bool is_done() const { return _num_pending.load(std::memory_order_acquire) == 0; }
+
+        void add(int32_t num = 1) { _num_pending.fetch_add(num, std::memory_order_relaxed); }
+        void done(int32_t num = 1) { _num_pending.fetch_sub(num, std::memory_order_release); }
+
+        counter() = default;
+        counter(counter const&) = delete;
+        counter& operator=(counter const&) = delete;
+
+    private:
+        std::atomic<int32_t> _num_pending = {0};
+    };
+
+    task_scheduler() = default;
+    explicit task_scheduler(size_t num_threads, size_t max_num_tasks = 1 << 15) { initialize(num_threads, max_num_tasks); }
+    ~task_scheduler() override { destroy(); }
+
+    // num_threads: amount of worker threads, 0 for one per hardware thread
+    // max_num_tasks: upper limit of submitted but unfinished tasks, their memory is only reserved in virtual memory
+    //                (at most 65535 if the task pool runs generation checks, e.g. with assertions enabled)
+    void initialize(size_t num_threads = 0, size_t max_num_tasks = 1 << 15);
+
+    // finishes all pending tasks, then joins the worker threads
+    void destroy();
+
+    /// schedules func() for execution on one of the workers
+    /// if c is not nullptr, it is incremented now and decremented once func returned
+    template <class F>
+    void submit(F&& func, counter* c = nullptr);
+
+    /// runs pending tasks on the calling thread until the counter reaches zero
+    void wait(counter& c);
+
+    /// runs a single pending task on the calling thread, returns false if none was found
+    bool try_run_task();
+
+    /// runs chunk(i) for all i in [0, num_chunks) as tasks and waits for them
+    /// the chunk range is split recursively, so idle workers steal large parts first
+    void run_chunks(size_t num_chunks, cc::function_ref<void(size_t)> chunk) override;
+
+    size_t get_num_threads() const override { return _num_workers; }
+
+    /// index of the worker thread calling this function, -1 if it is not a worker of this scheduler
+    int32_t get_current_worker_index() const;
+
+    task_scheduler(task_scheduler const&) = delete;
+    task_scheduler& operator=(task_scheduler const&) = delete;
+    task_scheduler(task_scheduler&&) = delete;
+    task_scheduler& operator=(task_scheduler&&) = delete;
+
+private:
+    struct worker;
+
+    // one cache line, callables of up to 48 bytes are stored inline
+    struct alignas(64) task
+    {
+        void (*execute)(void* callable);
+        counter* dependent;
+        alignas(std::max_align_t) std::byte callable[48];
+    };
+
+    using task_pool_t = cc::atomic_linked_pool<task, false>;
+    using task_handle_t = task_pool_t::handle_t;
+
+    // runs and destroys the callable
+    template <class FuncT>
+    static void _execute_callable(void* callable)
+    {
+        FuncT& func = *static_cast<FuncT*>(callable);
+        func();
+        func.~FuncT();
+    }
+
+    task_handle_t _acquire_task(task*& out_task);
+    void _push_task(task_handle_t handle);
+
+    bool _try_run_task(int32_t worker_index);
+    void _run_task(task_handle_t handle, int32_t worker_index);
+
+    void _split_chunks(size_t begin, size_t end, cc::function_ref<void(size_t)> const& chunk, counter& c);
+
+    void _worker_main(int32_t worker_index);
+    void _park(int32_t worker_index);
+    void _wake_one();
+
+private:
+    worker** _workers = nullptr;
+    size_t _num_workers = 0;
+
+    task_pool_t _task_pool;
+    cc::mpmc_queue<task_handle_t> _injection_queue;
+
+    // parking
+    alignas(64) std::atomic<int32_t> _num_parked = {0};
+    std::atomic<uint64_t> _wake_epoch = {0};
+    std::atomic<bool> _is_stopping = {false};
+    std::mutex _park_mutex;
+    std::condition_variable _park_cv;
+};
+
+//
+// implementation
+
+template <class F>
+void task_scheduler::submit(F&& func, counter* c)
+{
+    using FuncT = std::decay_t<F>;
+    static_assert(std::is_invocable_v<FuncT&>, "task must be callable without arguments");
+
+    task* t;
+    task_handle_t const handle = _acquire_task(t);
+
+    if constexpr (sizeof(FuncT) <= sizeof(task::callable) && alignof(FuncT) <= alignof(std::max_align_t))
+    {
+        new (placement_new, t->callable) FuncT(cc::forward<F>(func));
+        t->execute = &_execute_callable<FuncT>;
+    }
+    else
+    {
+        // too large, stored on the heap
+        using heap_func_t = cc::unique_function<void()>;
+        static_assert(sizeof(heap_func_t) <= sizeof(task::callable), "unique_function does not fit into a task");
+
+        new (placement_new, t->callable) heap_func_t(cc::forward<F>(func));
+        t->execute = &_execute_callable<heap_func_t>;
+    }
+
+    t->dependent = c;
+    if (c)
+        c->add(1);
+
+    _push_task(handle);
+}
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+
+#include <atomic>
+
+#include <clean-core/intrinsics.hh>
+#include <clean-core/macros.hh>
+
+namespace cc
+{
+// FIFO-fair spinlock: threads draw a ticket and wait until it is served
+// waiters back off proportionally to their distance from the head of the line
+// NOTE: all waiters still read the same cache line (see mcs_lock for local spinning)
+//       fairness hands the lock to a specific thread, which degrades badly if that thread is descheduled (more threads than cores)
+struct ticket_lock
+{
+    CC_FORCE_INLINE void lock() noexcept
+    {
+        uint32_t const ticket = _next_ticket.fetch_add(1, std::memory_order_relaxed);
+        while (true)
+        {
+            uint32_t const serving = _now_serving.load(std::memory_order_acquire);
+            if (serving == ticket)
+                return;
+
+            for (auto i = ticket - serving; i > 0; --i)
+                cc::intrin_pause();
+        }
+    }
+
+    CC_FORCE_INLINE bool try_lock() noexcept
+    {
+        // only succeeds if nobody holds or waits for the lock
+        uint32_t serving = _now_serving.load(std::memory_order_relaxed);
+        return _next_ticket.compare_exchange_strong(serving, serving + 1, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    CC_FORCE_INLINE void unlock() noexcept
+    {
+        // only the holder writes _now_serving
+        _now_serving.store(_now_serving.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    ticket_lock() = default;
+    ticket_lock(ticket_lock const& other) = delete;
+    ticket_lock(ticket_lock&& other) noexcept = delete;
+    ticket_lock& operator=(ticket_lock const& other) = delete;
+    ticket_lock& operator=(ticket_lock&& other) noexcept = delete;
+
+private:
+    std::atomic<uint32_t> _next_ticket = {0};
+    std::atomic<uint32_t> _now_serving = {0};
+};
+}
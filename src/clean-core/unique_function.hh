@@ -16,31 +16,37 @@ namespace cc
  * https://godbolt.org/z/8fY3a5
  * https://quick-bench.com/q/sCMOpZNIacJcwOPcCYt0_95Efoc
  *
+ * AllocatorT can be a concrete allocator type to bind allocation calls at compile time (see alloc_vector)
+ *
  * TODO: sbo_ and capped_ versions
  * TODO: deduction guides
  * TODO: member functions
  * TODO: use cc::alloc as default allocator
  */
-template <class Signature>
-struct unique_function;
-template <class Result, class... Args>
-struct unique_function<Result(Args...)>
+template <class Result, class... Args, class AllocatorT>
+struct unique_function<Result(Args...), AllocatorT>
 {
 public:
     unique_function() = default;
     unique_function(decltype(nullptr)) {}
 
     template <class T>
-    unique_function(T&& callable, cc::allocator* alloc = cc::system_allocator)
+    unique_function(T&& callable, AllocatorT* alloc = detail::default_container_allocator<AllocatorT>())
     {
         using CallableT = std::decay_t<T>;
         static_assert(std::is_invocable_r_v<Result, CallableT, Args...>, "argument to cc::unique_function is not callable or has the wrong "
                                                                          "signature");
+        CC_ASSERT(alloc && "no allocator set?");
 
+        // alloc and free are called on AllocatorT directly (instead of new_t / delete_t) so they bind statically if possible
         _func = [](void* ctx, Args&&... args) -> Result { return (*static_cast<CallableT*>(ctx))(cc::forward<Args>(args)...); };
-        _deleter = [](void* ctx, cc::allocator* alloc) { alloc->delete_t<CallableT>(static_cast<CallableT*>(ctx)); };
+        _deleter = [](void* ctx, AllocatorT* alloc)
+        {
+            static_cast<CallableT*>(ctx)->~CallableT();
+            alloc->free_sized(ctx, sizeof(CallableT), alignof(CallableT));
+        };
         _alloc = alloc;
-        _context = alloc->new_t<CallableT>(cc::forward<CallableT>(callable));
+        _context = new (placement_new, alloc->alloc(sizeof(CallableT), alignof(CallableT))) CallableT(cc::forward<CallableT>(callable));
     }
 
     Result operator()(Args... args) const
@@ -72,8 +78,8 @@ public:
 
 private:
     cc::function_ptr<Result(void*, Args&&...)> _func = nullptr;
-    cc::function_ptr<void(void*, cc::allocator*)> _deleter = nullptr;
-    cc::allocator* _alloc = nullptr;
+    cc::function_ptr<void(void*, AllocatorT*)> _deleter = nullptr;
+    AllocatorT* _alloc = nullptr;
     void* _context = nullptr;
 
     void _destroy()
@@ -88,7 +94,7 @@ private:
     unique_function& operator=(unique_function const&) = delete;
 };
 
-template <class T>
+template <class T, class AllocatorT>
 struct unique_function
 {
     static_assert(always_false<T>, "cc::unique_function expects a function signature type");
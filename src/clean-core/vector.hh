@@ -23,6 +23,14 @@ public:
     /// returns a vector with "size" elements that are default-initialized
     [[nodiscard]] static vector defaulted(size_t size) { return vector(size); }
 
+    /// returns a vector with "size" elements, trivial types are left uninitialized
+    [[nodiscard]] static vector for_overwrite(size_t size)
+    {
+        auto v = vector::uninitialized(size);
+        detail::container_default_initialize(size, v._data);
+        return v;
+    }
+
     /// returns a vector with "size" elements that are uninitialized
     /// CAUTION: for non-pod types, you have to know what you're doing (i.e. placement new yourself)
     [[nodiscard]] static vector uninitialized(size_t size)
@@ -81,7 +89,7 @@ public:
     ~vector()
     {
         detail::container_destroy_reverse<T>(this->_data, this->_size);
-        this->_free(this->_data);
+        this->_free(this->_data, this->_capacity);
     }
     vector& operator=(vector const& rhs)
     {
@@ -91,7 +99,7 @@ public:
             // ensure enough memory has been allocated
             if (this->_capacity < rhs._size)
             {
-                this->_free(this->_data);
+                this->_free(this->_data, this->_capacity);
                 this->_data = this->_alloc(rhs._size);
                 this->_capacity = rhs._size;
             }
@@ -103,7 +111,7 @@ public:
     vector& operator=(vector&& rhs) noexcept
     {
         detail::container_destroy_reverse<T>(this->_data, this->_size);
-        this->_free(this->_data);
+        this->_free(this->_data, this->_capacity);
         this->_data = rhs._data;
         this->_size = rhs._size;
         this->_capacity = rhs._capacity;
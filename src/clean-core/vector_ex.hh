@@ -32,6 +32,14 @@ public:
 
     [[nodiscard]] static vector_ex defaulted(size_t size) { return vector_ex(size); }
 
+    /// returns a vector with "size" elements, trivial types are left uninitialized
+    [[nodiscard]] static vector_ex for_overwrite(size_t size)
+    {
+        auto v = vector_ex::uninitialized(size);
+        detail::container_default_initialize(size, v._data);
+        return v;
+    }
+
     [[nodiscard]] static vector_ex uninitialized(size_t size)
     {
         vector_ex v;
@@ -79,7 +87,7 @@ public:
     ~vector_ex()
     {
         detail::container_destroy_reverse<element_t>(this->_data, this->_size);
-        this->_free(this->_data);
+        this->_free(this->_data, this->_capacity);
     }
     vector_ex& operator=(vector_ex const& rhs)
     {
@@ -89,7 +97,7 @@ public:
             // ensure enough memory has been allocated
             if (this->_capacity < rhs._size)
             {
-                this->_free(this->_data);
+                this->_free(this->_data, this->_capacity);
                 this->_data = this->_alloc(rhs._size);
                 this->_capacity = rhs._size;
             }
@@ -101,7 +109,7 @@ public:
     vector_ex& operator=(vector_ex&& rhs) noexcept
     {
         detail::container_destroy_reverse<element_t>(this->_data, this->_size);
-        this->_free(this->_data);
+        this->_free(this->_data, this->_capacity);
         this->_data = rhs._data;
         this->_size = rhs._size;
         this->_capacity = rhs._capacity;
@@ -1,13 +1,40 @@
+#include <nexus/app.hh>
 #include <nexus/fuzz_test.hh>
 #include <nexus/test.hh>
 
+#ifdef HAS_CTRACER
+#include <ctracer/trace.hh>
+#include <rich-log/log.hh>
+#endif
+
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
+
+#include <atomic>
+#include <filesystem>
+#include <string>
+#include <thread>
 
+#include <clean-core/alloc_array.hh>
+#include <clean-core/alloc_vector.hh>
 #include <clean-core/allocator.hh>
+#include <clean-core/allocators/atomic_linear_allocator.hh>
+#include <clean-core/allocators/atomic_pool_allocator.hh>
+#include <clean-core/allocators/atomic_virtual_linear_allocator.hh>
 #include <clean-core/allocators/linear_allocator.hh>
+#include <clean-core/allocators/mapped_arena_allocator.hh>
+#include <clean-core/allocators/object_arena.hh>
 #include <clean-core/allocators/stack_allocator.hh>
+#include <clean-core/allocators/tlsf_allocator.hh>
+#include <clean-core/allocators/virtual_linear_allocator.hh>
+#include <clean-core/allocators/virtual_stack_allocator.hh>
+#include <clean-core/experimental/ringbuffer.hh>
+#include <clean-core/scratch_scope.hh>
+#include <clean-core/string.hh>
+#include <clean-core/unique_function.hh>
 #include <clean-core/utility.hh>
+#include <clean-core/vector.hh>
 
 namespace
 {
@@ -234,6 +261,104 @@ void test_fuzz_allocations(cc::allocator* alloc, tg::rng& rng, unsigned buffer_s
         }
     }
 }
+
+// allocates a batch, verifies the buffers don't overlap, and frees them again
+void test_batch_integrity(cc::allocator* alloc, unsigned size, unsigned align)
+{
+    std::byte* ptrs[16] = {};
+    alloc->alloc_batch(size, align, ptrs);
+
+    for (auto i = 0u; i < 16; ++i)
+    {
+        CHECK(ptrs[i] != nullptr);
+        CHECK(is_aligned(ptrs[i], align));
+        write_memory_pattern(ptrs[i], size);
+    }
+
+    for (auto i = 0u; i < 16; ++i)
+        CHECK(verify_memory_pattern(ptrs[i], size));
+
+    void* free_ptrs[16] = {};
+    for (auto i = 0u; i < 16; ++i)
+        free_ptrs[i] = ptrs[i];
+
+    alloc->free_batch(free_ptrs);
+}
+
+// threads repeatedly take batches from a pool that is too small for all of them and return them
+// returns true if no block was handed out twice at the same time and short batches were reported as nullptr
+bool test_pool_batch_concurrent(unsigned num_threads, unsigned num_iterations)
+{
+    constexpr size_t block_size = 64;
+    constexpr size_t num_blocks = 64;
+    constexpr size_t batch_size = 24;
+
+    alignas(64) std::byte buffer[block_size * num_blocks];
+    cc::atomic_pool_allocator pool(buffer, block_size);
+
+    auto owners = cc::alloc_array<std::atomic<uint32_t>>::defaulted(num_blocks);
+    std::atomic<bool> is_ok = {true};
+
+    cc::vector<std::thread> threads;
+    for (auto t = 0u; t < num_threads; ++t)
+        threads.emplace_back([&, t] {
+            uint32_t const owner = t + 1;
+            for (auto i = 0u; i < num_iterations; ++i)
+            {
+                std::byte* ptrs[batch_size] = {};
+                void* free_ptrs[batch_size] = {};
+
+                // single blocks in between, also racing with the batches
+                bool const is_single = i % 4 == 0;
+                pool.alloc_batch(block_size, block_size, cc::span<std::byte*>(ptrs, is_single ? 1 : batch_size));
+
+                bool is_short = false;
+                for (auto j = 0u; j < batch_size; ++j)
+                {
+                    if (!ptrs[j])
+                    {
+                        is_short = true;
+                        continue;
+                    }
+
+                    // nullptrs are only allowed at the end of the batch
+                    uint32_t expected = 0;
+                    if (is_short || !owners[pool.get_node_index(ptrs[j])].compare_exchange_strong(expected, owner))
+                        is_ok.store(false);
+
+                    // overwrite the in-place next pointer as users do
+                    std::memset(ptrs[j], int(owner), block_size);
+                    free_ptrs[j] = ptrs[j];
+                }
+
+                for (auto j = 0u; j < batch_size; ++j)
+                {
+                    if (!ptrs[j])
+                        continue;
+
+                    uint32_t expected = owner;
+                    if (ptrs[j][block_size - 1] != std::byte(owner) || !owners[pool.get_node_index(ptrs[j])].compare_exchange_strong(expected, 0))
+                        is_ok.store(false);
+                }
+
+                if (is_single)
+                    pool.free(free_ptrs[0]);
+                else
+                    pool.free_batch(free_ptrs);
+            }
+        });
+    for (auto& t : threads)
+        t.join();
+
+    // all blocks are back
+    std::byte* ptrs[num_blocks + 1] = {};
+    pool.alloc_batch(block_size, block_size, ptrs);
+    for (auto j = 0u; j < num_blocks; ++j)
+        if (!ptrs[j] || owners[pool.get_node_index(ptrs[j])].load() != 0)
+            return false;
+
+    return is_ok.load() && ptrs[num_blocks] == nullptr && pool.is_full();
+}
 }
 
 TEST("cc::allocator")
@@ -284,3 +409,647 @@ TEST("cc::stack_allocator")
     stackalloc.realloc(buf_realloc, 1000, 100);
     stackalloc.free(buf_realloc);
 }
+
+TEST("cc::atomic_virtual_linear_allocator")
+{
+    cc::atomic_virtual_linear_allocator alloc(64 * 1024 * 1024, 64 * 1024);
+
+    CHECK(test_alignment_requirements(&alloc));
+
+    test_basic_integrity(&alloc, true);
+
+    // larger than a chunk
+    std::byte* const big_buf = alloc.alloc(300 * 1024, 64);
+    write_memory_pattern(big_buf, 300 * 1024);
+    CHECK(verify_memory_pattern(big_buf, 300 * 1024));
+
+    // in-place realloc of the latest allocation
+    std::byte* const buf_realloc = alloc.alloc(250);
+    CHECK(alloc.realloc(buf_realloc, 500) == buf_realloc);
+    size_t realloc_size = 0;
+    CHECK(alloc.get_allocation_size(buf_realloc, realloc_size));
+    CHECK(realloc_size == 500);
+
+    CHECK(alloc.reset() > 0);
+    CHECK(alloc.get_allocated_size_bytes() == 0);
+    CHECK(alloc.get_physical_size_bytes() > 0);
+
+    // concurrent allocations from multiple threads
+    unsigned const num_threads = 8;
+    unsigned const num_allocs_per_thread = 2000;
+    bool thread_results[num_threads] = {};
+
+    std::thread threads[num_threads];
+    for (auto t = 0u; t < num_threads; ++t)
+    {
+        threads[t] = std::thread(
+            [&, t]
+            {
+                bool success = true;
+                for (auto i = 0u; i < num_allocs_per_thread; ++i)
+                {
+                    auto const size = 16 + (i * 7 + t * 13) % 200;
+                    std::byte* const buf = alloc.alloc(size);
+                    success = success && is_aligned(buf, alignof(std::max_align_t));
+                    write_memory_pattern(buf, size);
+
+                    success = success && verify_memory_pattern(buf, size);
+                }
+                thread_results[t] = success;
+            });
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    for (auto t = 0u; t < num_threads; ++t)
+        CHECK(thread_results[t]);
+
+    CHECK(alloc.get_allocated_size_bytes() >= num_threads * num_allocs_per_thread * 16);
+
+    alloc.reset();
+    CHECK(alloc.decommit_idle_memory() > 0);
+    CHECK(alloc.get_physical_size_bytes() == 0);
+}
+
+TEST("cc::object_arena")
+{
+    cc::object_arena arena(64 << 20);
+
+    cc::vector<int> destroyed;
+    struct tracked
+    {
+        cc::vector<int>* destroyed;
+        int id;
+        cc::string name;
+
+        tracked(cc::vector<int>* destroyed, int id) : destroyed(destroyed), id(id), name("a string that does not fit the sbo buffer") {}
+        ~tracked() { destroyed->push_back(id); }
+    };
+
+    for (auto r = 0; r < 3; ++r)
+    {
+        destroyed.clear();
+
+        // trivial types do not record a destructor
+        int* const i = arena.new_t<int>(17);
+        auto* const ints = arena.new_array<int>(100);
+        CHECK(*i == 17);
+        CHECK(ints[99] == 0);
+        CHECK(arena.get_num_destructors() == 0);
+
+        auto* const a = arena.new_t<tracked>(&destroyed, 0);
+        auto* const b = arena.new_t<tracked>(&destroyed, 1);
+        auto* const arr = arena.new_array<cc::string>(10);
+        arr[9] = "another string that does not fit the sbo buffer";
+        CHECK(a->name == b->name);
+        CHECK(arena.get_num_destructors() == 3);
+
+        // containers can use the arena for their memory as well
+        auto* const v = arena.new_t<cc::alloc_vector<int>>(&arena);
+        for (auto k = 0; k < 1000; ++k)
+            v->push_back(k);
+        CHECK(v->back() == 999);
+        CHECK(arena.get_num_destructors() == 4);
+
+        // over-aligned objects
+        struct alignas(64) aligned_type
+        {
+            cc::string s;
+        };
+        auto* const aligned = arena.new_t<aligned_type>();
+        CHECK(cc::is_aligned(aligned, 64));
+
+        CHECK(destroyed.empty());
+        CHECK(arena.reset() > 0);
+
+        // reverse order of construction
+        CHECK(destroyed == cc::vector<int>{1, 0});
+        CHECK(arena.get_num_destructors() == 0);
+        CHECK(arena.get_allocated_size_bytes() == 0);
+    }
+
+    // objects alive at destruction are destroyed as well
+    destroyed.clear();
+    {
+        cc::object_arena scoped_arena(1 << 20);
+        (void)scoped_arena.new_t<tracked>(&destroyed, 7);
+    }
+    CHECK(destroyed == cc::vector<int>{7});
+}
+
+#ifdef HAS_CTRACER
+APP("cc::object_arena vs heap")
+{
+    auto const num_objects = 100'000;
+    auto const num_runs = 10;
+
+    struct node
+    {
+        cc::string name;
+        int value = 0;
+    };
+
+    cc::object_arena arena(size_t(1) << 30);
+    cc::virtual_linear_allocator linear(size_t(1) << 30);
+    cc::vector<node*> nodes;
+    nodes.reserve(num_objects);
+
+    auto const measure = [&](char const* name, auto&& run)
+    {
+        double total_cycles = 0;
+        for (auto r = 0; r < num_runs; ++r)
+        {
+            ct::cycler c;
+            run();
+            total_cycles += c.elapsed_cycles();
+        }
+        LOG("%s: %.2f cycles per object (alloc + destroy)", name, total_cycles / (double(num_runs) * num_objects));
+    };
+
+    measure("trivial: virtual_linear_allocator", [&] {
+        for (auto i = 0; i < num_objects; ++i)
+            *reinterpret_cast<int*>(linear.alloc(sizeof(int), alignof(int))) = i;
+        linear.reset();
+    });
+    measure("trivial: object_arena", [&] {
+        for (auto i = 0; i < num_objects; ++i)
+            (void)arena.new_t<int>(i);
+        arena.reset();
+    });
+    measure("non-trivial: new / delete", [&] {
+        for (auto i = 0; i < num_objects; ++i)
+            nodes.push_back(new node());
+        for (auto* n : nodes)
+            delete n;
+        nodes.clear();
+    });
+    measure("non-trivial: object_arena", [&] {
+        for (auto i = 0; i < num_objects; ++i)
+            (void)arena.new_t<node>();
+        arena.reset();
+    });
+}
+#endif
+
+TEST("cc::virtual allocator trim")
+{
+    size_t const mb = 1 << 20;
+
+    for (auto const lazy : {true, false})
+    {
+        cc::virtual_linear_allocator alloc(256 * mb);
+        alloc.set_trim_policy({4, 0.25f, lazy});
+
+        // one spike, then low usage
+        alloc.alloc(16 * mb);
+        alloc.reset();
+        CHECK(alloc.get_physical_size_bytes() >= 16 * mb);
+
+        // the spike is remembered for at least one window
+        for (auto i = 0; i < 4; ++i)
+        {
+            std::memset(alloc.alloc(mb), 0xAB, mb);
+            alloc.reset();
+            CHECK(alloc.trim() == 0);
+            CHECK(alloc.get_trim_peak_size_bytes() >= 16 * mb);
+        }
+
+        // and forgotten after two
+        size_t num_trimmed_bytes = 0;
+        for (auto i = 0; i < 5; ++i)
+        {
+            std::memset(alloc.alloc(mb), 0xAB, mb);
+            alloc.reset();
+            num_trimmed_bytes += alloc.trim();
+        }
+        CHECK(num_trimmed_bytes >= 14 * mb);
+        CHECK(alloc.get_trim_peak_size_bytes() < 2 * mb);
+        CHECK(alloc.get_physical_size_bytes() >= mb);
+        CHECK(alloc.get_physical_size_bytes() <= 2 * mb);
+
+        // trimmed memory is usable again
+        auto* const p = alloc.alloc(32 * mb);
+        std::memset(p, 0xCD, 32 * mb);
+        CHECK(p[32 * mb - 1] == std::byte(0xCD));
+
+        // never trims allocated memory
+        CHECK(alloc.trim() == 0);
+        CHECK(alloc.get_physical_size_bytes() >= alloc.get_allocated_size_bytes());
+    }
+
+    {
+        cc::virtual_stack_allocator alloc(256 * mb);
+        alloc.set_trim_policy({2, 0.f, true});
+
+        auto* const p = alloc.alloc(8 * mb);
+        alloc.free(p);
+        for (auto i = 0; i < 5; ++i)
+        {
+            auto const marker = alloc.get_marker();
+            alloc.alloc(mb / 2);
+            alloc.free_to_marker(marker);
+            alloc.trim();
+        }
+        CHECK(alloc.get_trim_peak_size_bytes() < mb);
+        CHECK(alloc.get_physical_size_bytes() <= mb);
+    }
+
+    // chunks smaller than a page, the live data shares its page with the idle memory
+    for (auto const use_trim : {false, true})
+    {
+        cc::virtual_stack_allocator alloc(mb, 1024);
+        alloc.set_trim_policy({1, 0.f, false});
+
+        auto* const p = alloc.alloc(1500);
+        std::memset(p, 0xAB, 1500);
+
+        auto const marker = alloc.get_marker();
+        std::memset(alloc.alloc(16 * 1024), 0xCD, 16 * 1024);
+        alloc.free_to_marker(marker);
+
+        if (use_trim)
+        {
+            // the peak is remembered for up to two windows
+            for (auto i = 0; i < 3; ++i)
+                alloc.trim();
+        }
+        else
+            alloc.decommit_idle_memory();
+
+        CHECK(alloc.get_physical_size_bytes() < 16 * 1024);
+        CHECK(p[0] == std::byte(0xAB));
+        CHECK(p[1499] == std::byte(0xAB));
+
+        // the memory after it is usable again
+        auto* const q = alloc.alloc(8 * 1024);
+        std::memset(q, 0xEF, 8 * 1024);
+        CHECK(p[1499] == std::byte(0xAB));
+    }
+}
+
+#if defined(CC_OS_LINUX) || defined(CC_OS_APPLE)
+TEST("cc::mapped_arena_allocator")
+{
+    // persistent linked list, links are stored as offsets
+    struct list_node
+    {
+        uint64_t next;
+        int value;
+    };
+
+    auto const path = (std::filesystem::temp_directory_path() / "cc_mapped_arena_allocator_test.bin").string();
+    std::remove(path.c_str());
+
+    {
+        cc::mapped_arena_allocator arena;
+        CHECK(arena.initialize(path.c_str(), 64 * 1024 * 1024, 64 * 1024));
+        CHECK(!arena.is_reattached());
+        CHECK(arena.get_root() == nullptr);
+        CHECK(arena.get_file_size_bytes() == 64 * 1024);
+
+        CHECK(test_alignment_requirements(&arena));
+        test_basic_integrity(&arena, true);
+        arena.reset();
+
+        // grows the file
+        uint64_t head = 0;
+        for (auto i = 0; i < 10000; ++i)
+        {
+            auto* const n = arena.new_t<list_node>();
+            n->next = head;
+            n->value = i;
+            head = arena.to_offset(n);
+        }
+        CHECK(arena.get_file_size_bytes() > 64 * 1024);
+
+        std::byte* const big_buf = arena.alloc(300 * 1024);
+        write_memory_pattern(big_buf, 300 * 1024);
+        CHECK(arena.realloc(big_buf, 500 * 1024) == big_buf);
+
+        arena.set_root(arena.from_offset(head));
+        arena.checkpoint();
+    }
+
+    {
+        cc::mapped_arena_allocator arena;
+        CHECK(arena.initialize(path.c_str(), 64 * 1024 * 1024));
+        CHECK(arena.is_reattached());
+
+        auto expected = 9999;
+        auto valid = true;
+        for (auto* n = reinterpret_cast<list_node*>(arena.get_root()); n; n = reinterpret_cast<list_node*>(arena.from_offset(n->next)))
+            valid = valid && n->value == expected--;
+        CHECK(valid);
+        CHECK(expected == -1);
+
+        // allocation continues after the reattached heap
+        size_t const allocated_before = arena.get_allocated_size_bytes();
+        CHECK(arena.alloc(16) != nullptr);
+        CHECK(arena.get_allocated_size_bytes() > allocated_before);
+    }
+
+    // file too large for the reserved range
+    {
+        cc::mapped_arena_allocator arena;
+        CHECK(!arena.initialize(path.c_str(), 64 * 1024));
+    }
+
+    std::remove(path.c_str());
+
+    // not an arena
+    {
+        auto const invalid_path = path + ".invalid";
+        std::FILE* f = std::fopen(invalid_path.c_str(), "wb");
+        std::fputs("no arena", f);
+        std::fclose(f);
+
+        cc::mapped_arena_allocator arena;
+        CHECK(!arena.initialize(invalid_path.c_str(), 64 * 1024 * 1024));
+        std::remove(invalid_path.c_str());
+    }
+}
+#endif
+
+TEST("cc::scratch_scope")
+{
+    {
+        cc::scratch_scope scratch;
+
+        CHECK(test_alignment_requirements(scratch.allocator()));
+
+        test_basic_integrity(scratch.allocator(), false);
+        size_t const outer_size = scratch.get_allocated_size_bytes();
+        CHECK(outer_size > 0);
+
+        // containers can freely grow, the memory of old buffers is released with the scope
+        cc::alloc_vector<int> v(scratch.allocator());
+        for (auto i = 0; i < 1000; ++i)
+            v.push_back(i);
+
+        bool values_correct = true;
+        for (auto i = 0; i < 1000; ++i)
+            values_correct = values_correct && v[i] == i;
+        CHECK(values_correct);
+
+        {
+            cc::scratch_scope inner_scratch;
+            CHECK(inner_scratch.get_allocated_size_bytes() == 0);
+
+            std::byte* const buf = inner_scratch.alloc(4096);
+            write_memory_pattern(buf, 4096);
+            CHECK(verify_memory_pattern(buf, 4096));
+            CHECK(inner_scratch.get_allocated_size_bytes() >= 4096);
+
+            // in-place growth of the most recent allocation
+            CHECK(inner_scratch.realloc(buf, 8192) == buf);
+            CHECK(verify_memory_pattern(buf, 4096));
+        }
+
+        // the inner scope rewound only its own allocations
+        CHECK(v.size() == 1000);
+        CHECK(v.front() == 0);
+        CHECK(v.back() == 999);
+    }
+
+    cc::scratch_scope::decommit_idle_memory();
+
+    {
+        cc::scratch_scope scratch;
+        CHECK(scratch.get_allocated_size_bytes() == 0);
+    }
+}
+
+TEST("cc::allocator batch and sized free")
+{
+    // default implementations
+    {
+        std::byte stackalloc_buf[4096];
+        cc::stack_allocator stackalloc(stackalloc_buf);
+
+        std::byte* const buf = stackalloc.alloc(100);
+        stackalloc.free_sized(buf, 100);
+    }
+
+    {
+        std::byte linalloc_buf[4096];
+        cc::linear_allocator linalloc(linalloc_buf);
+        test_batch_integrity(&linalloc, 24, 8);
+        test_batch_integrity(&linalloc, 20, 32);
+
+        // the batch is a single contiguous bump
+        std::byte* ptrs[4] = {};
+        linalloc.reset();
+        linalloc.alloc_batch(32, 16, ptrs);
+        CHECK(ptrs[1] == ptrs[0] + 32);
+        CHECK(ptrs[3] == ptrs[0] + 96);
+        CHECK(linalloc.allocated_size() == 128);
+    }
+
+    {
+        std::byte linalloc_buf[4096];
+        cc::atomic_linear_allocator linalloc(linalloc_buf);
+        test_batch_integrity(&linalloc, 24, 8);
+        test_batch_integrity(&linalloc, 20, 32);
+
+        size_t alloc_size = 0;
+        std::byte* ptrs[2] = {};
+        linalloc.alloc_batch(40, 8, ptrs);
+        CHECK(linalloc.get_allocation_size(ptrs[1], alloc_size));
+        CHECK(alloc_size == 40);
+    }
+
+    {
+        alignas(64) std::byte pool_buf[64 * 32];
+        cc::atomic_pool_allocator pool(pool_buf, 64);
+        test_batch_integrity(&pool, 64, 64);
+
+        // the pool is exactly full
+        std::byte* ptrs[32] = {};
+        pool.alloc_batch(64, 64, ptrs);
+        CHECK(pool.is_full());
+
+        void* free_ptrs[32] = {};
+        for (auto i = 0u; i < 32; ++i)
+            free_ptrs[i] = ptrs[i];
+        pool.free_batch(free_ptrs);
+        CHECK(!pool.is_full());
+
+        std::byte* const single = pool.alloc(48);
+        pool.free_sized(single, 48);
+
+        pool.alloc_batch(64, 64, ptrs);
+        CHECK(pool.is_full());
+
+        // a short batch is reported as nullptrs
+        std::byte* more_ptrs[2] = {};
+        pool.alloc_batch(64, 64, more_ptrs);
+        CHECK(more_ptrs[0] == nullptr);
+        CHECK(more_ptrs[1] == nullptr);
+
+        for (auto i = 0u; i < 32; ++i)
+            free_ptrs[i] = i < 31 ? ptrs[i] : nullptr;
+        pool.free_batch(free_ptrs);
+
+        pool.alloc_batch(64, 64, more_ptrs);
+        CHECK(more_ptrs[0] == ptrs[0]);
+        CHECK(more_ptrs[1] != nullptr);
+
+        free_ptrs[0] = more_ptrs[0];
+        free_ptrs[1] = more_ptrs[1];
+        pool.free_batch(cc::span<void* const>(free_ptrs, 2));
+
+        // concurrent batches, more requested than the pool holds
+        CHECK(test_pool_batch_concurrent(4, 20000));
+    }
+
+    {
+        alignas(16) std::byte tlsf_buf[64 * 1024];
+        cc::tlsf_allocator tlsf(tlsf_buf);
+        test_batch_integrity(&tlsf, 100, 16);
+
+        std::byte* const buf = tlsf.alloc(100);
+        tlsf.free_sized(buf, 100);
+        CHECK(tlsf.validate_heap());
+
+        // sized frees of containers
+        {
+            cc::alloc_vector<int> v(&tlsf);
+            for (auto i = 0; i < 100; ++i)
+                v.push_back(i);
+            v.shrink_to_fit();
+        }
+        CHECK(tlsf.validate_heap());
+    }
+}
+
+TEST("cc::allocator in-place growth")
+{
+    alignas(16) std::byte tlsf_buf[256 * 1024];
+    cc::tlsf_allocator tlsf(tlsf_buf);
+
+    // TLSF merges with the free next block
+    auto const has_content = [](std::byte const* p) { return p[0] == std::byte(0xAB) && p[99] == std::byte(0xAB); };
+
+    std::byte* const buf = tlsf.alloc(100);
+    std::memset(buf, 0xAB, 100);
+    CHECK(tlsf.try_resize_in_place(buf, 1000));
+    CHECK(tlsf.try_realloc(buf, 2000) == buf);
+    CHECK(has_content(buf));
+
+    // blocked by a used neighbor: try_resize_in_place fails, try_realloc moves
+    std::byte* const blocker = tlsf.alloc(100);
+    CHECK(!tlsf.try_resize_in_place(buf, 8000));
+    size_t buf_size = 0;
+    CHECK(tlsf.get_allocation_size(buf, buf_size));
+    CHECK(buf_size >= 2000 && buf_size < 8000);
+    std::byte* const moved = tlsf.try_realloc(buf, 8000);
+    CHECK(moved != nullptr);
+    CHECK(moved != buf);
+    CHECK(has_content(moved));
+
+    // too large: fails without touching the buffer
+    CHECK(tlsf.try_realloc(moved, 1024 * 1024) == nullptr);
+    CHECK(has_content(moved));
+
+    // shrinking always works
+    CHECK(tlsf.try_resize_in_place(moved, 50));
+    tlsf.free(moved);
+    tlsf.free(blocker);
+    CHECK(tlsf.validate_heap());
+
+    // vectors of non-trivially copyable types grow without moving their elements
+    {
+        cc::alloc_vector<cc::string> v(&tlsf);
+        v.push_back("first");
+        v.reserve(2);
+        cc::string const* const data = v.data();
+        for (auto i = 0; i < 1000; ++i)
+            v.push_back("element");
+        CHECK(v.data() == data);
+        CHECK(v[0] == "first");
+        CHECK(v[1000] == "element");
+
+        v.resize(10);
+        v.shrink_to_fit();
+        CHECK(v.data() == data);
+        CHECK(v.capacity() == 10);
+    }
+    CHECK(tlsf.validate_heap());
+
+    // linear allocators grow their most recent allocation
+    std::byte linalloc_buf[4096];
+    cc::linear_allocator linalloc(linalloc_buf);
+    {
+        cc::alloc_vector<cc::string> v(&linalloc);
+        v.push_back("first");
+        cc::string const* const data = v.data();
+        for (auto i = 0; i < 50; ++i)
+            v.push_back("element");
+        CHECK(v.data() == data);
+        CHECK(linalloc.allocated_size() == v.capacity() * sizeof(cc::string));
+    }
+}
+
+TEST("cc::allocator static container binding")
+{
+    std::byte linalloc_buf[4096];
+    cc::linear_allocator linalloc(linalloc_buf);
+
+    {
+        cc::alloc_vector<int, cc::linear_allocator> v(&linalloc);
+        for (auto i = 0; i < 100; ++i)
+            v.push_back(i);
+
+        CHECK(v.allocator() == &linalloc);
+        CHECK(v.size() == 100);
+        CHECK(v[99] == 99);
+        CHECK(linalloc.allocated_size() >= 100 * sizeof(int));
+
+        // moved-from containers are left without allocator
+        cc::alloc_vector<int, cc::linear_allocator> v2 = cc::move(v);
+        CHECK(v2.allocator() == &linalloc);
+        CHECK(v.allocator() == nullptr);
+        CHECK(v2[42] == 42);
+    }
+
+    {
+        auto a = cc::alloc_array<int, cc::linear_allocator>::filled(10, 7, &linalloc);
+        CHECK(a.size() == 10);
+        CHECK(a[9] == 7);
+
+        cc::ringbuffer<int, cc::linear_allocator> rb(&linalloc);
+        for (auto i = 0; i < 10; ++i)
+            rb.push_back(i);
+        CHECK(rb.size() == 10);
+        CHECK(rb.pop_front() == 0);
+    }
+
+    {
+        std::byte stackalloc_buf[1024];
+        cc::stack_allocator stackalloc(stackalloc_buf);
+
+        int counter = 0;
+        {
+            cc::unique_function<void(int), cc::stack_allocator> f([&counter](int i) { counter += i; }, &stackalloc);
+            f(3);
+            f(4);
+        }
+        CHECK(counter == 7);
+
+        // the callable was popped on destruction
+        std::byte* const buf = stackalloc.alloc(16);
+        stackalloc.free(buf);
+        CHECK(buf - stackalloc_buf <= ptrdiff_t(alignof(std::max_align_t) + sizeof(int64_t)));
+    }
+
+    // default constructed containers without allocator are valid (and empty)
+    {
+        cc::alloc_vector<int, cc::linear_allocator> v;
+        cc::alloc_array<int, cc::linear_allocator> a;
+        cc::ringbuffer<int, cc::linear_allocator> rb;
+        CHECK(v.empty());
+        CHECK(a.empty());
+        CHECK(rb.empty());
+    }
+}
@@ -0,0 +1,418 @@
+#include <nexus/app.hh>
+#include <nexus/test.hh>
+
+#include <thread>
+
+#ifdef HAS_CTRACER
+#include <ctracer/trace.hh>
+#include <rich-log/log.hh>
+#endif
+
+#include <clean-core/array.hh>
+#include <clean-core/atomic_linked_pool.hh>
+#include <clean-core/vector.hh>
+
+namespace
+{
+struct pool_node
+{
+    int value = 7;
+    char padding[60];
+};
+
+// every thread acquires and releases its own set of nodes, writing a thread-specific value
+template <class PoolT>
+bool test_concurrent_acquire_release(PoolT& pool, unsigned num_threads, unsigned num_nodes_per_thread, unsigned num_rounds)
+{
+    cc::vector<std::thread> threads;
+    cc::vector<int> results;
+    results.resize(num_threads);
+
+    for (auto t = 0u; t < num_threads; ++t)
+    {
+        threads.emplace_back(
+            [&, t]
+            {
+                cc::vector<typename PoolT::handle_t> handles;
+                bool success = true;
+                for (auto r = 0u; r < num_rounds; ++r)
+                {
+                    for (auto i = 0u; i < num_nodes_per_thread; ++i)
+                    {
+                        auto const h = pool.acquire();
+                        pool.get(h).value = int(t * num_nodes_per_thread + i);
+                        handles.push_back(h);
+                    }
+
+                    for (auto i = 0u; i < num_nodes_per_thread; ++i)
+                        success = success && pool.get(handles[i]).value == int(t * num_nodes_per_thread + i);
+
+                    for (auto h : handles)
+                        pool.release(h);
+                    handles.clear();
+                }
+                results[t] = success;
+            });
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    for (auto r : results)
+        if (!r)
+            return false;
+
+    return true;
+}
+}
+
+TEST("cc::atomic_linked_pool")
+{
+    cc::atomic_linked_pool<pool_node> pool(64);
+    CHECK(!pool.is_growable());
+    CHECK(pool.max_size() == 64);
+    CHECK(pool.committed_size() == 64);
+
+    auto const h0 = pool.acquire();
+    auto const h1 = pool.acquire();
+    CHECK(h0 != h1);
+    CHECK(pool.get(h0).value == 7);
+
+    pool.get(h1).value = 5;
+    CHECK(pool.iterate_allocated_nodes([](pool_node&) {}) == 2);
+
+    pool.release(h0);
+    CHECK(pool.iterate_allocated_nodes([](pool_node&) {}) == 1);
+
+    cc::vector<cc::atomic_linked_pool<pool_node>::handle_t> handles;
+    while (!pool.is_full())
+        handles.push_back(pool.acquire());
+    CHECK(handles.size() == 63);
+
+    CHECK(pool.release_all() == 64);
+
+    CHECK(test_concurrent_acquire_release(pool, 4, 16, 100));
+}
+
+TEST("cc::atomic_linked_pool growable")
+{
+    cc::atomic_linked_pool<pool_node> pool;
+    pool.initialize_growable(10000, 4096);
+    CHECK(pool.is_growable());
+    CHECK(pool.max_size() == 10000);
+    CHECK(pool.committed_size() == 0);
+
+    auto const h0 = pool.acquire();
+    CHECK(pool.get(h0).value == 7);
+    CHECK(pool.committed_size() == 4096 / sizeof(pool_node));
+
+    // pointers stay stable while growing
+    pool_node* const p0 = &pool.get(h0);
+    cc::vector<cc::atomic_linked_pool<pool_node>::handle_t> handles;
+    for (auto i = 0; i < 1000; ++i)
+    {
+        auto const h = pool.acquire();
+        pool.get(h).value = i;
+        handles.push_back(h);
+    }
+    CHECK(&pool.get(h0) == p0);
+    CHECK(pool.committed_size() >= 1001);
+    CHECK(pool.committed_size() < 10000);
+
+    auto valid = true;
+    for (auto i = 0; i < 1000; ++i)
+        valid = valid && pool.get(handles[i]).value == i;
+    CHECK(valid);
+    CHECK(pool.iterate_allocated_nodes([](pool_node&) {}) == 1001);
+
+    // released nodes are reused before growing further
+    size_t const committed = pool.committed_size();
+    for (auto h : handles)
+        pool.release(h);
+    for (auto i = 0; i < 1000; ++i)
+        handles[i] = pool.acquire();
+    CHECK(pool.committed_size() == committed);
+    CHECK(pool.iterate_allocated_nodes([](pool_node&) {}) == 1001);
+
+    for (auto h : handles)
+        pool.release(h);
+    pool.release(h0);
+    CHECK(pool.iterate_allocated_nodes([](pool_node&) {}) == 0);
+
+    // growth from multiple threads at once
+    CHECK(test_concurrent_acquire_release(pool, 8, 1000, 5));
+    CHECK(pool.committed_size() <= 10000);
+
+    // default: up to the limit of the index type
+    cc::atomic_linked_pool<int> large_pool;
+    large_pool.initialize_growable();
+    CHECK(large_pool.max_size() >= 65535);
+    CHECK(large_pool.committed_size() == 0);
+    large_pool.release(large_pool.acquire());
+}
+
+TEST("cc::atomic_linked_pool bulk")
+{
+    cc::atomic_linked_pool<pool_node> pool(1024);
+
+    cc::array<cc::atomic_linked_pool<pool_node>::handle_t, 100> handles;
+    pool.acquire_n(handles);
+    CHECK(pool.iterate_allocated_nodes([](pool_node&) {}) == 100);
+
+    auto valid = true;
+    for (auto i = 0; i < 100; ++i)
+    {
+        valid = valid && pool.get(handles[i]).value == 7;
+        pool.get(handles[i]).value = i;
+    }
+    CHECK(valid);
+
+    // all handles refer to distinct nodes
+    for (auto i = 0; i < 100; ++i)
+        valid = valid && pool.get(handles[i]).value == i;
+    CHECK(valid);
+
+    pool.release_n(handles);
+    CHECK(pool.iterate_allocated_nodes([](pool_node&) {}) == 0);
+
+    // more than the free list holds in a growable pool
+    cc::atomic_linked_pool<pool_node> growable_pool;
+    growable_pool.initialize_growable(1000, 4096);
+    auto const h = growable_pool.acquire();
+    growable_pool.release(h);
+    growable_pool.acquire_n(handles);
+    CHECK(growable_pool.iterate_allocated_nodes([](pool_node&) {}) == 100);
+    growable_pool.release_n(handles);
+
+    // thread caches
+    {
+        cc::atomic_linked_pool<pool_node>::thread_cache cache(pool);
+        for (auto i = 0; i < 100; ++i)
+        {
+            handles[i] = cache.acquire();
+            pool.get(handles[i]).value = i;
+        }
+
+        for (auto i = 0; i < 100; ++i)
+            valid = valid && pool.get(handles[i]).value == i;
+        CHECK(valid);
+
+        for (auto hh : handles)
+            cache.release(hh);
+
+        cache.flush();
+        CHECK(pool.iterate_allocated_nodes([](pool_node&) {}) == 0);
+    }
+
+    cc::vector<std::thread> threads;
+    cc::vector<int> results;
+    results.resize(8);
+    for (auto t = 0; t < 8; ++t)
+    {
+        threads.emplace_back(
+            [&, t]
+            {
+                cc::atomic_linked_pool<pool_node>::thread_cache cache(pool);
+                cc::array<cc::atomic_linked_pool<pool_node>::handle_t, 20> thread_handles;
+                bool success = true;
+                for (auto r = 0; r < 1000; ++r)
+                {
+                    for (auto i = 0; i < 20; ++i)
+                    {
+                        thread_handles[i] = r % 2 ? cache.acquire() : pool.acquire();
+                        pool.get(thread_handles[i]).value = t * 100 + i;
+                    }
+
+                    for (auto i = 0; i < 20; ++i)
+                        success = success && pool.get(thread_handles[i]).value == t * 100 + i;
+
+                    if (r % 3 == 0)
+                        pool.release_n(thread_handles);
+                    else
+                        for (auto hh : thread_handles)
+                            cache.release(hh);
+                }
+                results[t] = success;
+            });
+    }
+    for (auto& t : threads)
+        t.join();
+
+    for (auto r : results)
+        CHECK(r);
+    CHECK(pool.iterate_allocated_nodes([](pool_node&) {}) == 0);
+}
+
+TEST("cc::atomic_linked_pool occupancy")
+{
+    for (auto growable : {false, true})
+    {
+        cc::atomic_linked_pool<pool_node> pool;
+        if (growable)
+            pool.initialize_growable(5000, 4096, true);
+        else
+            pool.initialize(5000, cc::system_allocator, true);
+        CHECK(pool.is_tracking_occupancy());
+        CHECK(pool.count_allocated_nodes() == 0);
+
+        cc::vector<cc::atomic_linked_pool<pool_node>::handle_t> handles;
+        for (auto i = 0; i < 3000; ++i)
+        {
+            auto const h = pool.acquire();
+            pool.get(h).value = i;
+            handles.push_back(h);
+        }
+
+        // release every third node
+        int expected_sum = 0;
+        for (auto i = 0; i < 3000; ++i)
+        {
+            if (i % 3 == 0)
+                pool.release(handles[i]);
+            else
+                expected_sum += i;
+        }
+        CHECK(pool.count_allocated_nodes() == 2000);
+
+        int sum = 0;
+        CHECK(pool.iterate_allocated_nodes([&](pool_node& n) { sum += n.value; }) == 2000);
+        CHECK(sum == expected_sum);
+
+        // early out
+        CHECK(pool.iterate_allocated_nodes([](pool_node&) { return false; }) == 1);
+
+        // parallel iteration over disjoint partitions
+        int const num_partitions = 4;
+        cc::vector<std::thread> threads;
+        cc::vector<int> partition_sums;
+        cc::vector<uint32_t> partition_counts;
+        partition_sums.resize(num_partitions);
+        partition_counts.resize(num_partitions);
+        for (auto p = 0; p < num_partitions; ++p)
+        {
+            threads.emplace_back([&, p] { partition_counts[p] = pool.iterate_allocated_nodes_partition(p, num_partitions, [&](pool_node& n) { partition_sums[p] += n.value; }); });
+        }
+        for (auto& t : threads)
+            t.join();
+
+        int partitioned_sum = 0;
+        uint32_t partitioned_count = 0;
+        for (auto p = 0; p < num_partitions; ++p)
+        {
+            partitioned_sum += partition_sums[p];
+            partitioned_count += partition_counts[p];
+        }
+        CHECK(partitioned_sum == expected_sum);
+        CHECK(partitioned_count == 2000);
+
+        // nodes held by thread caches and bulk operations are tracked as well
+        {
+            cc::atomic_linked_pool<pool_node>::thread_cache cache(pool);
+            auto const h = cache.acquire();
+            CHECK(pool.count_allocated_nodes() == 2001);
+            cache.release(h);
+            CHECK(pool.count_allocated_nodes() == 2000);
+        }
+
+        cc::array<cc::atomic_linked_pool<pool_node>::handle_t, 10> bulk_handles;
+        pool.acquire_n(bulk_handles);
+        CHECK(pool.count_allocated_nodes() == 2010);
+        pool.release_n(bulk_handles);
+        CHECK(pool.count_allocated_nodes() == 2000);
+
+        CHECK(pool.release_all() == 2000);
+        CHECK(pool.count_allocated_nodes() == 0);
+    }
+}
+
+#ifdef HAS_CTRACER
+APP("cc::atomic_linked_pool contention scaling")
+{
+    enum mode
+    {
+        single,
+        bulk,
+        cached
+    };
+
+    auto const num_rounds = 20000;
+    auto const num_handles = 16;
+
+    auto const measure = [&](mode m, int num_threads)
+    {
+        // thread caches hold up to 64 free nodes
+        cc::atomic_linked_pool<pool_node> pool(num_threads * (num_handles + 64) + 1);
+
+        cc::vector<std::thread> threads;
+        ct::cycler c;
+        for (auto t = 0; t < num_threads; ++t)
+        {
+            threads.emplace_back(
+                [&]
+                {
+                    cc::atomic_linked_pool<pool_node>::thread_cache cache(pool);
+                    cc::array<cc::atomic_linked_pool<pool_node>::handle_t, num_handles> handles;
+                    for (auto r = 0; r < num_rounds; ++r)
+                    {
+                        switch (m)
+                        {
+                        case single:
+                            for (auto& h : handles)
+                                h = pool.acquire();
+                            for (auto h : handles)
+                                pool.release(h);
+                            break;
+                        case bulk:
+                            pool.acquire_n(handles);
+                            pool.release_n(handles);
+                            break;
+                        case cached:
+                            for (auto& h : handles)
+                                h = cache.acquire();
+                            for (auto h : handles)
+                                cache.release(h);
+                            break;
+                        }
+                    }
+                });
+        }
+        for (auto& t : threads)
+            t.join();
+
+        // wall clock cycles per acquire + release pair of a single thread, constant under perfect scaling
+        return c.elapsed_cycles() / (double(num_rounds) * num_handles);
+    };
+
+    for (auto num_threads : {1, 2, 4, 8, 16})
+    {
+        LOG("%2d threads: acquire/release %7.2f, acquire_n/release_n %7.2f, thread_cache %7.2f cycles per pair", num_threads, //
+            measure(single, num_threads), measure(bulk, num_threads), measure(cached, num_threads));
+    }
+}
+#endif
+
+#ifdef HAS_CTRACER
+APP("cc::atomic_linked_pool iteration")
+{
+    auto const num_nodes = 60000;
+
+    for (auto track_occupancy : {false, true})
+    {
+        cc::atomic_linked_pool<pool_node> pool(num_nodes, cc::system_allocator, track_occupancy);
+
+        // half of the nodes live, scattered over the pool
+        cc::vector<cc::atomic_linked_pool<pool_node>::handle_t> handles;
+        for (auto i = 0; i < num_nodes; ++i)
+            handles.push_back(pool.acquire());
+        for (auto i = 0; i < num_nodes; i += 2)
+            pool.release(handles[i]);
+
+        int sum = 0;
+        ct::cycler c;
+        for (auto r = 0; r < 10; ++r)
+            pool.iterate_allocated_nodes([&](pool_node& n) { sum += n.value; });
+
+        LOG("%s: %.2f cycles per pool node (sum %d)", track_occupancy ? "occupancy bitmap" : "free list", c.elapsed_cycles() / (10. * num_nodes), sum);
+    }
+}
+#endif
@@ -0,0 +1,310 @@
+#include <nexus/app.hh>
+#include <nexus/test.hh>
+
+#ifdef HAS_CTRACER
+#include <ctracer/trace.hh>
+#include <rich-log/log.hh>
+#endif
+
+#include <atomic>
+#include <thread>
+
+#include <clean-core/allocate.hh>
+#include <clean-core/epoch_domain.hh>
+#include <clean-core/unique_ptr.hh>
+#include <clean-core/vector.hh>
+
+namespace
+{
+std::atomic<int> g_num_freed = {0};
+
+void count_free(void* ptr, void*)
+{
+    g_num_freed.fetch_add(1);
+    delete static_cast<int*>(ptr);
+}
+
+// Treiber stack with epoch-based reclamation of popped nodes
+struct stack_node
+{
+    uint64_t value = 0;
+    uint64_t check = 0; // ~value, detects reading freed or reused nodes
+    stack_node* next = nullptr;
+};
+
+struct epoch_stack
+{
+    cc::epoch_domain& domain;
+    std::atomic<stack_node*> head = {nullptr};
+
+    void push(uint64_t value)
+    {
+        auto n = cc::alloc<stack_node>();
+        n->value = value;
+        n->check = ~value;
+        n->next = head.load(std::memory_order_relaxed);
+        while (!head.compare_exchange_weak(n->next, n, std::memory_order_release, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    // returns false if empty or a torn node was seen
+    bool pop(uint64_t& out_value, bool& is_ok)
+    {
+        auto g = domain.pin();
+        stack_node* n = head.load(std::memory_order_acquire);
+        while (n && !head.compare_exchange_weak(n, n->next, std::memory_order_acquire, std::memory_order_acquire))
+        {
+        }
+        if (!n)
+            return false;
+
+        is_ok &= n->check == ~n->value;
+        out_value = n->value;
+        domain.retire(n);
+        return true;
+    }
+
+    ~epoch_stack()
+    {
+        while (auto n = head.load())
+        {
+            head.store(n->next);
+            cc::free(n);
+        }
+    }
+};
+
+// producers push, consumers pop, everything popped is retired
+// returns true if every value arrived exactly once without reading freed nodes
+bool test_stack(unsigned num_threads, uint64_t num_per_thread)
+{
+    cc::epoch_domain domain;
+    epoch_stack stack{domain};
+
+    std::atomic<uint64_t> sum = {0};
+    std::atomic<uint64_t> num_popped = {0};
+    std::atomic<bool> is_ok = {true};
+    uint64_t const num_total = num_threads * num_per_thread;
+
+    cc::vector<std::thread> threads;
+    for (auto t = 0u; t < num_threads; ++t)
+        threads.emplace_back([&, t] {
+            bool ok = true;
+            uint64_t local_sum = 0;
+            for (uint64_t i = 1; i <= num_per_thread; ++i)
+            {
+                stack.push(t * num_per_thread + i);
+
+                uint64_t v;
+                if (stack.pop(v, ok))
+                {
+                    local_sum += v;
+                    num_popped.fetch_add(1);
+                }
+            }
+
+            // drain
+            uint64_t v;
+            while (num_popped.load() < num_total)
+                if (stack.pop(v, ok))
+                {
+                    local_sum += v;
+                    num_popped.fetch_add(1);
+                }
+                else
+                    std::this_thread::yield();
+
+            sum.fetch_add(local_sum);
+            if (!ok)
+                is_ok.store(false);
+        });
+    for (auto& t : threads)
+        t.join();
+
+    return is_ok.load() && sum.load() == num_total * (num_total + 1) / 2;
+}
+}
+
+TEST("cc::epoch_domain")
+{
+    // objects are not freed while pinned
+    {
+        g_num_freed = 0;
+        cc::epoch_domain domain;
+
+        CHECK(!domain.is_pinned());
+        {
+            auto g = domain.pin();
+            CHECK(domain.is_pinned());
+            {
+                auto g2 = domain.pin(); // nested
+            }
+            CHECK(domain.is_pinned());
+
+            domain.retire(new int(1), count_free);
+            CHECK(domain.flush() == 1);
+            CHECK(g_num_freed == 0);
+        }
+        CHECK(!domain.is_pinned());
+
+        CHECK(domain.flush() == 0);
+        CHECK(g_num_freed == 1);
+    }
+
+    // another thread pinned blocks reclamation, its unpin allows it
+    {
+        g_num_freed = 0;
+        cc::epoch_domain domain;
+
+        std::atomic<int> stage = {0};
+        std::thread reader([&] {
+            {
+                auto g = domain.pin();
+                stage = 1;
+                while (stage != 2)
+                    std::this_thread::yield();
+            }
+            stage = 3;
+        });
+
+        while (stage != 1)
+            std::this_thread::yield();
+
+        auto const epoch = domain.get_epoch();
+        domain.retire(new int(2), count_free);
+        CHECK(domain.flush() == 1);
+        CHECK(domain.get_epoch() <= epoch + 1);
+        CHECK(g_num_freed == 0);
+
+        stage = 2;
+        while (stage != 3)
+            std::this_thread::yield();
+        reader.join();
+
+        CHECK(domain.flush() == 0);
+        CHECK(g_num_freed == 1);
+    }
+
+    // hazard pointers keep single objects alive without pinning
+    {
+        g_num_freed = 0;
+        cc::epoch_domain domain;
+        std::atomic<int*> shared = {new int(3)};
+
+        auto hp = domain.make_hazard_pointer();
+        int* p = hp.protect(shared);
+        CHECK(*p == 3);
+
+        shared.store(new int(4));
+        domain.retire(p, count_free);
+        CHECK(domain.flush() == 1);
+        CHECK(g_num_freed == 0);
+        CHECK(*p == 3);
+
+        hp.reset_protection();
+        CHECK(domain.flush() == 0);
+        CHECK(g_num_freed == 1);
+
+        // pinned load, then protected beyond the pin
+        {
+            auto g = domain.pin();
+            p = shared.load();
+            hp.reset_protection(p);
+        }
+        domain.retire(shared.exchange(nullptr), count_free);
+        CHECK(domain.flush() == 1);
+        CHECK(*p == 4);
+    }
+    // remaining objects are freed with the domain
+    CHECK(g_num_freed == 2);
+
+    // objects retired by exited threads are adopted
+    {
+        g_num_freed = 0;
+        cc::epoch_domain domain;
+
+        std::thread t([&] {
+            for (auto i = 0; i < 10; ++i)
+                domain.retire(new int(i), count_free);
+        });
+        t.join();
+        CHECK(g_num_freed == 0);
+
+        CHECK(domain.flush() == 0);
+        CHECK(g_num_freed == 10);
+    }
+
+    // many domains on one thread, more than the thread-local cache holds
+    {
+        g_num_freed = 0;
+        for (auto i = 0; i < 20; ++i)
+        {
+            cc::epoch_domain domain;
+            auto g = domain.pin();
+            domain.retire(new int(i), count_free);
+        }
+        CHECK(g_num_freed == 20);
+
+        cc::vector<cc::unique_ptr<cc::epoch_domain>> domains;
+        for (auto i = 0; i < 20; ++i)
+        {
+            domains.push_back(cc::make_unique<cc::epoch_domain>());
+            domains.back()->retire(new int(i), count_free);
+        }
+        for (auto& d : domains)
+            d->flush();
+        domains.clear();
+        CHECK(g_num_freed == 40);
+    }
+
+    // lock-free stack under contention
+    CHECK(test_stack(4, 20000));
+}
+
+#ifdef HAS_CTRACER
+APP("cc::epoch_domain")
+{
+    int const num = 1 << 22;
+
+    {
+        cc::epoch_domain domain;
+        ct::cycler c;
+        for (auto i = 0; i < num; ++i)
+        {
+            auto g = domain.pin();
+        }
+        LOG("pin + unpin: %.2f cycles", c.elapsed_cycles() / double(num));
+    }
+    {
+        cc::epoch_domain domain;
+        auto g = domain.pin();
+        ct::cycler c;
+        for (auto i = 0; i < num; ++i)
+        {
+            auto g2 = domain.pin();
+        }
+        LOG("nested pin + unpin: %.2f cycles", c.elapsed_cycles() / double(num));
+    }
+    {
+        cc::epoch_domain domain;
+        auto nodes = cc::vector<stack_node*>();
+        for (auto i = 0; i < num; ++i)
+            nodes.push_back(cc::alloc<stack_node>());
+
+        ct::cycler c;
+        for (auto n : nodes)
+            domain.retire(n);
+        domain.flush();
+        LOG("retire + batched reclamation: %.2f cycles per object", c.elapsed_cycles() / double(num));
+    }
+
+    for (auto num_threads : {1u, 2u, 4u})
+    {
+        ct::cycler c;
+        auto const ok = test_stack(num_threads, num / 16);
+        LOG("treiber stack, %u threads: %.2f cycles per push + pop (%s)", num_threads, c.elapsed_cycles() / double(num / 16 * num_threads),
+            ok ? "ok" : "ERROR");
+    }
+}
+#endif
@@ -3,6 +3,8 @@
 #include <clean-core/any_of.hh>
 #include <clean-core/forward_list.hh>
 
+#include "special_types.hh"
+
 TEST("cc::forward_list")
 {
     cc::forward_list<int> l;
@@ -30,3 +32,37 @@ TEST("cc::forward_list")
     for (auto i : l2)
         CHECK(i == cc::any_of(1, 3));
 }
+
+TEST("cc::forward_list allocator")
+{
+    counting_allocator alloc;
+
+    {
+        cc::forward_list<int> l(&alloc);
+        for (auto i = 0; i < 100; ++i)
+            l.push_front(i);
+        CHECK(alloc.num_allocations == 100);
+
+        l.pop_front();
+        CHECK(alloc.num_allocations == 99);
+
+        auto l2 = l; // propagates the allocator
+        CHECK(l2.allocator() == &alloc);
+        CHECK(alloc.num_allocations == 2 * 99);
+        CHECK(l2.front() == 98);
+
+        auto l3 = cc::move(l2);
+        CHECK(l3.allocator() == &alloc);
+        CHECK(l2.allocator() == nullptr);
+
+        cc::forward_list<int> l4(l3, nullptr); // copy with default allocation
+        CHECK(l4.allocator() == nullptr);
+        CHECK(l4.size() == 99);
+        CHECK(alloc.num_allocations == 2 * 99);
+
+        l.clear();
+        CHECK(alloc.num_allocations == 99);
+    }
+
+    CHECK(alloc.num_allocations == 0);
+}
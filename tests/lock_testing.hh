@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+
+#include <thread>
+
+#include <clean-core/lock_guard.hh>
+#include <clean-core/native/timing.hh>
+#include <clean-core/vector.hh>
+
+// num_threads increment a shared counter num_per_thread times each, doing work_size iterations of work inside and outside the lock
+// returns the elapsed nanoseconds, or -1 if an increment was lost
+template <class LockT>
+double run_contended(unsigned num_threads, int num_per_thread, int work_size = 0)
+{
+    LockT lock;
+    int64_t counter = 0;
+
+    auto const start = cc::get_high_precision_ticks();
+
+    cc::vector<std::thread> threads;
+    for (auto t = 0u; t < num_threads; ++t)
+        threads.emplace_back([&] {
+            volatile int sink = 0;
+            for (auto i = 0; i < num_per_thread; ++i)
+            {
+                {
+                    auto lg = cc::lock_guard(lock);
+                    for (auto w = 0; w < work_size; ++w)
+                        sink = sink + w;
+                    ++counter;
+                }
+                for (auto w = 0; w < work_size; ++w)
+                    sink = sink + w;
+            }
+        });
+    for (auto& t : threads)
+        t.join();
+
+    auto const ns = double(cc::get_high_precision_ticks() - start) * 1e9 / double(cc::get_high_precision_frequency());
+    return counter == int64_t(num_threads) * num_per_thread ? ns : -1.0;
+}
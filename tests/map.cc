@@ -1,10 +1,20 @@
+#include <nexus/app.hh>
 #include <nexus/monte_carlo_test.hh>
 
+#ifdef HAS_CTRACER
+#include <ctracer/trace.hh>
+#include <rich-log/log.hh>
+#endif
+
+#include <clean-core/allocators/virtual_linear_allocator.hh>
 #include <clean-core/any_of.hh>
 #include <clean-core/map.hh>
+#include <clean-core/string.hh>
 
 #include <typed-geometry/feature/random.hh>
 
+#include "special_types.hh"
+
 TEST("cc::map")
 {
     cc::map<int, int> m;
@@ -211,3 +221,87 @@ TEST("cc::map badness", debug)
         CHECK(cc::experimental::compute_hash_badness(m) < 0.01);
     }
 }
+
+TEST("cc::map allocator")
+{
+    counting_allocator alloc;
+
+    {
+        cc::map<int, cc::string> m(&alloc);
+        for (auto i = 0; i < 100; ++i)
+            m[i] = "value";
+        CHECK(m.allocator() == &alloc);
+        CHECK(alloc.num_allocations == 101); // nodes + buckets
+
+        CHECK(m.remove_key(7));
+        CHECK(!m.contains_key(7));
+        CHECK(alloc.num_allocations == 100);
+
+        auto m2 = m;
+        CHECK(m2.allocator() == &alloc);
+        CHECK(m2.size() == 99);
+        CHECK(m2.get(8) == "value");
+
+        cc::map<int, cc::string> m3(m, nullptr);
+        CHECK(m3.allocator() == nullptr);
+        CHECK(m3.size() == 99);
+        CHECK(alloc.num_allocations == 200);
+
+        auto m4 = cc::move(m2);
+        CHECK(m4.allocator() == &alloc);
+        CHECK(m2.allocator() == nullptr);
+        CHECK(m2.empty());
+        CHECK(alloc.num_allocations == 200);
+
+        m4.clear();
+        CHECK(m4.empty());
+        CHECK(alloc.num_allocations == 101); // buckets stay
+    }
+
+    CHECK(alloc.num_allocations == 0);
+
+    // arena: no individual frees, destructors still run
+    {
+        cc::virtual_linear_allocator arena(1 << 24);
+        {
+            cc::map<int, cc::string> m(&arena);
+            for (auto i = 0; i < 1000; ++i)
+                m[i] = cc::string::filled(100, 'x'); // heap strings, leaked if destructors were skipped
+            CHECK(m.size() == 1000);
+            CHECK(m.get(500).size() == 100);
+        }
+        arena.reset();
+    }
+}
+
+#ifdef HAS_CTRACER
+APP("cc::map arena vs default")
+{
+    auto const num_elements = 100'000;
+    auto const num_runs = 10;
+
+    auto const measure = [&](char const* name, cc::allocator* alloc, cc::virtual_linear_allocator* arena)
+    {
+        double total_cycles = 0;
+        for (auto r = 0; r < num_runs; ++r)
+        {
+            ct::cycler c;
+            {
+                auto m = alloc ? cc::map<int, int>(alloc) : cc::map<int, int>();
+                for (auto i = 0; i < num_elements; ++i)
+                    m[i * 7] = i;
+            }
+            if (arena)
+                arena->reset();
+            total_cycles += c.elapsed_cycles();
+        }
+        LOG("%s: %.2f cycles per element (insert + destroy)", name, total_cycles / (double(num_runs) * num_elements));
+    };
+
+    cc::virtual_linear_allocator arena(size_t(1) << 30);
+
+    measure("default", nullptr, nullptr);
+    measure("system_allocator", cc::system_allocator, nullptr);
+    measure("virtual_linear_allocator", &arena, &arena);
+}
+#endif
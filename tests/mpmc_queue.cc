@@ -0,0 +1,299 @@
+#include <nexus/app.hh>
+#include <nexus/test.hh>
+
+#ifdef HAS_CTRACER
+#include <ctracer/trace.hh>
+#include <rich-log/log.hh>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <clean-core/experimental/mpmc_queue.hh>
+#include <clean-core/native/timing.hh>
+#include <clean-core/unique_ptr.hh>
+#include <clean-core/vector.hh>
+
+#include "special_types.hh"
+
+namespace
+{
+// producers enqueue 1..num_per_producer each, consumers dequeue until everything arrived
+// returns true if every element arrived exactly once (via sum and count)
+bool test_concurrent(size_t batch_size, unsigned num_producers, unsigned num_consumers, uint64_t num_per_producer)
+{
+    cc::mpmc_queue<uint64_t> queue(1024, cc::system_allocator);
+
+    uint64_t const num_total = num_per_producer * num_producers;
+    std::atomic<uint64_t> num_received = {0};
+    std::atomic<uint64_t> sum_received = {0};
+
+    cc::vector<std::thread> threads;
+    for (auto p = 0u; p < num_producers; ++p)
+        threads.emplace_back([&] {
+            cc::vector<uint64_t> batch;
+            for (uint64_t i = 1; i <= num_per_producer;)
+            {
+                batch.clear();
+                for (uint64_t j = i; j <= num_per_producer && batch.size() < batch_size; ++j)
+                    batch.push_back(j);
+
+                size_t num_sent = 0;
+                while (num_sent < batch.size())
+                {
+                    auto const n = batch_size == 1 ? size_t(queue.enqueue(batch[0])) : queue.enqueue_bulk(cc::span<uint64_t const>(batch).subspan(num_sent));
+                    if (n == 0)
+                        std::this_thread::yield();
+                    num_sent += n;
+                }
+                i += batch.size();
+            }
+        });
+
+    for (auto c = 0u; c < num_consumers; ++c)
+        threads.emplace_back([&] {
+            cc::vector<uint64_t> batch;
+            batch.resize(batch_size);
+            while (num_received.load() < num_total)
+            {
+                auto const n = batch_size == 1 ? size_t(queue.dequeue(&batch[0])) : queue.dequeue_bulk(batch);
+                if (n == 0)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                uint64_t sum = 0;
+                for (size_t i = 0; i < n; ++i)
+                    sum += batch[i];
+                sum_received.fetch_add(sum);
+                num_received.fetch_add(n);
+            }
+        });
+
+    for (auto& t : threads)
+        t.join();
+
+    return num_received.load() == num_total && sum_received.load() == num_producers * (num_per_producer * (num_per_producer + 1) / 2);
+}
+}
+
+TEST("cc::mpmc_queue")
+{
+    // FIFO, full and empty
+    {
+        cc::mpmc_queue<int> queue(4, cc::system_allocator);
+        int v = 0;
+        CHECK(!queue.dequeue(&v));
+        for (auto i = 0; i < 4; ++i)
+            CHECK(queue.enqueue(i));
+        CHECK(!queue.enqueue(4));
+        for (auto i = 0; i < 4; ++i)
+        {
+            CHECK(queue.dequeue(&v));
+            CHECK(v == i);
+        }
+        CHECK(!queue.dequeue(&v));
+    }
+
+    // move-only and non-default-constructible types
+    {
+        cc::mpmc_queue<cc::unique_ptr<int>> queue(4, cc::system_allocator);
+        CHECK(queue.enqueue(cc::make_unique<int>(3)));
+        CHECK(queue.emplace(cc::make_unique<int>(5)));
+
+        cc::unique_ptr<int> p;
+        CHECK(queue.dequeue(&p));
+        CHECK(*p == 3);
+        CHECK(queue.dequeue(&p));
+        CHECK(*p == 5);
+    }
+    {
+        cc::mpmc_queue<no_default_type> queue(2, cc::system_allocator);
+        CHECK(queue.emplace(17));
+        no_default_type out(0);
+        CHECK(queue.dequeue(&out));
+        CHECK(out.value == 17);
+    }
+
+    // remaining elements are destroyed with the queue
+    {
+        {
+            cc::mpmc_queue<counted_type> queue(8, cc::system_allocator);
+            for (auto i = 0; i < 5; ++i)
+                queue.enqueue(counted_type{});
+            counted_type out;
+            CHECK(queue.dequeue(&out));
+            CHECK(counted_type::num_alive == 5);
+        }
+        CHECK(counted_type::num_alive == 0);
+    }
+
+    // bulk, partial batches and wrap-around
+    {
+        cc::mpmc_queue<int> queue(8, cc::system_allocator);
+        int const values[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+        int out[10] = {};
+
+        CHECK(queue.enqueue_bulk(cc::span<int const>(values, 5)) == 5);
+        CHECK(queue.dequeue_bulk(cc::span<int>(out, 3)) == 3);
+        CHECK(out[0] == 0 && out[1] == 1 && out[2] == 2);
+
+        // 2 elements left, space for 6
+        CHECK(queue.enqueue_bulk(values) == 6);
+        CHECK(queue.enqueue_bulk(values) == 0);
+        CHECK(queue.enqueue(42) == false);
+
+        CHECK(queue.dequeue_bulk(out) == 8);
+        CHECK(out[0] == 3 && out[1] == 4 && out[2] == 0 && out[7] == 5);
+        CHECK(queue.dequeue_bulk(out) == 0);
+
+        // bulk and single operations mix
+        CHECK(queue.enqueue(7));
+        CHECK(queue.enqueue_bulk(cc::span<int const>(values, 2)) == 2);
+        int v = 0;
+        CHECK(queue.dequeue(&v));
+        CHECK(v == 7);
+        CHECK(queue.dequeue_bulk(out) == 2);
+        CHECK(out[0] == 0 && out[1] == 1);
+    }
+
+    // concurrent producers and consumers
+    for (size_t batch_size : {1, 3, 16, 256})
+        CHECK(test_concurrent(batch_size, 3, 3, 20000));
+}
+
+TEST("cc::mpmc_queue waiting")
+{
+    // timeouts
+    {
+        cc::mpmc_queue<int, true> queue(2, cc::system_allocator);
+        int v = 0;
+        CHECK(!queue.dequeue_wait(&v, 1000000));
+        CHECK(queue.enqueue_wait(1, 0));
+        CHECK(queue.enqueue_wait(2, 0));
+        CHECK(!queue.enqueue_wait(3, 1000000));
+        CHECK(queue.dequeue_wait(&v, 0));
+        CHECK(v == 1);
+    }
+
+    // blocked consumer is woken by a producer
+    {
+        cc::mpmc_queue<int, true> queue(4, cc::system_allocator);
+        int received = 0;
+        std::thread consumer([&] { queue.dequeue_wait(&received); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        CHECK(queue.enqueue(42));
+        consumer.join();
+        CHECK(received == 42);
+    }
+
+    // blocked producer is woken by a consumer (bulk wakes all)
+    {
+        cc::mpmc_queue<int, true> queue(2, cc::system_allocator);
+        queue.enqueue(0);
+        queue.enqueue(1);
+        std::thread p0([&] { queue.enqueue_wait(2); });
+        std::thread p1([&] { queue.enqueue_wait(3); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        int out[2] = {};
+        CHECK(queue.dequeue_bulk(out) == 2);
+        p0.join();
+        p1.join();
+        CHECK(queue.dequeue_bulk(out) == 2);
+        CHECK(out[0] + out[1] == 5);
+    }
+
+    // concurrent, all operations blocking on a small queue
+    {
+        int const num_threads = 3;
+        int const num_per_producer = 20000;
+        cc::mpmc_queue<int, true> queue(8, cc::system_allocator);
+        std::atomic<int64_t> sum = {0};
+
+        cc::vector<std::thread> threads;
+        for (auto t = 0; t < num_threads; ++t)
+        {
+            threads.emplace_back([&] {
+                for (auto i = 1; i <= num_per_producer; ++i)
+                    queue.enqueue_wait(i);
+            });
+            threads.emplace_back([&] {
+                int64_t s = 0;
+                int v = 0;
+                for (auto i = 0; i < num_per_producer; ++i)
+                {
+                    queue.dequeue_wait(&v);
+                    s += v;
+                }
+                sum.fetch_add(s);
+            });
+        }
+        for (auto& t : threads)
+            t.join();
+
+        CHECK(sum.load() == int64_t(num_threads) * num_per_producer * (num_per_producer + 1) / 2);
+    }
+}
+
+#ifdef HAS_CTRACER
+APP("cc::mpmc_queue bulk throughput")
+{
+    unsigned const num_producers = 2;
+    unsigned const num_consumers = 2;
+    uint64_t const num_per_producer = 1 << 22;
+
+    for (size_t batch_size : {1, 4, 16, 64, 256})
+    {
+        ct::cycler c;
+        auto const ok = test_concurrent(batch_size, num_producers, num_consumers, num_per_producer);
+        auto const cycles = c.elapsed_cycles();
+        LOG("batch size %3zu: %.2f cycles per element (%s)", batch_size, cycles / double(num_per_producer * num_producers), ok ? "ok" : "ERROR");
+    }
+}
+// time from enqueue until the waiting consumer has the element, blocking vs spinning consumer
+APP("cc::mpmc_queue wake-up latency")
+{
+    int const num_samples = 2000;
+    int64_t const frequency = cc::get_high_precision_frequency();
+
+    for (bool blocking : {true, false})
+    {
+        cc::mpmc_queue<int64_t, true> queue(16, cc::system_allocator);
+        cc::vector<double> latencies_us;
+        latencies_us.reserve(num_samples);
+        std::atomic<bool> is_received = {false};
+
+        std::thread consumer([&] {
+            for (auto i = 0; i < num_samples; ++i)
+            {
+                int64_t sent_ticks = 0;
+                if (blocking)
+                    queue.dequeue_wait(&sent_ticks);
+                else
+                    while (!queue.dequeue(&sent_ticks))
+                        cc::intrin_pause();
+
+                latencies_us.push_back(double(cc::get_high_precision_ticks() - sent_ticks) * 1e6 / double(frequency));
+                is_received.store(true, std::memory_order_release);
+            }
+        });
+
+        for (auto i = 0; i < num_samples; ++i)
+        {
+            // give the consumer time to fall asleep
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            is_received.store(false, std::memory_order_relaxed);
+            queue.enqueue(cc::get_high_precision_ticks());
+            while (!is_received.load(std::memory_order_acquire))
+                std::this_thread::yield();
+        }
+        consumer.join();
+
+        std::sort(latencies_us.begin(), latencies_us.end());
+        LOG("%s consumer: p50 %.2f us, p99 %.2f us", blocking ? "blocking" : "spinning", latencies_us[num_samples / 2], latencies_us[num_samples * 99 / 100]);
+    }
+}
+#endif
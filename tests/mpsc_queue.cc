@@ -0,0 +1,192 @@
+#include <nexus/app.hh>
+#include <nexus/test.hh>
+
+#ifdef HAS_CTRACER
+#include <ctracer/trace.hh>
+#include <rich-log/log.hh>
+#endif
+
+#include <thread>
+
+#include <clean-core/alloc_array.hh>
+#include <clean-core/allocate.hh>
+#include <clean-core/experimental/mpmc_queue.hh>
+#include <clean-core/experimental/mpsc_queue.hh>
+#include <clean-core/vector.hh>
+
+namespace
+{
+struct message : cc::mpsc_node
+{
+    uint32_t producer = 0;
+    uint32_t value = 0;
+};
+
+// each producer sends 0..num_per_producer-1 in order, using its own preallocated nodes
+// returns true if every element arrived exactly once and in order per producer
+bool test_concurrent(size_t batch_size, unsigned num_producers, uint32_t num_per_producer)
+{
+    cc::mpsc_queue<message> queue;
+
+    auto nodes = cc::alloc_array<message>::defaulted(num_producers * num_per_producer);
+
+    cc::vector<std::thread> producers;
+    for (auto p = 0u; p < num_producers; ++p)
+        producers.emplace_back([&, p] {
+            cc::vector<message*> batch;
+            for (uint32_t i = 0; i < num_per_producer; ++i)
+            {
+                message* m = &nodes[p * num_per_producer + i];
+                m->producer = p;
+                m->value = i;
+
+                if (batch_size == 1)
+                    queue.push(m);
+                else
+                {
+                    batch.push_back(m);
+                    if (batch.size() == batch_size || i + 1 == num_per_producer)
+                    {
+                        queue.push_n(batch);
+                        batch.clear();
+                    }
+                }
+            }
+        });
+
+    bool is_ok = true;
+    cc::vector<uint32_t> next_expected;
+    next_expected.resize(num_producers, 0);
+
+    message* received[64];
+    size_t num_received = 0;
+    while (num_received < nodes.size())
+    {
+        auto const num = queue.pop_n(received);
+        if (num == 0)
+            std::this_thread::yield();
+
+        for (size_t i = 0; i < num; ++i)
+            is_ok &= received[i]->value == next_expected[received[i]->producer]++;
+        num_received += num;
+    }
+
+    for (auto& t : producers)
+        t.join();
+
+    return is_ok && queue.pop() == nullptr && queue.empty_approx();
+}
+}
+
+TEST("cc::mpsc_queue")
+{
+    // FIFO, stub handling when running empty
+    {
+        cc::mpsc_queue<message> queue;
+        message m[4];
+        for (auto i = 0u; i < 4; ++i)
+            m[i].value = i;
+
+        CHECK(queue.empty_approx());
+        CHECK(queue.pop() == nullptr);
+
+        queue.push(&m[0]);
+        CHECK(!queue.empty_approx());
+        CHECK(queue.pop() == &m[0]);
+        CHECK(queue.pop() == nullptr);
+        CHECK(queue.empty_approx());
+
+        queue.push(&m[1]);
+        queue.push(&m[2]);
+        CHECK(queue.pop() == &m[1]);
+        queue.push(&m[0]); // nodes can be reused after pop
+        CHECK(queue.pop() == &m[2]);
+        CHECK(queue.pop() == &m[0]);
+        CHECK(queue.pop() == nullptr);
+    }
+
+    // batches
+    {
+        cc::mpsc_queue<message> queue;
+        message m[5];
+        message* const batch[] = {&m[0], &m[1], &m[2]};
+
+        queue.push(&m[3]);
+        queue.push_n(batch);
+        queue.push_n(cc::span<message* const>());
+        queue.push(&m[4]);
+
+        message* out[4] = {};
+        CHECK(queue.pop_n(out) == 4);
+        CHECK(out[0] == &m[3] && out[1] == &m[0] && out[2] == &m[1] && out[3] == &m[2]);
+        CHECK(queue.pop_n(out) == 1);
+        CHECK(out[0] == &m[4]);
+        CHECK(queue.pop_n(out) == 0);
+    }
+
+    // heap-allocated nodes
+    {
+        cc::mpsc_queue<message> queue;
+        for (auto i = 0u; i < 10; ++i)
+        {
+            auto m = cc::alloc<message>();
+            m->value = i;
+            queue.push(m);
+        }
+
+        uint32_t sum = 0;
+        while (auto m = queue.pop())
+        {
+            sum += m->value;
+            cc::free(m);
+        }
+        CHECK(sum == 45);
+    }
+
+    for (size_t batch_size : {1, 7, 64})
+        CHECK(test_concurrent(batch_size, 4, 20000));
+}
+
+#ifdef HAS_CTRACER
+APP("cc::mpsc_queue throughput")
+{
+    unsigned const num_producers = 3;
+    uint32_t const num_per_producer = 1 << 21;
+    uint64_t const num_total = uint64_t(num_producers) * num_per_producer;
+
+    for (size_t batch_size : {1, 16, 256})
+    {
+        ct::cycler c;
+        auto const ok = test_concurrent(batch_size, num_producers, num_per_producer);
+        LOG("mpsc_queue, batch size %3zu: %.2f cycles per element (%s)", batch_size, c.elapsed_cycles() / double(num_total), ok ? "ok" : "ERROR");
+    }
+
+    // bounded mpmc_queue with the same pattern for comparison
+    {
+        cc::mpmc_queue<uint32_t> queue(1024, cc::system_allocator);
+        ct::cycler c;
+
+        cc::vector<std::thread> producers;
+        for (auto p = 0u; p < num_producers; ++p)
+            producers.emplace_back([&] {
+                for (uint32_t i = 0; i < num_per_producer; ++i)
+                    while (!queue.enqueue(i))
+                        std::this_thread::yield();
+            });
+
+        uint32_t v;
+        for (uint64_t num_received = 0; num_received < num_total;)
+        {
+            if (queue.dequeue(&v))
+                ++num_received;
+            else
+                std::this_thread::yield();
+        }
+
+        for (auto& t : producers)
+            t.join();
+
+        LOG("mpmc_queue, single elements: %.2f cycles per element", c.elapsed_cycles() / double(num_total));
+    }
+}
+#endif
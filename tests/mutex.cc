@@ -0,0 +1,135 @@
+#include <nexus/app.hh>
+#include <nexus/test.hh>
+
+#ifdef HAS_CTRACER
+#include <ctracer/trace.hh>
+#include <rich-log/log.hh>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#include <clean-core/allocators/synced_tlsf_allocator.hh>
+#include <clean-core/allocators/synced_virtual_linear_allocator.hh>
+#include <clean-core/lock_guard.hh>
+#include <clean-core/mutex.hh>
+#include <clean-core/spin_lock.hh>
+#include <clean-core/vector.hh>
+
+#include "lock_testing.hh"
+
+TEST("cc::mutex")
+{
+    {
+        cc::mutex m;
+        CHECK(m.try_lock());
+        CHECK(!m.try_lock());
+        m.unlock();
+
+        m.lock();
+        CHECK(!m.try_lock());
+        m.unlock();
+        CHECK(m.try_lock());
+        m.unlock();
+    }
+
+    // a thread blocked in lock() is woken by unlock()
+    {
+        cc::mutex m;
+        bool is_done = false;
+        m.lock();
+        std::thread t([&] {
+            auto lg = cc::lock_guard(m);
+            is_done = true;
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        m.unlock();
+        t.join();
+        m.lock();
+        CHECK(is_done);
+        m.unlock();
+    }
+
+    // mutual exclusion, including more threads than cores
+    auto const num_threads = std::max(4u, 2 * std::thread::hardware_concurrency());
+    CHECK(run_contended<cc::mutex>(num_threads, 20000, 0) >= 0);
+    CHECK(run_contended<cc::mutex>(num_threads, 2000, 200) >= 0);
+
+    // as lock of the synced allocators
+    {
+        cc::vector<std::byte> buffer;
+        buffer.resize(1 << 20);
+        cc::synced_tlsf_allocator<cc::mutex> tlsf(buffer);
+        cc::synced_virtual_linear_allocator<cc::mutex> linear(1 << 24);
+
+        std::atomic<int> num_failed = {0};
+        cc::vector<std::thread> threads;
+        for (auto t = 0; t < 4; ++t)
+            threads.emplace_back([&] {
+                for (auto i = 0; i < 1000; ++i)
+                {
+                    auto p = tlsf.alloc(64);
+                    if (p == nullptr || linear.alloc(16) == nullptr)
+                        num_failed.fetch_add(1);
+                    tlsf.free(p);
+                }
+            });
+        for (auto& t : threads)
+            t.join();
+        CHECK(num_failed.load() == 0);
+        CHECK(tlsf.validate_heap());
+    }
+}
+
+#ifdef HAS_CTRACER
+APP("cc::mutex contention")
+{
+    int const num_total = 1 << 20;
+    auto const num_cores = std::max(1u, std::thread::hardware_concurrency());
+
+    // last entry is oversubscribed
+    cc::vector<unsigned> thread_counts;
+    for (auto n = 1u; n <= num_cores; n *= 2)
+        thread_counts.push_back(n);
+    thread_counts.push_back(4 * num_cores);
+
+    for (auto work_size : {0, 50, 500})
+        for (auto num_threads : thread_counts)
+        {
+            auto const num_per_thread = num_total / int(num_threads) / (work_size > 0 ? 8 : 1);
+            auto const num_ops = double(num_per_thread) * num_threads;
+
+            auto const spin_ns = run_contended<cc::spin_lock>(num_threads, num_per_thread, work_size);
+            auto const mutex_ns = run_contended<cc::mutex>(num_threads, num_per_thread, work_size);
+            auto const std_ns = run_contended<std::mutex>(num_threads, num_per_thread, work_size);
+
+            LOG("work %3d, %3u threads%s: spin_lock %8.1f ns/op, cc::mutex %8.1f ns/op, std::mutex %8.1f ns/op", work_size, num_threads,
+                num_threads > num_cores ? " (oversubscribed)" : "", spin_ns / num_ops, mutex_ns / num_ops, std_ns / num_ops);
+        }
+
+    // uncontended lock + unlock
+    {
+        cc::mutex m;
+        ct::cycler c;
+        for (auto i = 0; i < num_total; ++i)
+        {
+            m.lock();
+            m.unlock();
+        }
+        LOG("uncontended cc::mutex lock + unlock: %.2f cycles", c.elapsed_cycles() / double(num_total));
+    }
+    {
+        cc::spin_lock m;
+        ct::cycler c;
+        for (auto i = 0; i < num_total; ++i)
+        {
+            m.lock();
+            m.unlock();
+        }
+        LOG("uncontended cc::spin_lock lock + unlock: %.2f cycles", c.elapsed_cycles() / double(num_total));
+    }
+}
+#endif
@@ -0,0 +1,209 @@
+#include <nexus/app.hh>
+#include <nexus/test.hh>
+
+#ifdef HAS_CTRACER
+#include <ctracer/trace.hh>
+#include <rich-log/log.hh>
+#endif
+
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+#include <clean-core/parallel_algorithms.hh>
+#include <clean-core/task_scheduler.hh>
+#include <clean-core/vector.hh>
+
+TEST("cc::parallel algorithms")
+{
+    cc::task_scheduler scheduler(4);
+
+    for (cc::executor* ex : {cc::sequential_executor, static_cast<cc::executor*>(&scheduler)})
+    {
+        // sizes around the grain, explicit grains that do not divide the size
+        for (size_t size : {0, 1, 100, 8191, 8193, 100000})
+            for (size_t grain : {0, 1, 7, 4096})
+            {
+                if (grain == 1 && size > 1000)
+                    continue;
+
+                cc::vector<int64_t> values;
+                for (size_t i = 0; i < size; ++i)
+                    values.push_back(int64_t(i));
+
+                cc::parallel_for(values, grain, [](int64_t& v) { v *= 2; }, ex);
+                bool all_doubled = true;
+                for (size_t i = 0; i < size; ++i)
+                    all_doubled &= values[i] == int64_t(2 * i);
+                CHECK(all_doubled);
+
+                auto const sum = cc::parallel_reduce(values, int64_t(0), [](int64_t a, int64_t b) { return a + b; }, grain, ex);
+                CHECK(sum == int64_t(size) * (int64_t(size) - 1));
+
+                cc::vector<double> halves;
+                halves.resize(size);
+                cc::parallel_transform(values, halves, [](int64_t v) { return v * 0.5; }, grain, ex);
+                bool all_halved = true;
+                for (size_t i = 0; i < size; ++i)
+                    all_halved &= halves[i] == double(i);
+                CHECK(all_halved);
+
+                cc::parallel_fill(values, int64_t(-3), grain, ex);
+                bool all_filled = true;
+                for (auto v : values)
+                    all_filled &= v == -3;
+                CHECK(all_filled);
+
+                cc::vector<int64_t> copies;
+                copies.resize(size);
+                cc::parallel_copy(values, copies, grain, ex);
+                CHECK(copies == values);
+            }
+
+        // strided spans and C arrays
+        {
+            struct particle
+            {
+                float pos;
+                float vel;
+            };
+            cc::vector<particle> particles;
+            for (auto i = 0; i < 50000; ++i)
+                particles.push_back({float(i), 1.f});
+
+            cc::parallel_for(particles, 0, [](particle& p) { p.pos += p.vel; }, ex);
+            cc::parallel_fill(cc::strided_span<particle>(particles).project(&particle::vel), 2.f, 1000, ex);
+
+            int positions[50000];
+            cc::parallel_transform(cc::strided_span<particle>(particles).project(&particle::pos), positions, [](float p) { return int(p); }, 0, ex);
+            cc::parallel_copy(positions, cc::strided_span<particle>(particles).project(&particle::vel), 0, ex);
+
+            bool all_moved = true;
+            for (auto i = 0; i < 50000; ++i)
+                all_moved &= positions[i] == i + 1 && particles[i].vel == float(i + 1);
+            CHECK(all_moved);
+
+            auto const max_pos = cc::parallel_reduce(particles, 0.f, [](float m, auto const& p) {
+                if constexpr (std::is_same_v<std::decay_t<decltype(p)>, float>)
+                    return m < p ? p : m;
+                else
+                    return m < p.pos ? p.pos : m;
+            }, 0, ex);
+            CHECK(max_pos == 50000.f);
+        }
+
+        // the same chunks are combined in the same order
+        {
+            cc::vector<float> values;
+            for (auto i = 0; i < 1000000; ++i)
+                values.push_back(1.f / float(1 + i % 977));
+
+            auto const sum_a = cc::parallel_reduce(values, 0.f, [](float a, float b) { return a + b; }, 0, ex);
+            auto const sum_b = cc::parallel_reduce(values, 0.f, [](float a, float b) { return a + b; }, 0, ex);
+            CHECK(sum_a == sum_b);
+        }
+    }
+
+    // chunks run on the workers, nested algorithms inside chunks
+    {
+        cc::set_default_executor(&scheduler);
+        CHECK(cc::get_default_executor() == &scheduler);
+
+        cc::vector<int> rows;
+        rows.resize(64);
+        std::atomic<int> num_on_worker = {0};
+        cc::parallel_for(rows, 1, [&](int& r) {
+            if (scheduler.get_current_worker_index() >= 0)
+                num_on_worker.fetch_add(1);
+
+            cc::vector<int> cols;
+            cols.resize(20000);
+            cc::parallel_fill(cols, 1);
+            r = cc::parallel_reduce(cols, 0, [](int a, int b) { return a + b; });
+        });
+
+        bool all_rows = true;
+        for (auto r : rows)
+            all_rows &= r == 20000;
+        CHECK(all_rows);
+        CHECK(num_on_worker.load() <= 64);
+
+        cc::set_default_executor(cc::sequential_executor);
+    }
+}
+
+#ifdef HAS_CTRACER
+APP("cc::parallel algorithms scaling")
+{
+    auto const max_threads = cc::max<size_t>(1, std::thread::hardware_concurrency());
+
+    for (size_t size = 1000000; size <= 1000000000; size *= 10)
+    {
+        // two arrays of 1e9 floats do not fit into most machines, transform / copy stop at 1e8
+        bool const has_dst = size <= 100000000;
+
+        auto src = cc::vector<float>::for_overwrite(size);
+        auto dst = cc::vector<float>::for_overwrite(has_dst ? size : 0);
+        // touch all pages before measuring
+        cc::parallel_fill(src, 1.f);
+        cc::parallel_fill(dst, 0.f);
+
+        LOG("%zu elements", size);
+
+        for (size_t num_threads = 0; num_threads <= max_threads; num_threads = num_threads == 0 ? 1 : num_threads * 2)
+        {
+            // 0 threads: the sequential executor as baseline
+            cc::task_scheduler scheduler;
+            cc::executor* ex = cc::sequential_executor;
+            if (num_threads > 0)
+            {
+                scheduler.initialize(num_threads);
+                ex = &scheduler;
+            }
+
+            double cycles_for = 0;
+            double cycles_reduce = 0;
+            double cycles_fill = 0;
+            double cycles_transform = 0;
+            double cycles_copy = 0;
+            double sum = 0;
+
+            {
+                ct::cycler c;
+                cc::parallel_for(src, 0, [](float& v) { v = v * 1.0001f + 0.5f; }, ex);
+                cycles_for = c.elapsed_cycles();
+            }
+            {
+                ct::cycler c;
+                sum = cc::parallel_reduce(src, 0.0, [](double a, double b) { return a + b; }, 0, ex);
+                cycles_reduce = c.elapsed_cycles();
+            }
+            {
+                ct::cycler c;
+                cc::parallel_fill(src, 2.f, 0, ex);
+                cycles_fill = c.elapsed_cycles();
+            }
+            if (has_dst)
+            {
+                {
+                    ct::cycler c;
+                    cc::parallel_transform(src, dst, [](float v) { return v * v + 1.f; }, 0, ex);
+                    cycles_transform = c.elapsed_cycles();
+                }
+                {
+                    ct::cycler c;
+                    cc::parallel_copy(src, dst, 0, ex);
+                    cycles_copy = c.elapsed_cycles();
+                }
+            }
+
+            char label[32];
+            std::snprintf(label, sizeof(label), num_threads == 0 ? "sequential" : "%zu threads", num_threads);
+
+            auto const per_elem = [&](double cycles) { return cycles / double(size); };
+            LOG("  %-12s for %.3f, reduce %.3f, fill %.3f, transform %.3f, copy %.3f cycles per element (%.0f)", label, per_elem(cycles_for),
+                per_elem(cycles_reduce), per_elem(cycles_fill), per_elem(cycles_transform), per_elem(cycles_copy), sum);
+        }
+    }
+}
+#endif
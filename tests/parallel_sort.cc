@@ -0,0 +1,132 @@
+#include <nexus/app.hh>
+#include <nexus/test.hh>
+
+#ifdef HAS_CTRACER
+#include <ctracer/trace.hh>
+#include <rich-log/log.hh>
+#endif
+
+#include <cstdint>
+
+#include <clean-core/parallel_sort.hh>
+#include <clean-core/sort.hh>
+#include <clean-core/task_scheduler.hh>
+#include <clean-core/vector.hh>
+
+namespace
+{
+// deterministic pseudo-random values
+cc::vector<int64_t> make_values(size_t size, uint64_t modulo)
+{
+    cc::vector<int64_t> values;
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    for (size_t i = 0; i < size; ++i)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        values.push_back(int64_t(state % modulo));
+    }
+    return values;
+}
+}
+
+TEST("cc::parallel_sort")
+{
+    cc::task_scheduler scheduler(4);
+
+    for (cc::executor* ex : {cc::sequential_executor, static_cast<cc::executor*>(&scheduler)})
+    {
+        // random, few distinct values, all equal
+        for (uint64_t modulo : {uint64_t(1) << 40, uint64_t(1000), uint64_t(3), uint64_t(1)})
+        {
+            auto values = make_values(300000, modulo);
+            auto expected = values;
+            cc::sort(expected);
+
+            cc::parallel_sort(values, cc::less<void>{}, ex);
+            CHECK(values == expected);
+
+            // already sorted and reversed inputs
+            cc::parallel_sort(values, cc::less<void>{}, ex);
+            CHECK(values == expected);
+
+            cc::parallel_sort_descending(values, ex);
+            CHECK(cc::is_sorted(values, cc::greater<void>{}));
+
+            cc::parallel_sort(values, cc::less<void>{}, ex);
+            CHECK(values == expected);
+        }
+
+        // small ranges take the sequential path
+        {
+            cc::vector<int> v = {4, 2, 3, 1};
+            cc::parallel_sort(v, cc::less<void>{}, ex);
+            CHECK(v == cc::vector<int>{1, 2, 3, 4});
+
+            cc::vector<int> empty;
+            cc::parallel_sort(empty, cc::less<void>{}, ex);
+            CHECK(empty.empty());
+        }
+
+        // keys
+        {
+            auto values = make_values(200000, 1 << 20);
+            cc::parallel_sort_by(values, [](int64_t v) { return -v; }, cc::less<void>{}, ex);
+            CHECK(cc::is_sorted(values, cc::greater<void>{}));
+
+            cc::parallel_sort_by_descending(values, [](int64_t v) { return v % 1000; }, ex);
+            CHECK(cc::is_sorted_by(values, [](int64_t v) { return v % 1000; }, cc::greater<void>{}));
+        }
+    }
+
+    // sort_multi keeps the ranges in sync (default executor)
+    cc::set_default_executor(&scheduler);
+    {
+        auto keys = make_values(250000, 1 << 30);
+        cc::vector<int64_t> payload;
+        for (auto k : keys)
+            payload.push_back(k * 3 + 1);
+
+        cc::parallel_sort_multi(cc::less<void>{}, keys, payload);
+        CHECK(cc::is_sorted(keys));
+        bool in_sync = true;
+        for (size_t i = 0; i < keys.size(); ++i)
+            in_sync &= payload[i] == keys[i] * 3 + 1;
+        CHECK(in_sync);
+
+        cc::parallel_sort_multi_by([](int64_t k, int64_t p) { return p - k; }, cc::greater<void>{}, keys, payload);
+        CHECK(cc::is_sorted(keys, cc::greater<void>{}));
+        in_sync = true;
+        for (size_t i = 0; i < keys.size(); ++i)
+            in_sync &= payload[i] == keys[i] * 3 + 1;
+        CHECK(in_sync);
+    }
+    cc::set_default_executor(cc::sequential_executor);
+}
+
+#ifdef HAS_CTRACER
+APP("cc::parallel_sort scaling")
+{
+    auto const size = 100000000;
+    auto const source = make_values(size, uint64_t(1) << 40);
+
+    {
+        auto values = source;
+        ct::cycler c;
+        cc::sort(values);
+        LOG("cc::sort of %d ints: %.2f Gcycles", size, c.elapsed_cycles() / 1e9);
+    }
+
+    for (size_t num_threads = 1; num_threads <= 64; num_threads *= 2)
+    {
+        cc::task_scheduler scheduler(num_threads);
+
+        auto values = source;
+        ct::cycler c;
+        cc::parallel_sort(values, cc::less<void>{}, &scheduler);
+        LOG("cc::parallel_sort with %zu threads: %.2f Gcycles", num_threads, c.elapsed_cycles() / 1e9);
+        CC_ASSERT(cc::is_sorted(values));
+    }
+}
+#endif
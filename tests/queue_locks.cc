@@ -0,0 +1,191 @@
+#include <nexus/app.hh>
+#include <nexus/test.hh>
+
+#ifdef HAS_CTRACER
+#include <ctracer/trace.hh>
+#include <rich-log/log.hh>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include <thread>
+
+#include <clean-core/allocators/synced_tlsf_allocator.hh>
+#include <clean-core/lock_guard.hh>
+#include <clean-core/mcs_lock.hh>
+#include <clean-core/mutex.hh>
+#include <clean-core/spin_lock.hh>
+#include <clean-core/ticket_lock.hh>
+#include <clean-core/vector.hh>
+
+#include "lock_testing.hh"
+
+namespace
+{
+template <class LockT>
+void test_lock_basics()
+{
+    LockT lock;
+    CHECK(lock.try_lock());
+    CHECK(!lock.try_lock());
+    lock.unlock();
+
+    lock.lock();
+    CHECK(!lock.try_lock());
+    lock.unlock();
+
+    // handoff to a waiting thread
+    bool is_done = false;
+    lock.lock();
+    std::thread t([&] {
+        auto lg = cc::lock_guard(lock);
+        is_done = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    lock.unlock();
+    t.join();
+    lock.lock();
+    CHECK(is_done);
+    lock.unlock();
+
+    CHECK(run_contended<LockT>(4, 10000) >= 0);
+}
+}
+
+TEST("cc::ticket_lock")
+{
+    test_lock_basics<cc::ticket_lock>(); //
+}
+
+TEST("cc::mcs_lock")
+{
+    test_lock_basics<cc::mcs_lock>();
+
+    // several locks held at once, released in any order
+    {
+        cc::mcs_lock a, b, c;
+        a.lock();
+        b.lock();
+        c.lock();
+        a.unlock();
+        a.lock();
+        c.unlock();
+        b.unlock();
+        a.unlock();
+
+        CHECK(a.try_lock() && b.try_lock() && c.try_lock());
+        b.unlock();
+        a.unlock();
+        c.unlock();
+    }
+
+    // explicit nodes
+    {
+        cc::mcs_lock lock;
+        cc::mcs_lock::node n0, n1;
+        lock.lock(n0);
+        CHECK(!lock.try_lock(n1));
+        lock.unlock(n0);
+        CHECK(lock.try_lock(n1));
+        lock.unlock(n1);
+    }
+
+    // as lock of the synced allocators
+    {
+        cc::vector<std::byte> mcs_buffer;
+        cc::vector<std::byte> ticket_buffer;
+        mcs_buffer.resize(1 << 20);
+        ticket_buffer.resize(1 << 20);
+        cc::synced_tlsf_allocator<cc::mcs_lock> mcs_tlsf(mcs_buffer);
+        cc::synced_tlsf_allocator<cc::ticket_lock> ticket_tlsf(ticket_buffer);
+
+        auto p = mcs_tlsf.alloc(64);
+        CHECK(p != nullptr);
+        mcs_tlsf.free(p);
+        CHECK(mcs_tlsf.validate_heap());
+
+        p = ticket_tlsf.alloc(64);
+        CHECK(p != nullptr);
+        ticket_tlsf.free(p);
+        CHECK(ticket_tlsf.validate_heap());
+    }
+}
+
+#ifdef HAS_CTRACER
+namespace
+{
+// all threads acquire the lock in a loop for a fixed time
+// reports throughput and fairness as the coefficient of variation of the per-thread acquisition counts (0 is perfectly fair)
+template <class LockT>
+void bench_fairness(char const* name, unsigned num_threads, int work_size)
+{
+    LockT lock;
+    std::atomic<bool> is_running = {true};
+    std::atomic<unsigned> num_ready = {0};
+    cc::vector<uint64_t> counts;
+    counts.resize(num_threads, 0);
+    uint64_t shared_counter = 0;
+
+    cc::vector<std::thread> threads;
+    for (auto t = 0u; t < num_threads; ++t)
+        threads.emplace_back([&, t] {
+            num_ready.fetch_add(1);
+            while (num_ready.load() < num_threads)
+                std::this_thread::yield();
+
+            uint64_t count = 0;
+            volatile int sink = 0;
+            while (is_running.load(std::memory_order_relaxed))
+            {
+                {
+                    auto lg = cc::lock_guard(lock);
+                    for (auto w = 0; w < work_size; ++w)
+                        sink = sink + w;
+                    ++shared_counter;
+                }
+                ++count;
+                for (auto w = 0; w < work_size; ++w)
+                    sink = sink + w;
+            }
+            counts[t] = count;
+        });
+
+    auto const duration = std::chrono::milliseconds(300);
+    std::this_thread::sleep_for(duration);
+    is_running.store(false);
+    for (auto& t : threads)
+        t.join();
+
+    double mean = 0;
+    for (auto c : counts)
+        mean += double(c);
+    mean /= num_threads;
+    double variance = 0;
+    for (auto c : counts)
+        variance += (double(c) - mean) * (double(c) - mean);
+    variance /= num_threads;
+
+    LOG("%-12s %2u threads, work %3d: %7.2f M acquisitions/s, per-thread cv %.3f (min %llu, max %llu)%s", name, num_threads, work_size,
+        double(shared_counter) / 1e6 / (duration.count() / 1000.0), mean > 0 ? std::sqrt(variance) / mean : 0.0,
+        (unsigned long long)*std::min_element(counts.begin(), counts.end()), (unsigned long long)*std::max_element(counts.begin(), counts.end()),
+        shared_counter == std::accumulate(counts.begin(), counts.end(), uint64_t(0)) ? "" : " ERROR");
+}
+}
+
+APP("cc::ticket_lock and cc::mcs_lock fairness")
+{
+    auto const num_cores = std::max(1u, std::thread::hardware_concurrency());
+
+    for (auto work_size : {0, 100})
+        for (auto num_threads = 2u; num_threads <= std::max(2u, num_cores); num_threads *= 2)
+        {
+            bench_fairness<cc::spin_lock>("spin_lock", num_threads, work_size);
+            bench_fairness<cc::ticket_lock>("ticket_lock", num_threads, work_size);
+            bench_fairness<cc::mcs_lock>("mcs_lock", num_threads, work_size);
+            bench_fairness<cc::mutex>("cc::mutex", num_threads, work_size);
+        }
+}
+#endif
@@ -0,0 +1,207 @@
+#include <nexus/app.hh>
+#include <nexus/test.hh>
+
+#ifdef HAS_CTRACER
+#include <ctracer/trace.hh>
+#include <rich-log/log.hh>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <clean-core/lock_guard.hh>
+#include <clean-core/rw_spin_lock.hh>
+#include <clean-core/seqlock.hh>
+#include <clean-core/spin_lock.hh>
+#include <clean-core/vector.hh>
+
+TEST("cc::rw_spin_lock")
+{
+    {
+        cc::rw_spin_lock lock;
+
+        // multiple readers
+        CHECK(lock.try_lock_shared());
+        CHECK(lock.try_lock_shared());
+        CHECK(!lock.try_lock());
+        lock.unlock_shared();
+        lock.unlock_shared();
+
+        // single writer
+        CHECK(lock.try_lock());
+        CHECK(!lock.try_lock());
+        CHECK(!lock.try_lock_shared());
+        lock.unlock();
+
+        {
+            auto lg = cc::shared_lock_guard(lock);
+            CHECK(lock.try_lock_shared());
+            lock.unlock_shared();
+        }
+        {
+            auto lg = cc::lock_guard(lock);
+            CHECK(!lock.try_lock_shared());
+        }
+        CHECK(lock.try_lock());
+        lock.unlock();
+    }
+
+    // writer preference: a waiting writer blocks new readers
+    {
+        cc::rw_spin_lock lock;
+        std::atomic<bool> has_written = {false};
+
+        lock.lock_shared();
+        std::thread writer([&] {
+            auto lg = cc::lock_guard(lock);
+            has_written.store(true);
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        CHECK(!lock.try_lock_shared());
+        lock.unlock_shared();
+        writer.join();
+        CHECK(has_written.load());
+        CHECK(lock.try_lock_shared());
+        lock.unlock_shared();
+    }
+
+    // readers see consistent data, no writes are lost
+    {
+        cc::rw_spin_lock lock;
+        int64_t a = 0, b = 0;
+        std::atomic<bool> is_writing = {true};
+        std::atomic<int> num_inconsistent = {0};
+        int const num_writes = 20000;
+
+        cc::vector<std::thread> threads;
+        for (auto r = 0; r < 3; ++r)
+            threads.emplace_back([&] {
+                while (is_writing.load(std::memory_order_relaxed))
+                {
+                    auto lg = cc::shared_lock_guard(lock);
+                    if (a != b)
+                        num_inconsistent.fetch_add(1);
+                }
+            });
+
+        cc::vector<std::thread> writers;
+        for (auto w = 0; w < 2; ++w)
+            writers.emplace_back([&] {
+                for (auto i = 0; i < num_writes; ++i)
+                {
+                    auto lg = cc::lock_guard(lock);
+                    ++a;
+                    ++b;
+                }
+            });
+
+        for (auto& t : writers)
+            t.join();
+        is_writing.store(false);
+        for (auto& t : threads)
+            t.join();
+
+        CHECK(num_inconsistent.load() == 0);
+        CHECK(a == 2 * num_writes);
+    }
+}
+
+#ifdef HAS_CTRACER
+namespace
+{
+struct shared_data
+{
+    double values[4] = {};
+};
+
+// a spinlock-protected value, for comparison
+struct spin_locked_data
+{
+    shared_data load()
+    {
+        auto lg = cc::lock_guard(lock);
+        return data;
+    }
+    template <class F>
+    void update(F&& f)
+    {
+        auto lg = cc::lock_guard(lock);
+        f(data);
+    }
+
+    cc::spin_lock lock;
+    shared_data data;
+};
+
+struct rw_locked_data
+{
+    shared_data load()
+    {
+        auto lg = cc::shared_lock_guard(lock);
+        return data;
+    }
+    template <class F>
+    void update(F&& f)
+    {
+        auto lg = cc::lock_guard(lock);
+        f(data);
+    }
+
+    cc::rw_spin_lock lock;
+    shared_data data;
+};
+
+// every thread performs num_ops operations, one in write_interval is a write
+// returns the million operations per second over all threads
+template <class DataT>
+double bench_read_mostly(unsigned num_threads, int num_ops, int write_interval)
+{
+    DataT data;
+    std::atomic<unsigned> num_ready = {0};
+
+    auto const start = std::chrono::steady_clock::now();
+
+    cc::vector<std::thread> threads;
+    for (auto t = 0u; t < num_threads; ++t)
+        threads.emplace_back([&] {
+            num_ready.fetch_add(1);
+            while (num_ready.load() < num_threads)
+                std::this_thread::yield();
+
+            double sum = 0;
+            for (auto i = 0; i < num_ops; ++i)
+            {
+                if (i % write_interval == 0)
+                    data.update([](shared_data& d) { d.values[0] += 1; });
+                else
+                    sum += data.load().values[0];
+            }
+            volatile double sink = sum;
+            (void)sink;
+        });
+    for (auto& t : threads)
+        t.join();
+
+    auto const seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return double(num_threads) * num_ops / seconds / 1e6;
+}
+}
+
+APP("cc::rw_spin_lock and cc::seqlock read-mostly")
+{
+    auto const num_cores = std::max(1u, std::thread::hardware_concurrency());
+    int const num_ops = 1 << 20;
+
+    for (auto write_interval : {2, 10, 100, 1000})
+        for (auto num_threads = 1u; num_threads <= num_cores; num_threads *= 2)
+        {
+            auto const spin = bench_read_mostly<spin_locked_data>(num_threads, num_ops, write_interval);
+            auto const rw = bench_read_mostly<rw_locked_data>(num_threads, num_ops, write_interval);
+            auto const seq = bench_read_mostly<cc::seqlock<shared_data>>(num_threads, num_ops, write_interval);
+
+            LOG("1 write per %4d ops, %2u threads: spin_lock %7.1f, rw_spin_lock %7.1f, seqlock %7.1f M ops/s", write_interval, num_threads, spin, rw, seq);
+        }
+}
+#endif
@@ -0,0 +1,83 @@
+#include <nexus/test.hh>
+
+#include <atomic>
+#include <thread>
+
+#include <clean-core/seqlock.hh>
+#include <clean-core/vector.hh>
+
+namespace
+{
+// all fields are always equal, a torn read would show different values
+struct snapshot
+{
+    int64_t a = 0;
+    int64_t b = 0;
+    int32_t c = 0;
+    char d = 0;
+};
+}
+
+TEST("cc::seqlock")
+{
+    {
+        cc::seqlock<int> value;
+        CHECK(value.load() == 0);
+        value.store(17);
+        CHECK(value.load() == 17);
+        value.update([](int& v) { v += 3; });
+        CHECK(value.load() == 20);
+
+        int out = 0;
+        CHECK(value.try_load(out));
+        CHECK(out == 20);
+    }
+
+    {
+        cc::seqlock<snapshot> value(snapshot{1, 1, 1, 1});
+        auto const s = value.load();
+        CHECK(s.a == 1 && s.b == 1 && s.c == 1 && s.d == 1);
+    }
+
+    // concurrent readers never see torn values, writers do not lose updates
+    {
+        cc::seqlock<snapshot> value;
+        std::atomic<bool> is_writing = {true};
+        std::atomic<int> num_torn = {0};
+        int const num_writes = 20000;
+
+        cc::vector<std::thread> threads;
+        for (auto r = 0; r < 3; ++r)
+            threads.emplace_back([&] {
+                int64_t last = 0;
+                while (is_writing.load(std::memory_order_relaxed))
+                {
+                    auto const s = value.load();
+                    if (s.a != s.b || s.c != int32_t(s.a) || s.d != char(s.a) || s.a < last)
+                        num_torn.fetch_add(1);
+                    last = s.a;
+                }
+            });
+
+        cc::vector<std::thread> writers;
+        for (auto w = 0; w < 2; ++w)
+            writers.emplace_back([&] {
+                for (auto i = 0; i < num_writes; ++i)
+                    value.update([](snapshot& s) {
+                        ++s.a;
+                        s.b = s.a;
+                        s.c = int32_t(s.a);
+                        s.d = char(s.a);
+                    });
+            });
+
+        for (auto& t : writers)
+            t.join();
+        is_writing.store(false);
+        for (auto& t : threads)
+            t.join();
+
+        CHECK(num_torn.load() == 0);
+        CHECK(value.load().a == 2 * num_writes);
+    }
+}
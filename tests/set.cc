@@ -5,6 +5,8 @@
 #include <clean-core/any_of.hh>
 #include <clean-core/set.hh>
 
+#include "special_types.hh"
+
 TEST("cc::set")
 {
     bool b;
@@ -79,3 +81,31 @@ TEST("cc::set")
     for (auto i : s)
         CHECK(i == cc::any_of(-3, 1, 3, 5));
 }
+
+TEST("cc::set allocator")
+{
+    counting_allocator alloc;
+
+    {
+        cc::set<int> s(&alloc);
+        for (auto i = 0; i < 100; ++i)
+            s.add(i);
+        CHECK(s.allocator() == &alloc);
+        CHECK(alloc.num_allocations == 101); // nodes + buckets
+
+        CHECK(s.remove(7));
+        CHECK(!s.contains(7));
+        CHECK(alloc.num_allocations == 100);
+
+        auto s2 = s;
+        CHECK(s2.allocator() == &alloc);
+        CHECK(s2 == s);
+
+        cc::set<int> s3(s, nullptr);
+        CHECK(s3.allocator() == nullptr);
+        CHECK(s3 == s);
+        CHECK(alloc.num_allocations == 200);
+    }
+
+    CHECK(alloc.num_allocations == 0);
+}
@@ -130,6 +130,23 @@ TEST("cc::sort api")
     }
 }
 
+TEST("cc::sort duplicates")
+{
+    // equal elements are split off instead of being recursed into one by one
+    for (auto num_distinct : {1, 2, 3, 100})
+    {
+        cc::vector<int> v;
+        for (auto i = 0; i < 200000; ++i)
+            v.push_back((i * 7919) % num_distinct);
+
+        cc::sort(v);
+        CHECK(cc::is_sorted(v));
+
+        cc::quickselect(v, 100000);
+        CHECK(v[100000] == 100000 * num_distinct / 200000);
+    }
+}
+
 FUZZ_TEST("cc::sort fuzzer")(tg::rng& rng)
 {
     cc::vector<int> v;
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <clean-core/allocator.hh>
+
 struct regular_type
 {
 };
@@ -29,3 +31,37 @@ struct no_default_type
     bool operator==(no_default_type const& rhs) const { return value == rhs.value; }
     bool operator!=(no_default_type const& rhs) const { return value != rhs.value; }
 };
+
+// counts the currently alive instances
+struct counted_type
+{
+    static inline int num_alive = 0;
+
+    counted_type() { ++num_alive; }
+    counted_type(counted_type const&) { ++num_alive; }
+    counted_type& operator=(counted_type const&) = default;
+    ~counted_type() { --num_alive; }
+};
+
+// forwards to the system allocator and counts the currently alive allocations
+struct counting_allocator final : cc::allocator
+{
+    int num_allocations = 0;
+
+    std::byte* alloc(size_t size, size_t align = alignof(std::max_align_t)) override
+    {
+        ++num_allocations;
+        return cc::system_allocator->alloc(size, align);
+    }
+
+    void free(void* ptr) override
+    {
+        if (ptr == nullptr)
+            return;
+
+        --num_allocations;
+        cc::system_allocator->free(ptr);
+    }
+
+    char const* get_name() const override { return "Counting Allocator"; }
+};
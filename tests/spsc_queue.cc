@@ -0,0 +1,235 @@
+#include <nexus/app.hh>
+#include <nexus/test.hh>
+
+#ifdef HAS_CTRACER
+#include <ctracer/trace.hh>
+#include <rich-log/log.hh>
+#endif
+
+#include <thread>
+
+#include <clean-core/experimental/spsc_queue.hh>
+#include <clean-core/native/timing.hh>
+#include <clean-core/unique_ptr.hh>
+#include <clean-core/vector.hh>
+
+#include "special_types.hh"
+
+namespace
+{
+enum class transfer_mode
+{
+    single,
+    bulk,
+    zero_copy
+};
+
+// sends 0..num-1 from one thread to another
+// returns true if everything arrived in order
+// a full / empty queue yields, so this also makes progress when both threads share a core
+bool test_transfer(transfer_mode mode, size_t batch_size, uint64_t num)
+{
+    cc::spsc_queue<uint64_t> queue(4096, cc::system_allocator);
+    bool is_ok = true;
+
+    std::thread consumer([&] {
+        cc::vector<uint64_t> batch;
+        batch.resize(batch_size);
+        uint64_t expected = 0;
+        while (expected < num)
+        {
+            switch (mode)
+            {
+            case transfer_mode::single:
+            {
+                uint64_t v;
+                if (queue.pop(&v))
+                    is_ok &= v == expected++;
+                else
+                    std::this_thread::yield();
+                break;
+            }
+            case transfer_mode::bulk:
+            {
+                auto const n = queue.pop_n(batch);
+                if (n == 0)
+                    std::this_thread::yield();
+                for (size_t i = 0; i < n; ++i)
+                    is_ok &= batch[i] == expected++;
+                break;
+            }
+            case transfer_mode::zero_copy:
+            {
+                auto const in = queue.reserve_read(batch_size);
+                if (in.empty())
+                    std::this_thread::yield();
+                for (auto v : in)
+                    is_ok &= v == expected++;
+                queue.commit_read(in.size());
+                break;
+            }
+            }
+        }
+    });
+
+    cc::vector<uint64_t> batch;
+    batch.resize(batch_size);
+    for (uint64_t i = 0; i < num;)
+    {
+        switch (mode)
+        {
+        case transfer_mode::single:
+            if (queue.push(i))
+                ++i;
+            else
+                std::this_thread::yield();
+            break;
+        case transfer_mode::bulk:
+        {
+            auto const n = cc::min<uint64_t>(batch_size, num - i);
+            for (size_t j = 0; j < n; ++j)
+                batch[j] = i + j;
+            auto const num_pushed = queue.push_n(cc::span<uint64_t const>(batch.data(), n));
+            if (num_pushed == 0)
+                std::this_thread::yield();
+            i += num_pushed;
+            break;
+        }
+        case transfer_mode::zero_copy:
+        {
+            auto const out = queue.reserve_write(cc::min<uint64_t>(batch_size, num - i));
+            if (out.empty())
+                std::this_thread::yield();
+            for (auto& v : out)
+                v = i++;
+            queue.commit_write(out.size());
+            break;
+        }
+        }
+    }
+
+    consumer.join();
+    return is_ok && queue.empty_approx();
+}
+}
+
+TEST("cc::spsc_queue")
+{
+    // FIFO, full and empty
+    {
+        cc::spsc_queue<int> queue(4, cc::system_allocator);
+        CHECK(queue.capacity() == 4);
+        int v = 0;
+        CHECK(!queue.pop(&v));
+        for (auto i = 0; i < 4; ++i)
+            CHECK(queue.push(i));
+        CHECK(!queue.push(4));
+        CHECK(queue.size_approx() == 4);
+        for (auto i = 0; i < 4; ++i)
+        {
+            CHECK(queue.pop(&v));
+            CHECK(v == i);
+        }
+        CHECK(!queue.pop(&v));
+        CHECK(queue.empty_approx());
+    }
+
+    // move-only types and destruction
+    {
+        cc::spsc_queue<cc::unique_ptr<int>> queue(4, cc::system_allocator);
+        CHECK(queue.push(cc::make_unique<int>(3)));
+        CHECK(queue.emplace(cc::make_unique<int>(5)));
+        cc::unique_ptr<int> p;
+        CHECK(queue.pop(&p));
+        CHECK(*p == 3);
+
+        auto const in = queue.reserve_read(4);
+        CHECK(in.size() == 1);
+        CHECK(*in[0] == 5);
+        queue.commit_read(1);
+        CHECK(queue.empty_approx());
+    }
+    {
+        {
+            cc::spsc_queue<counted_type> queue(8, cc::system_allocator);
+            for (auto i = 0; i < 5; ++i)
+                queue.push(counted_type{});
+            counted_type out;
+            CHECK(queue.pop(&out));
+            queue.commit_read(queue.reserve_read(2).size());
+            CHECK(counted_type::num_alive == 3);
+        }
+        CHECK(counted_type::num_alive == 0);
+    }
+
+    // bulk and zero-copy access around the wrap-around
+    {
+        cc::spsc_queue<int> queue(8, cc::system_allocator);
+        int const values[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+        int out[10] = {};
+
+        CHECK(queue.push_n(cc::span<int const>(values, 6)) == 6);
+        CHECK(queue.pop_n(cc::span<int>(out, 5)) == 5);
+
+        // 1 element left at index 5, 7 free slots: 2 until the end, 5 behind the wrap-around
+        auto w = queue.reserve_write(10);
+        CHECK(w.size() == 2);
+        w[0] = 10;
+        w[1] = 11;
+        queue.commit_write(2);
+        w = queue.reserve_write(10);
+        CHECK(w.size() == 5);
+        w[0] = 12;
+        queue.commit_write(1);
+
+        auto r = queue.reserve_read(10);
+        CHECK(r.size() == 3);
+        CHECK(r[0] == 5 && r[1] == 10 && r[2] == 11);
+        queue.commit_read(3);
+        r = queue.reserve_read(10);
+        CHECK(r.size() == 1);
+        CHECK(r[0] == 12);
+        queue.commit_read(1);
+
+        CHECK(queue.push_n(values) == 8);
+        CHECK(queue.push_n(values) == 0);
+        CHECK(queue.reserve_write(1).empty());
+        CHECK(queue.pop_n(out) == 8);
+        CHECK(out[0] == 0 && out[7] == 7);
+        CHECK(queue.pop_n(out) == 0);
+        CHECK(queue.reserve_read(1).empty());
+    }
+
+    // two threads
+    CHECK(test_transfer(transfer_mode::single, 1, 200000));
+    for (size_t batch_size : {3, 64, 1000})
+    {
+        CHECK(test_transfer(transfer_mode::bulk, batch_size, 200000));
+        CHECK(test_transfer(transfer_mode::zero_copy, batch_size, 200000));
+    }
+}
+
+#ifdef HAS_CTRACER
+APP("cc::spsc_queue throughput")
+{
+    uint64_t const num = 1 << 26;
+    double const frequency = double(cc::get_high_precision_frequency());
+
+    auto const run = [&](char const* name, transfer_mode mode, size_t batch_size) {
+        auto const start = cc::get_high_precision_ticks();
+        ct::cycler c;
+        auto const ok = test_transfer(mode, batch_size, num);
+        auto const cycles = c.elapsed_cycles();
+        auto const seconds = double(cc::get_high_precision_ticks() - start) / frequency;
+        LOG("%-10s batch %4zu: %.2f cycles per element, %.0f M elements/s (%s)", name, batch_size, cycles / double(num), num / seconds / 1e6,
+            ok ? "ok" : "ERROR");
+    };
+
+    run("single", transfer_mode::single, 1);
+    for (size_t batch_size : {16, 64, 256})
+    {
+        run("bulk", transfer_mode::bulk, batch_size);
+        run("zero-copy", transfer_mode::zero_copy, batch_size);
+    }
+}
+#endif
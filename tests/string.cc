@@ -4,6 +4,8 @@
 
 #include <clean-core/string.hh>
 
+#include "special_types.hh"
+
 MONTE_CARLO_TEST("cc::string mct")
 {
     auto const make_char = [](tg::rng& rng) { return uniform(rng, 'A', 'z'); };
@@ -255,3 +257,63 @@ TEST("cc::string / string_view / char const* equality")
     // NOT EQUAL (by design)! CHECK(s3 == s2);
     CHECK(s3 == s3); // pointer check
 }
+
+TEST("cc::string allocator")
+{
+    counting_allocator alloc;
+
+    {
+        cc::string s(&alloc);
+        CHECK(s.empty());
+        CHECK(s.allocator() == &alloc);
+        CHECK(alloc.num_allocations == 1); // never uses the small buffer
+
+        s += "hello";
+        CHECK(alloc.num_allocations == 1);
+        CHECK(s == "hello");
+
+        // growing keeps the allocator
+        for (auto i = 0; i < 100; ++i)
+            s.push_back('!');
+        CHECK(s.size() == 105);
+        CHECK(s.allocator() == &alloc);
+        CHECK(alloc.num_allocations == 1);
+
+        s.replace(0, 5, "good bye");
+        CHECK(s.starts_with("good bye!!"));
+        CHECK(s.allocator() == &alloc);
+
+        s.clear();
+        CHECK(s.empty());
+        CHECK(s.allocator() == &alloc);
+        s += "short";
+        s.shrink_to_fit();
+        CHECK(s == "short");
+        CHECK(s.allocator() == &alloc);
+
+        // copies and derived strings propagate the allocator
+        auto s2 = s;
+        CHECK(s2.allocator() == &alloc);
+        CHECK(s2.to_upper() == "SHORT");
+        CHECK(s2.to_upper().allocator() == &alloc);
+        CHECK((s2 + "er").allocator() == &alloc);
+
+        cc::string s3 = "default";
+        CHECK(s3.allocator() == nullptr);
+        s3 = s2;
+        CHECK(s3.allocator() == &alloc);
+        s3 = cc::string("default again");
+        CHECK(s3.allocator() == nullptr);
+
+        auto s4 = cc::move(s2);
+        CHECK(s4.allocator() == &alloc);
+        CHECK(s4 == "short");
+
+        cc::string s5("long enough to not fit into the small buffer", &alloc);
+        CHECK(s5.size() == 44);
+        CHECK(s5.capacity() == 44);
+        CHECK(s5.allocator() == &alloc);
+    }
+
+    CHECK(alloc.num_allocations == 0);
+}
@@ -2,6 +2,8 @@
 
 #include <clean-core/string_stream.hh>
 
+#include "special_types.hh"
+
 TEST("cc::string_stream")
 {
     cc::string_stream ss;
@@ -37,3 +39,34 @@ TEST("cc::string_stream")
        << "bar";
     CHECK(ss.to_string() == "foobar");
 }
+
+TEST("cc::string_stream allocator")
+{
+    counting_allocator alloc;
+
+    {
+        cc::string_stream ss(&alloc);
+        ss << "hello" << ' ' << "world";
+        CHECK(ss.allocator() == &alloc);
+
+        auto s = ss.to_string();
+        CHECK(s == "hello world");
+        CHECK(s.allocator() == &alloc);
+
+        auto ss2 = ss;
+        CHECK(ss2.allocator() == &alloc);
+        CHECK(ss2.to_string() == "hello world");
+
+        cc::string_stream ss3;
+        ss3 << "abc";
+        ss3 = ss;
+        CHECK(ss3.allocator() == &alloc);
+        CHECK(ss3.to_string() == "hello world");
+
+        auto ss4 = cc::move(ss3);
+        CHECK(ss4.allocator() == &alloc);
+        CHECK(ss3.allocator() == nullptr);
+    }
+
+    CHECK(alloc.num_allocations == 0);
+}
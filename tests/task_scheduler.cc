@@ -0,0 +1,191 @@
+#include <nexus/app.hh>
+#include <nexus/test.hh>
+
+#ifdef HAS_CTRACER
+#include <ctracer/trace.hh>
+#include <rich-log/log.hh>
+#endif
+
+#include <atomic>
+#include <thread>
+
+#include <clean-core/task_scheduler.hh>
+#include <clean-core/vector.hh>
+
+namespace
+{
+int64_t fib_sequential(int n) { return n < 2 ? n : fib_sequential(n - 1) + fib_sequential(n - 2); }
+
+// fork-join: one half as a task, the other half on the calling thread
+int64_t fib_parallel(cc::task_scheduler& scheduler, int n)
+{
+    if (n < 16)
+        return fib_sequential(n);
+
+    int64_t a = 0;
+    cc::task_scheduler::counter c;
+    scheduler.submit([&] { a = fib_parallel(scheduler, n - 1); }, &c);
+    int64_t const b = fib_parallel(scheduler, n - 2);
+    scheduler.wait(c);
+    return a + b;
+}
+
+// recursive splitting down to a grain size
+int64_t sum_parallel(cc::task_scheduler& scheduler, int32_t const* data, size_t size)
+{
+    if (size <= 8192)
+    {
+        int64_t s = 0;
+        for (size_t i = 0; i < size; ++i)
+            s += data[i];
+        return s;
+    }
+
+    int64_t left = 0;
+    cc::task_scheduler::counter c;
+    scheduler.submit([&] { left = sum_parallel(scheduler, data, size / 2); }, &c);
+    int64_t const right = sum_parallel(scheduler, data + size / 2, size - size / 2);
+    scheduler.wait(c);
+    return left + right;
+}
+}
+
+TEST("cc::task_scheduler")
+{
+    for (size_t num_threads : {1, 2, 4})
+    {
+        cc::task_scheduler scheduler(num_threads);
+        CHECK(scheduler.get_num_threads() == num_threads);
+        CHECK(scheduler.get_current_worker_index() == -1);
+
+        // independent tasks from outside, more than the injection queue holds
+        {
+            std::atomic<int> sum = {0};
+            cc::task_scheduler::counter c;
+            for (auto i = 1; i <= 10000; ++i)
+                scheduler.submit([&sum, i] { sum.fetch_add(i); }, &c);
+            scheduler.wait(c);
+            CHECK(c.is_done());
+            CHECK(sum.load() == 10000 * 10001 / 2);
+        }
+
+        // tasks run on the workers or on the waiting thread, which helps while waiting
+        {
+            auto const submitting_thread = std::this_thread::get_id();
+            std::atomic<int> num_valid = {0};
+            cc::task_scheduler::counter c;
+            for (auto i = 0; i < 100; ++i)
+                scheduler.submit(
+                    [&] {
+                        auto const index = scheduler.get_current_worker_index();
+                        bool const is_on_thread = std::this_thread::get_id() == submitting_thread;
+                        if (is_on_thread ? index == -1 : index >= 0 && index < int32_t(num_threads))
+                            num_valid.fetch_add(1);
+                    },
+                    &c);
+            scheduler.wait(c);
+            CHECK(num_valid.load() == 100);
+        }
+
+        // without a helping thread, every task runs on a worker
+        {
+            auto const submitting_thread = std::this_thread::get_id();
+            std::atomic<int> num_on_worker = {0};
+            cc::task_scheduler::counter c;
+            for (auto i = 0; i < 100; ++i)
+                scheduler.submit(
+                    [&] {
+                        if (scheduler.get_current_worker_index() >= 0 && std::this_thread::get_id() != submitting_thread)
+                            num_on_worker.fetch_add(1);
+                    },
+                    &c);
+            while (!c.is_done())
+                std::this_thread::yield();
+            CHECK(num_on_worker.load() == 100);
+        }
+
+        // nested fork-join
+        CHECK(fib_parallel(scheduler, 24) == fib_sequential(24));
+
+        cc::vector<int32_t> values;
+        for (auto i = 0; i < 1000000; ++i)
+            values.push_back(i % 1000);
+        CHECK(sum_parallel(scheduler, values.data(), values.size()) == int64_t(1000) * 999 / 2 * 1000);
+
+        // callables that do not fit inline
+        {
+            struct large_payload
+            {
+                int64_t values[32];
+            };
+            large_payload payload = {};
+            payload.values[31] = 42;
+
+            int64_t result = 0;
+            cc::task_scheduler::counter c;
+            scheduler.submit([payload, &result] { result = payload.values[31]; }, &c);
+            scheduler.wait(c);
+            CHECK(result == 42);
+        }
+
+        // manual dependencies
+        {
+            cc::task_scheduler::counter c;
+            c.add();
+            std::thread t([&] { c.done(); });
+            scheduler.wait(c);
+            CHECK(c.is_done());
+            t.join();
+        }
+    }
+
+    // pending tasks are finished on destruction
+    std::atomic<int> num_run = {0};
+    {
+        cc::task_scheduler scheduler(2);
+        for (auto i = 0; i < 1000; ++i)
+            scheduler.submit([&] { num_run.fetch_add(1); });
+    }
+    CHECK(num_run.load() == 1000);
+}
+
+#ifdef HAS_CTRACER
+APP("cc::task_scheduler fork-join")
+{
+    auto const max_threads = cc::max<size_t>(1, std::thread::hardware_concurrency());
+    auto const fib_n = 32;
+
+    cc::vector<int32_t> values;
+    for (auto i = 0; i < (1 << 26); ++i)
+        values.push_back(i % 1000);
+
+    {
+        ct::cycler c;
+        auto const res = fib_sequential(fib_n);
+        LOG("fib(%d) sequential: %.2f Mcycles (%lld)", fib_n, c.elapsed_cycles() / 1e6, (long long)res);
+    }
+    {
+        ct::cycler c;
+        int64_t s = 0;
+        for (auto v : values)
+            s += v;
+        LOG("sum of %zu ints sequential: %.2f Mcycles (%lld)", values.size(), c.elapsed_cycles() / 1e6, (long long)s);
+    }
+
+    for (size_t num_threads = 1; num_threads <= max_threads; num_threads *= 2)
+    {
+        cc::task_scheduler scheduler(num_threads);
+
+        {
+            ct::cycler c;
+            auto const res = fib_parallel(scheduler, fib_n);
+            LOG("fib(%d) with %zu threads: %.2f Mcycles (%lld)", fib_n, num_threads, c.elapsed_cycles() / 1e6, (long long)res);
+        }
+        {
+            ct::cycler c;
+            auto const res = sum_parallel(scheduler, values.data(), values.size());
+            LOG("sum of %zu ints with %zu threads: %.2f Mcycles (%lld)", values.size(), num_threads, c.elapsed_cycles() / 1e6, (long long)res);
+        }
+    }
+}
+#endif
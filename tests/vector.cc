@@ -1,10 +1,20 @@
+#include <nexus/app.hh>
 #include <nexus/fuzz_test.hh>
 #include <nexus/monte_carlo_test.hh>
 #include <nexus/range.hh>
 
+#ifdef HAS_CTRACER
+#include <ctracer/trace.hh>
+#include <rich-log/log.hh>
+#endif
+
+#include <chrono>
+#include <cstring>
 #include <vector>
 
+#include <clean-core/alloc_array.hh>
 #include <clean-core/alloc_vector.hh>
+#include <clean-core/array.hh>
 #include <clean-core/allocators/linear_allocator.hh>
 #include <clean-core/allocators/stack_allocator.hh>
 #include <clean-core/capped_vector.hh>
@@ -899,3 +909,154 @@ TEST("cc::vector reinterpret")
     CHECK(ints == nx::range{1, 2, 3, 4, 5, 6});
     CHECK(foos.empty());
 }
+
+TEST("cc::vector large buffers")
+{
+    // grows across CC_VECTOR_PAGES_THRESHOLD (page blocks are remapped instead of copied on Linux)
+    size_t const num_elements = 3 * CC_VECTOR_PAGES_THRESHOLD / sizeof(int);
+
+    cc::vector<int> v;
+    for (size_t i = 0; i < num_elements; ++i)
+        v.push_back(int(i));
+
+    CHECK(v.size() == num_elements);
+    CHECK(cc::is_aligned(v.data(), cc::system_page_size));
+
+    auto is_valid = true;
+    for (size_t i = 0; i < num_elements; ++i)
+        is_valid = is_valid && v[i] == int(i);
+    CHECK(is_valid);
+
+    // shrink back below the threshold
+    v.resize(100);
+    v.shrink_to_fit();
+    CHECK(v.capacity() == 100);
+    for (auto i = 0; i < 100; ++i)
+        CHECK(v[i] == i);
+
+    // copies and moves of page blocks
+    v.resize(num_elements, 7);
+    cc::vector<int> copy = v;
+    CHECK(copy.size() == num_elements);
+    CHECK(copy[99] == 99);
+    CHECK(copy.back() == 7);
+
+    auto bytes = cc::move(copy).reinterpret_as<std::byte>();
+    CHECK(bytes.size() == num_elements * sizeof(int));
+    bytes.reserve(bytes.capacity() * 2);
+    CHECK(bytes.size() == num_elements * sizeof(int));
+}
+
+#ifdef HAS_CTRACER
+APP("cc::vector large growth")
+{
+    // doubles a float vector up to 256 MB, std::vector has to copy every step
+    size_t const max_size = size_t(1) << 26;
+
+    {
+        cc::vector<float> v = cc::vector<float>::filled(1 << 20, 1.f);
+        ct::cycler c;
+        while (v.size() < max_size)
+            v.resize(v.size() * 2, 1.f);
+        LOG("cc::vector: %.2f cycles per element", c.elapsed_cycles() / double(max_size));
+    }
+
+    {
+        std::vector<float> v(1 << 20, 1.f);
+        ct::cycler c;
+        while (v.size() < max_size)
+            v.resize(v.size() * 2, 1.f);
+        LOG("std::vector: %.2f cycles per element", c.elapsed_cycles() / double(max_size));
+    }
+}
+#endif
+
+TEST("cc::vector for_overwrite")
+{
+    struct with_default
+    {
+        int value = 7;
+    };
+
+    auto v = cc::vector<with_default>::for_overwrite(10);
+    CHECK(v.size() == 10);
+    for (auto const& e : v)
+        CHECK(e.value == 7);
+
+    v.resize_for_overwrite(20);
+    CHECK(v.size() == 20);
+    CHECK(v.back().value == 7);
+
+    v.resize_for_overwrite(5);
+    CHECK(v.size() == 5);
+
+    // trivial types are not written, the content is up to the caller
+    auto floats = cc::vector<float>::for_overwrite(100);
+    CHECK(floats.size() == 100);
+    floats.resize_for_overwrite(1000);
+    CHECK(floats.size() == 1000);
+    CHECK(floats.capacity() >= 1000);
+
+    std::byte buffer[1024];
+    cc::linear_allocator linalloc(buffer);
+    auto av = cc::alloc_vector<with_default>::for_overwrite(10, &linalloc);
+    CHECK(av.size() == 10);
+    CHECK(av[9].value == 7);
+    av.resize_for_overwrite(30);
+    CHECK(av[29].value == 7);
+
+    auto a = cc::array<with_default>::for_overwrite(4);
+    CHECK(a.size() == 4);
+    CHECK(a[3].value == 7);
+
+    auto aa = cc::alloc_array<int>::for_overwrite(4);
+    CHECK(aa.size() == 4);
+
+    auto* const arr = cc::system_allocator->new_array_for_overwrite<with_default>(8);
+    CHECK(arr[7].value == 7);
+    cc::system_allocator->delete_array(arr);
+
+    auto* const sized_arr = cc::system_allocator->new_array_sized_for_overwrite<with_default>(8);
+    CHECK(sized_arr[7].value == 7);
+    cc::system_allocator->delete_array_sized(sized_arr, 8);
+}
+
+#ifdef HAS_CTRACER
+APP("cc::vector for_overwrite bandwidth")
+{
+    // obtains a 1 GB buffer and overwrites it once (as an I/O read or decoder would)
+    size_t const num_bytes = size_t(1) << 30;
+    auto const num_runs = 3;
+
+    // opaque to the optimizer, otherwise the zeroing could be eliminated as a dead store
+    void* (*volatile overwrite)(void*, int, size_t) = std::memset;
+
+    auto const measure = [&](char const* name, auto&& make_buffer)
+    {
+        double total_seconds = 0;
+        for (auto r = 0; r < num_runs; ++r)
+        {
+            auto const start = std::chrono::steady_clock::now();
+            {
+                cc::vector<std::byte> buffer = make_buffer();
+                overwrite(buffer.data(), 0xAB, buffer.size());
+            }
+            total_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        LOG("%s: %.2f GB/s effective (%.1f ms per buffer)", name, num_runs * num_bytes / total_seconds / 1e9, 1000 * total_seconds / num_runs);
+    };
+
+    measure("defaulted (zeroed, then overwritten)", [&] { return cc::vector<std::byte>::defaulted(num_bytes); });
+    measure("for_overwrite", [&] { return cc::vector<std::byte>::for_overwrite(num_bytes); });
+    measure("resize (zeroed, then overwritten)", [&] {
+        cc::vector<std::byte> v;
+        v.resize(num_bytes);
+        return v;
+    });
+    measure("resize_for_overwrite", [&] {
+        cc::vector<std::byte> v;
+        v.resize_for_overwrite(num_bytes);
+        return v;
+    });
+}
+#endif